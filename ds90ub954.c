@@ -20,25 +20,60 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <linux/debugfs.h>
 #include <linux/gpio.h>
+#include <linux/gpio/consumer.h>
+#include <linux/gpio/driver.h>
+#include <linux/clk-provider.h>
 #include <linux/delay.h>
 #include <linux/i2c.h>
+#include <linux/interrupt.h>
 #include <linux/io.h>
 #include <linux/kernel.h>
+#include <linux/ktime.h>
 #include <linux/media.h>
 #include <linux/module.h>
 #include <linux/of.h>
 #include <linux/of_device.h>
-#include <linux/of_gpio.h>
+#include <linux/pm_runtime.h>
 #include <linux/regmap.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/sort.h>
+#include <linux/string.h>
+#include <linux/workqueue.h>
 
 #include "ds90ub954.h"
 
+#define CREATE_TRACE_POINTS
+#include "ds90ub954_trace.h"
+
 #define ENABLE_SYSFS_TP /* /sys/bus/i2c/devices/0-0018 */
 
+static const struct ds90ub954_chip_info ds90ub954_chip = {
+	.name = "ds90ub954",
+	.num_rx_ports = TI954_NUM_RX_PORTS,
+	.num_gpios = TI954_NUM_GPIO,
+	/* PASS and LOCK of all enabled rx ports */
+	.rx_port_ctl = (0b11<<TI954_LOCK_SEL)|(0b11<<TI954_PASS_SEL),
+};
+
+static const struct ds90ub954_chip_info ds90ub960_chip = {
+	.name = "ds90ub960",
+	.num_rx_ports = TI960_NUM_RX_PORTS,
+	.num_gpios = TI960_NUM_GPIO,
+	/* bits 0..3 are the port enables, lock and pass are routed to GPIOs */
+	.rx_port_ctl = 0,
+};
+
 static const struct of_device_id ds90ub954_of_match[] = {
 	{
 		.compatible = "ti,ds90ub954",
+		.data = &ds90ub954_chip,
+	},
+	{
+		.compatible = "ti,ds90ub960",
+		.data = &ds90ub960_chip,
 	},
 	{/* sentinel */},
 };
@@ -53,1553 +88,7029 @@ const struct regmap_config ds90ub953_regmap_config = {
 	.val_bits = 8,
 };
 
-/* 4096x2160 */
-static const u8 ds90ub95x_tp_reg_val[] = {
-	/* Indirect Pattern Gen Registers */
-	0xB0, 0x00,
-	0xB1, TI954_REG_IA_PGEN_CTL,
-	0xB2, (1<<TI954_PGEB_ENABLE),
-	0xB1, TI954_REG_IA_PGEB_CFG,
-	0xB2, 0x35,
-	0xB1, TI954_REG_IA_PGEN_CSI_DI,
-	0xB2, 0x2B,
-	0xB1, TI954_REG_IA_PGEN_LINE_SIZE1,
-	0xB2, 0x14,
-	0xB1, TI954_REG_IA_PGEN_LINE_SIZE0,
-	0xB2, 0x00,
-	0xB1, TI954_REG_IA_PGEN_BAR_SIZE1,
-	0xB2, 0x02,
-	0xB1, TI954_REG_IA_PGEN_BAR_SIZE0,
-	0xB2, 0x80,
-	0xB1, TI954_REG_IA_PGEN_ACT_LPF1,
-	0xB2, 0x08,
-	0xB1, TI954_REG_IA_PGEN_ACT_LPF0,
-	0xB2, 0x70,
-	0xB1, TI954_REG_IA_PGEN_TOT_LPF1,
-	0xB2, 0x08,
-	0xB1, TI954_REG_IA_PGEN_TOT_LPF0,
-	0xB2, 0x70,
-	0xB1, TI954_REG_IA_PGEN_LINE_PD1,
-	0xB2, 0x0B,
-	0xB1, TI954_REG_IA_PGEN_LINE_PD0,
-	0xB2, 0x93,
-	0xB1, TI954_REG_IA_PGEN_VBP,
-	0xB2, 0x21,
-	0xB1, TI954_REG_IA_PGEN_VFP,
-	0xB2, 0x0A,
+
+/*------------------------------------------------------------------------------
+ * I2C MASTER TIMING
+ *----------------------------------------------------------------------------*/
+
+struct ds90ub95x_i2c_timing {
+	unsigned int scl_high;
+	unsigned int scl_low;
+	unsigned int sda_setup;
 };
 
+/*
+ * Compute SCL_HIGH_TIME/SCL_LOW_TIME for a target scl frequency. The minimum
+ * high/low times and the rise+fall budget are taken from the i2c
+ * specification for standard, fast and fast-plus mode. The remaining period
+ * is split in the ratio of the minimum times. The counts are rounded up for
+ * the fastest oscillator within its tolerance, so tHIGH and tLOW hold on every
+ * part; at the nominal clock SCL runs up to that tolerance slower.
+ */
+static int ds90ub95x_calc_i2c_timing(unsigned int freq,
+				     struct ds90ub95x_i2c_timing *t)
+{
+	unsigned int period, avail, low_min, high_min, edges, low, high;
+	unsigned int osc_ns = TI95X_I2C_OSC_PERIOD_NS *
+			      (100 - TI95X_I2C_OSC_TOLERANCE_PCT) / 100;
+
+	if(freq == 0 || freq > 1000000)
+		return -EINVAL;
+
+	if(freq <= 100000) {
+		low_min = 4700;
+		high_min = 4000;
+		edges = 1300;
+		t->sda_setup = TI95X_SDA_SETUP_DEFAULT;
+	} else if(freq <= 400000) {
+		low_min = 1300;
+		high_min = 600;
+		edges = 600;
+		t->sda_setup = TI95X_SDA_SETUP_DEFAULT;
+	} else {
+		low_min = 500;
+		high_min = 260;
+		edges = 240;
+		/* the extra output setup delay does not fit a 1 us period */
+		t->sda_setup = 0;
+	}
+
+	period = 1000000000 / freq;
+	avail = (period > edges) ? period - edges : 0;
+	low = max(low_min, avail * low_min / (low_min + high_min));
+	high = (avail > low) ? avail - low : 0;
+	high = max(high, high_min);
+
+	t->scl_low = clamp_t(unsigned int,
+			     DIV_ROUND_UP(low, osc_ns), 1, 0xff);
+	t->scl_high = clamp_t(unsigned int,
+			      DIV_ROUND_UP(high, osc_ns), 1, 0xff);
+	return 0;
+}
+
+#if IS_ENABLED(CONFIG_VIDEO_DS90UB954_KUNIT_TEST)
+static void ds90ub954_mock_sleep(struct ds90ub954_mock *mock, unsigned int ms);
+#endif
+
+/* all bring-up sleeps, accounted instead of slept by the KUnit register mock */
+static void ds90ub954_msleep(struct ds90ub954_priv *priv, unsigned int ms)
+{
+#if IS_ENABLED(CONFIG_VIDEO_DS90UB954_KUNIT_TEST)
+	if(priv->mock) {
+		ds90ub954_mock_sleep(priv->mock, ms);
+		return;
+	}
+#endif
+	msleep(ms);
+}
+
+static void ds90ub954_reg_hist_add(struct ds90ub954_reg_hist *hist,
+				   unsigned int reg, int write, int err,
+				   u64 ns)
+{
+	struct ds90ub954_reg_stat *st = &hist->stat[reg % REG_HIST_NUM];
+	unsigned long flags;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	if(write)
+		st->writes++;
+	else
+		st->reads++;
+	if(err)
+		st->errors++;
+	st->total_ns += ns;
+	if(ns > st->max_ns)
+		st->max_ns = min_t(u64, ns, U32_MAX);
+	spin_unlock_irqrestore(&hist->lock, flags);
+}
+
 /*------------------------------------------------------------------------------
- * DS90UB954 FUNCTIONS
+ * RETRY AND FAULT INJECTION
  *----------------------------------------------------------------------------*/
 
-static int ds90ub954_read(struct ds90ub954_priv *priv, unsigned int reg,
-			  unsigned int *val)
+/*
+ * All register accesses of the deserializer (local) and the serializers
+ * (remote, over the back channel) go through ds90ub954_regmap_xfer. Transient
+ * errors are retried with an exponential backoff, so a marginal cable doesn't
+ * make a single NAK deactivate a camera.
+ */
+
+static int ds90ub954_retryable(int err)
 {
-	int err;
-	err = regmap_read(priv->regmap, reg, val);
-	if(err) {
-		dev_err(&priv->client->dev,
-			"Cannot read register 0x%02x (%d)!\n", reg, err);
+	return err == -ENXIO || err == -EREMOTEIO || err == -ETIMEDOUT ||
+	       err == -EAGAIN || err == -EIO;
+}
+
+#ifdef CONFIG_VIDEO_DS90UB954_FAULT_INJECTION
+static int ds90ub954_fault_hit(struct ds90ub954_fault *f, int pct)
+{
+	if(!pct || !f->times)
+		return 0;
+	if(get_random_u32() % 100 >= pct)
+		return 0;
+	if(f->times > 0)
+		f->times--;
+	f->injected++;
+	return 1;
+}
+
+/* error of an injected NAK or timeout, before the access */
+static int ds90ub954_fault_error(struct ds90ub954_priv *priv, int target)
+{
+	struct ds90ub954_fault *f = &priv->retry.fault;
+	unsigned long flags;
+	int timeout_us = 0;
+	int err = 0;
+
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	if(f->targets & BIT(target)) {
+		if(ds90ub954_fault_hit(f, f->nak_pct)) {
+			err = -ENXIO;
+		} else if(ds90ub954_fault_hit(f, f->timeout_pct)) {
+			err = -ETIMEDOUT;
+			timeout_us = f->timeout_us;
+		}
 	}
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
+
+	if(timeout_us)
+		usleep_range(timeout_us, timeout_us + timeout_us / 4 + 1);
 	return err;
 }
 
-static int ds90ub954_write(const struct ds90ub954_priv *priv, unsigned int reg,
-			   unsigned int val)
+/* injected corruption of a read value, after the access */
+static void ds90ub954_fault_corrupt(struct ds90ub954_priv *priv, int target,
+				    unsigned int *val)
 {
-	int err;
+	struct ds90ub954_fault *f = &priv->retry.fault;
+	unsigned long flags;
+
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	if((f->targets & BIT(target)) && ds90ub954_fault_hit(f, f->corrupt_pct))
+		*val ^= BIT(get_random_u32() % 8);
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
+}
+#else
+static int ds90ub954_fault_error(struct ds90ub954_priv *priv, int target)
+{
+	return 0;
+}
 
-	err = regmap_write(priv->regmap, reg, val);
+static void ds90ub954_fault_corrupt(struct ds90ub954_priv *priv, int target,
+				    unsigned int *val)
+{
+}
+#endif
+
+static int ds90ub954_regmap_xfer(struct ds90ub954_priv *priv,
+				 struct regmap *map, int target, int write,
+				 unsigned int reg, unsigned int *val)
+{
+	struct ds90ub954_retry *r = &priv->retry;
+	struct ds90ub954_retry_stats *st = &r->stats[target];
+	struct ds90ub954_retry_policy policy;
+	ktime_t first_err = 0;
+	unsigned long flags;
+	int attempt, err;
+	u64 ns;
+
+	spin_lock_irqsave(&r->lock, flags);
+	policy = r->policy[target];
+	spin_unlock_irqrestore(&r->lock, flags);
+
+	/* with auto increment a failed data access may have advanced the
+	 * indirect address, a retry would hit the next register. Same address
+	 * on the serializer. */
+	if(reg == TI954_REG_IND_ACC_DATA)
+		policy.retries = 0;
+
+	for(attempt = 0; ; attempt++) {
+		err = ds90ub954_fault_error(priv, target);
+		if(!err) {
+			if(write)
+				err = regmap_write(map, reg, *val);
+			else
+				err = regmap_read(map, reg, val);
+		}
+		if(!err || !ds90ub954_retryable(err) ||
+		   attempt >= policy.retries)
+			break;
+
+		if(!attempt)
+			first_err = ktime_get();
+		usleep_range(policy.backoff_us, policy.backoff_us * 2 + 1);
+		policy.backoff_us = min(policy.backoff_us * 2,
+					RETRY_BACKOFF_MAX_US);
+	}
+
+	if(!err && !write)
+		ds90ub954_fault_corrupt(priv, target, val);
+
+	if(!attempt)
+		return err;
+
+	ns = ktime_to_ns(ktime_sub(ktime_get(), first_err));
+	spin_lock_irqsave(&r->lock, flags);
+	st->retries += attempt;
 	if(err) {
-		dev_err(&priv->client->dev,
-			"Cannot write register 0x%02x (%d)!\n", reg, err);
+		st->failed++;
+	} else {
+		st->recovered++;
+		st->recovery_ns += ns;
+		if(ns > st->max_recovery_ns)
+			st->max_recovery_ns = min_t(u64, ns, U32_MAX);
 	}
+	spin_unlock_irqrestore(&r->lock, flags);
 	return err;
 }
 
-static int ds90ub954_write_rx_port(struct ds90ub954_priv *priv, int rx_port,
-				   int addr, int val)
+static void ds90ub954_retry_init(struct ds90ub954_priv *priv)
 {
-	struct device *dev = &priv->client->dev;
-	int err = 0;
-	int port_reg = 0;
+	struct ds90ub954_retry *r = &priv->retry;
+
+	spin_lock_init(&r->lock);
+	r->policy[TARGET_LOCAL].retries = RETRY_LOCAL_DEFAULT;
+	r->policy[TARGET_LOCAL].backoff_us = RETRY_BACKOFF_DEFAULT_US;
+	r->policy[TARGET_REMOTE].retries = RETRY_REMOTE_DEFAULT;
+	r->policy[TARGET_REMOTE].backoff_us = RETRY_BACKOFF_DEFAULT_US;
+	r->fault.times = -1;
+}
 
-	/* rx_port = 0 -> choose rx_port 0
-	 * rx_port = 1 -> choose rx_port 1
-	 * rx_port = 2 -> choose rx_port 0 and 1 */
-	if(rx_port > 2 || rx_port < 0) {
-		dev_err(dev, "invalid port number %d. Cannot be selected\n",
-			rx_port);
-		err = -EINVAL;
-		goto write_rx_port_err;
-	}
+/*------------------------------------------------------------------------------
+ * PORT STATE
+ *----------------------------------------------------------------------------*/
 
-	/* Check if port is selected, select port if needed */
-	if(priv->sel_rx_port != rx_port) {
-		/* Set RX_WRITE_PORT_1 if rx_port is 1,
-		 * set RX_WRITE_PORT_0 if rx_port is 0,
-		 * set RX_WRITE_PORT_0 & _1 if rx_port is 2 */
-		if(rx_port == 2) {
-			port_reg |= (0b11);
-		} else {
-			/* Setting RX_WRITE_PORT_1 or _0 */
-			port_reg |= (1<<rx_port);
-			/* Setting RX_READ_PORT to rx_port */
-			port_reg |= (rx_port<<TI954_RX_READ_PORT);
-		}
+static const char * const ds90ub954_port_state_names[] = {
+	[PORT_DISABLED] = "disabled",
+	[PORT_TRAINING] = "training",
+	[PORT_LOCKED] = "locked",
+	[PORT_BC_READY] = "bc_ready",
+	[PORT_ALIASED] = "aliased",
+	[PORT_STREAMING] = "streaming",
+	[PORT_FAULT] = "fault",
+};
 
-		err = ds90ub954_write(priv, TI954_REG_FPD3_PORT_SEL, port_reg);
-		if(unlikely(err)) {
-			dev_err(&priv->client->dev,
-				"error writing register TI954_REG_FPD3_PORT_SEL (0x%02x)\n",
-				TI954_REG_FPD3_PORT_SEL);
-			goto write_rx_port_err;
-		}
-		priv->sel_rx_port = rx_port;
+/* transition of an rx port, traced with the time spent in the old state */
+static void ds90ub954_port_set_state(struct ds90ub954_priv *priv, int port,
+				     enum ds90ub954_port_state state)
+{
+	struct ds90ub954_port_sm *sm = &priv->ports.sm[port];
+	enum ds90ub954_port_state old;
+	ktime_t now = ktime_get();
+	s64 state_us, total_us;
+	unsigned long flags;
+
+	spin_lock_irqsave(&priv->ports.lock, flags);
+	old = sm->state;
+	if(old == state) {
+		spin_unlock_irqrestore(&priv->ports.lock, flags);
+		return;
 	}
-	err = ds90ub954_write(priv, addr, val);
-	if(unlikely(err)) {
-		dev_err(&priv->client->dev, "error writing register (0x%02x)\n",
-			addr);
-		goto write_rx_port_err;
+	if(state == PORT_TRAINING)
+		sm->enabled = now;
+	if(state == PORT_FAULT)
+		sm->faults++;
+	state_us = ktime_us_delta(now, sm->changed);
+	total_us = ktime_us_delta(now, sm->enabled);
+	sm->state = state;
+	sm->changed = now;
+	sm->entered[state] = now;
+	sm->transitions++;
+	spin_unlock_irqrestore(&priv->ports.lock, flags);
+
+	trace_ds90ub954_port_state(&priv->client->dev, port, old, state,
+				   state_us, total_us);
+}
+
+static enum ds90ub954_port_state
+ds90ub954_port_get_state(struct ds90ub954_priv *priv, int port)
+{
+	return READ_ONCE(priv->ports.sm[port].state);
+}
+
+static void ds90ub954_port_init(struct ds90ub954_priv *priv)
+{
+	ktime_t now = ktime_get();
+	int port;
+
+	spin_lock_init(&priv->ports.lock);
+	for(port = 0; port < TI960_NUM_RX_PORTS; port++) {
+		priv->ports.sm[port].state = PORT_DISABLED;
+		priv->ports.sm[port].changed = now;
+		priv->ports.sm[port].enabled = now;
 	}
+}
 
-write_rx_port_err:
-	return err;
+/*------------------------------------------------------------------------------
+ * PATTERN GENERATOR
+ *----------------------------------------------------------------------------*/
+
+/* csi-2 data types of the pattern generator, block: bytes of a pixel group */
+struct ds90ub954_pgen_format {
+	u8 dt;
+	u8 bpp;
+	u8 block_size;
+};
+
+static const struct ds90ub954_pgen_format ds90ub954_pgen_formats[] = {
+	{ 0x1e, 16, 4 }, /* YUV422 8 bit */
+	{ 0x22, 16, 2 }, /* RGB565 */
+	{ 0x24, 24, 3 }, /* RGB888 */
+	{ 0x2a, 8, 1 }, /* RAW8 */
+	{ 0x2b, 10, 5 }, /* RAW10 */
+	{ 0x2c, 12, 3 }, /* RAW12 */
+};
+
+/*
+ * 4096x2160 RAW10 color bars, the former fixed test pattern. Its TOT_LPF
+ * (0x0870) and LINE_PD (0x0b93) don't follow from the porches and the frame
+ * rate, they are kept as overrides.
+ */
+static void ds90ub954_pgen_default(struct ds90ub954_pgen *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->width = 4096;
+	cfg->height = 2160;
+	cfg->dt = 0x2b;
+	cfg->fps = 15;
+	cfg->line_pd = 2963;
+	cfg->tot_lpf = 2160;
+	cfg->vbp = 33;
+	cfg->vfp = 10;
+	cfg->num_bars = 8;
 }
 
-#ifdef DEBUG
-static int ds90ub954_read_rx_port(struct ds90ub954_priv *priv, int rx_port,
-				  int addr, int *val)
+/*
+ * Computes the pattern generator registers. The line period is taken from
+ * line_pd, else from the target bandwidth kbps, else from the frame rate.
+ * The total lines per frame are tot_lpf, else height and porches. csi_kbps
+ * is the csi-2 rate of all lanes, a line has to fit into its line period
+ * (0: not checked).
+ */
+static int ds90ub954_pgen_calc(const struct ds90ub954_pgen *cfg, u64 csi_kbps,
+			       struct ds90ub954_pgen_timing *t)
 {
-	struct device *dev = &priv->client->dev;
-	int err = 0;
-	int port_reg = 0;
+	const struct ds90ub954_pgen_format *fmt = NULL;
+	u64 payload;
+	int i;
 
-	/* rx_port = 0 -> choose rx_port 0
-	 * rx_port = 1 -> choose rx_port 1 */
-	if(rx_port > 2 || rx_port < 0) {
-		dev_err(dev, "invalid port number %d. Cannot be selected\n",
-			rx_port);
-		err = -EINVAL;
-		goto read_rx_port_err;
+	for(i = 0; i < ARRAY_SIZE(ds90ub954_pgen_formats); i++) {
+		if(ds90ub954_pgen_formats[i].dt == cfg->dt)
+			fmt = &ds90ub954_pgen_formats[i];
 	}
+	if(!fmt || cfg->vc < 0 || cfg->vc > 3 || cfg->width < 1 ||
+	   cfg->height < 1 || cfg->vbp < 0 || cfg->vbp > 0xff ||
+	   cfg->vfp < 0 || cfg->vfp > 0xff || cfg->tot_lpf < 0 ||
+	   (cfg->tot_lpf && cfg->tot_lpf < cfg->height))
+		return -EINVAL;
+	if(cfg->num_bars != 1 && cfg->num_bars != 2 && cfg->num_bars != 4 &&
+	   cfg->num_bars != 8)
+		return -EINVAL;
+
+	memset(t, 0, sizeof(*t));
+	t->line_size = cfg->width * fmt->bpp / 8;
+	if(t->line_size > 0xffff || cfg->width * fmt->bpp % 8 ||
+	   t->line_size % fmt->block_size)
+		return -EINVAL;
+	t->bar_size = rounddown(t->line_size / cfg->num_bars, fmt->block_size);
+	t->tot_lpf = cfg->tot_lpf ? cfg->tot_lpf :
+				    cfg->height + cfg->vbp + cfg->vfp;
+	if(t->tot_lpf > 0xffff)
+		return -EINVAL;
+
+	/* payload bits of a frame */
+	payload = (u64)t->line_size * 8 * cfg->height;
+	if(cfg->line_pd > 0)
+		t->line_pd = cfg->line_pd;
+	else if(cfg->kbps > 0)
+		t->line_pd = div64_u64(payload * (TI954_PGEN_CLK_HZ / 1000),
+				       (u64)cfg->kbps * t->tot_lpf);
+	else if(cfg->fps > 0)
+		t->line_pd = DIV_ROUND_CLOSEST(TI954_PGEN_CLK_HZ,
+					       cfg->fps * t->tot_lpf);
+	else
+		return -EINVAL;
+	if(t->line_pd < 1 || t->line_pd > TI954_PGEN_LINE_PD_MAX)
+		return -ERANGE;
+
+	/* a line has to be sent within its line period */
+	if(csi_kbps && (u64)t->line_size * 8 * (TI954_PGEN_CLK_HZ / 1000) >
+	   csi_kbps * t->line_pd)
+		return -ERANGE;
+
+	t->fps_milli = div64_u64((u64)TI954_PGEN_CLK_HZ * 1000,
+				 (u64)t->line_pd * t->tot_lpf);
+	t->kbps = div64_u64(payload * t->fps_milli, 1000000);
+
+	t->regs[TI954_REG_IA_PGEN_CTL] = (1<<TI954_PGEB_ENABLE);
+	t->regs[TI954_REG_IA_PGEB_CFG] = (cfg->fixed<<TI954_PGEN_FIXED_EN) |
+		(ilog2(cfg->num_bars)<<TI954_NUM_CBARS) |
+		(fmt->block_size<<TI954_BLOCK_SIZE);
+	t->regs[TI954_REG_IA_PGEN_CSI_DI] = (cfg->vc<<TI954_PGEN_CSI_VC) |
+		(cfg->dt<<TI954_PGEN_CSI_DT);
+	t->regs[TI954_REG_IA_PGEN_LINE_SIZE1] = t->line_size >> 8;
+	t->regs[TI954_REG_IA_PGEN_LINE_SIZE0] = t->line_size & 0xff;
+	t->regs[TI954_REG_IA_PGEN_BAR_SIZE1] = t->bar_size >> 8;
+	t->regs[TI954_REG_IA_PGEN_BAR_SIZE0] = t->bar_size & 0xff;
+	t->regs[TI954_REG_IA_PGEN_ACT_LPF1] = cfg->height >> 8;
+	t->regs[TI954_REG_IA_PGEN_ACT_LPF0] = cfg->height & 0xff;
+	t->regs[TI954_REG_IA_PGEN_TOT_LPF1] = t->tot_lpf >> 8;
+	t->regs[TI954_REG_IA_PGEN_TOT_LPF0] = t->tot_lpf & 0xff;
+	t->regs[TI954_REG_IA_PGEN_LINE_PD1] = t->line_pd >> 8;
+	t->regs[TI954_REG_IA_PGEN_LINE_PD0] = t->line_pd & 0xff;
+	t->regs[TI954_REG_IA_PGEN_VBP] = cfg->vbp;
+	t->regs[TI954_REG_IA_PGEN_VFP] = cfg->vfp;
+	memcpy(&t->regs[TI954_REG_IA_PGEN_COLOR0], cfg->color,
+	       TI954_PGEN_NUM_COLORS);
+	return 0;
+}
 
-	/* Check if port is selected, select port if needed */
-	if(priv->sel_rx_port != rx_port) {
-		/* Setting RX_WRITE_PORT_1 or _0 */
-		port_reg |= (1<<rx_port);
-		/* Setting RX_READ_PORT to rx_port */
-		port_reg |= (rx_port<<TI954_RX_READ_PORT);
+/*------------------------------------------------------------------------------
+ * REGISTER CACHE
+ *----------------------------------------------------------------------------*/
 
-		err = ds90ub954_write(priv, TI954_REG_FPD3_PORT_SEL, port_reg);
-		if(unlikely(err)) {
-			dev_err(&priv->client->dev,
-				"error writing register TI954_REG_FPD3_PORT_SEL (0x%02x)\n",
-				TI954_REG_FPD3_PORT_SEL);
-			goto read_rx_port_err;
-		}
-		priv->sel_rx_port = rx_port;
+/*
+ * Every successful write to a configuration register is recorded, paged
+ * registers in the page of the selected rx port. The device loses them when
+ * PDB is low; in that time writes only go to the cache and reads are served
+ * from it. On resume the cache is written back with bulk writes.
+ */
+
+/* paged registers of an rx port, selected by FPD3_PORT_SEL */
+static const u8 ds90ub954_paged[][2] = {
+	{ TI954_REG_PAR_ERR_THOLD_HI, TI954_REG_PAR_ERR_THOLD_LO },
+	{ TI954_REG_RX_PORT_STS1, TI954_REG_SEN_INT_FALL_CTL },
+	{ TI954_REG_PORT_DEBUG, TI954_REG_SEN_INT_FALL_STS },
+};
+
+/* not replayed: resets, page and indirect access selection, status */
+static const u8 ds90ub954_cache_skip[] = {
+	TI954_REG_RESET, TI954_REG_DEVICE_STS, TI954_REG_FPD3_PORT_SEL,
+	TI954_REG_IND_ACC_CTL, TI954_REG_IND_ACC_ADDR, TI954_REG_IND_ACC_DATA,
+	TI954_REG_CSI_TX_ISR, TI954_REG_BCC_STATUS, TI954_REG_RX_PORT_STS1,
+	TI954_REG_RX_PORT_STS2, TI954_REG_RX_PAR_ERR_HI,
+	TI954_REG_RX_PAR_ERR_LO, TI954_REG_CSI_RX_STS,
+	TI954_REG_CSI_ERR_COUNTER, TI954_REG_PORT_ISR_HI,
+	TI954_REG_PORT_ISR_LO, TI954_REG_SEN_INT_RISE_STS,
+	TI954_REG_SEN_INT_FALL_STS,
+};
+
+static const u8 ds90ub953_cache_skip[] = {
+	TI953_REG_RESET, TI953_REG_DEVICE_STS, TI953_REG_IND_ACC_CTL,
+	TI953_REG_IND_ACC_ADDR, TI953_REG_IND_ACC_DATA, TI953_REG_CSI_ERR_CNT,
+	TI953_REG_CSI_ERR_STATUS, TI953_REG_CSI_ERR_DLANE01,
+	TI953_REG_CSI_ERR_DLANE23, TI953_REG_CSI_ERR_CLK_LANE,
+};
+
+static int ds90ub954_reg_listed(const u8 *regs, int num, unsigned int reg)
+{
+	int i;
+
+	for(i = 0; i < num; i++) {
+		if(regs[i] == reg)
+			return 1;
 	}
-	err = ds90ub954_read(priv, addr, val);
-	if(unlikely(err)) {
-		dev_err(&priv->client->dev, "error read register (0x%02x)\n",
-			addr);
-		goto read_rx_port_err;
+	return 0;
+}
+
+static int ds90ub954_reg_paged(unsigned int reg)
+{
+	int i;
+
+	for(i = 0; i < ARRAY_SIZE(ds90ub954_paged); i++) {
+		if(reg >= ds90ub954_paged[i][0] && reg <= ds90ub954_paged[i][1])
+			return 1;
 	}
+	return 0;
+}
 
-read_rx_port_err:
-	return err;
+static bool ds90ub954_cache_only(struct ds90ub954_priv *priv)
+{
+	return READ_ONCE(priv->pm.cache_only);
 }
 
-static int ds90ub954_read_ia_reg(struct ds90ub954_priv *priv, int reg, int *val,
-				 int ia_config)
+static void ds90ub954_regcache_set(struct ds90ub954_regcache *c,
+				   unsigned int reg, unsigned int val)
 {
-	int err = 0;
+	c->val[reg] = val;
+	set_bit(reg, c->valid);
+}
 
-	/* ia_configs:
-	 *	0000: CSI-2 Pattern Generator & Timing Registers
-	 *	0001: FPD-Link III RX Port 0 Reserved Registers
-	 *	0010: FPD-Link III RX Port 1 Reserved Registers
-	 *	0101: FPD-Link III RX Shared Reserved Registers
-	 *	0110: Simultaneous write to FPD-Link III RX Reserved */
+static void ds90ub954_regcache_update(struct ds90ub954_priv *priv,
+				      unsigned int reg, unsigned int val)
+{
+	int port = READ_ONCE(priv->sel_rx_port);
+	unsigned long flags;
+	int i;
 
-	/* Check if bank is selected, select bank if needed */
-	if(priv->sel_ia_config != ia_config) {
-		err = ds90ub954_write(priv, TI954_REG_IND_ACC_CTL, ia_config);
-		if(unlikely(err)) {
-			dev_err(&priv->client->dev,
-				"error writing register TI954_REG_IND_ACC_CTL (0x%02x)\n",
-				TI954_REG_IND_ACC_CTL);
-			goto read_ia_reg_err;
-		}
-		priv->sel_ia_config = ia_config;
-	}
-	err = ds90ub954_write(priv, TI954_REG_IND_ACC_ADDR, reg);
-	if(unlikely(err)) {
-		dev_err(&priv->client->dev,
-			"error writing register TI954_REG_IND_ACC_ADDR (0x%02x)\n",
-			TI954_REG_IND_ACC_ADDR);
-		goto read_ia_reg_err;
+	if(reg >= REGCACHE_NUM_REGS ||
+	   ds90ub954_reg_listed(ds90ub954_cache_skip,
+				ARRAY_SIZE(ds90ub954_cache_skip), reg))
+		return;
+
+	spin_lock_irqsave(&priv->cache_lock, flags);
+	if(!ds90ub954_reg_paged(reg)) {
+		ds90ub954_regcache_set(&priv->cache[0], reg, val);
+	} else if(port == priv->chip->num_rx_ports) {
+		/* written to all rx ports */
+		for(i = 0; i < port; i++)
+			ds90ub954_regcache_set(&priv->cache[1 + i], reg, val);
+	} else if(port >= 0) {
+		ds90ub954_regcache_set(&priv->cache[1 + port], reg, val);
 	}
+	spin_unlock_irqrestore(&priv->cache_lock, flags);
+}
 
-	err = ds90ub954_read(priv, TI954_REG_IND_ACC_DATA, val);
-	if(unlikely(err)) {
-		dev_err(&priv->client->dev,
-			"error reading register TI954_REG_IND_ACC_DATA (0x%02x)\n",
-			TI954_REG_IND_ACC_DATA);
-		goto read_ia_reg_err;
+static int ds90ub954_regcache_read(struct ds90ub954_priv *priv,
+				   unsigned int reg, unsigned int *val)
+{
+	int port = READ_ONCE(priv->sel_rx_port);
+	struct ds90ub954_regcache *c = &priv->cache[0];
+	unsigned long flags;
+	int err = 0;
+
+	if(reg >= REGCACHE_NUM_REGS)
+		return -EBUSY;
+	if(ds90ub954_reg_paged(reg)) {
+		if(port < 0 || port >= priv->chip->num_rx_ports)
+			return -EBUSY;
+		c = &priv->cache[1 + port];
 	}
 
-read_ia_reg_err:
+	spin_lock_irqsave(&priv->cache_lock, flags);
+	if(test_bit(reg, c->valid))
+		*val = c->val[reg];
+	else
+		err = -EBUSY;
+	spin_unlock_irqrestore(&priv->cache_lock, flags);
 	return err;
 }
-#endif
 
-static int ds90ub954_disable_testpattern(struct ds90ub954_priv *priv)
+static void ds90ub953_regcache_update(struct ds90ub953_priv *priv,
+				      unsigned int reg, unsigned int val)
 {
-	struct device *dev = &priv->client->dev;
+	unsigned long flags;
+
+	if(reg >= REGCACHE_NUM_REGS ||
+	   ds90ub954_reg_listed(ds90ub953_cache_skip,
+				ARRAY_SIZE(ds90ub953_cache_skip), reg))
+		return;
+
+	spin_lock_irqsave(&priv->cache_lock, flags);
+	ds90ub954_regcache_set(&priv->cache, reg, val);
+	spin_unlock_irqrestore(&priv->cache_lock, flags);
+}
+
+static int ds90ub953_regcache_read(struct ds90ub953_priv *priv,
+				   unsigned int reg, unsigned int *val)
+{
+	unsigned long flags;
 	int err = 0;
-	/* Indirect Pattern Gen Registers */
-	err = ds90ub954_write(priv, 0xB0, 0x00);
-	if(err)
-		goto init_err;
-	err = ds90ub954_write(priv, 0xB1, TI954_REG_IA_PGEN_CTL);
-	if(err)
-		goto init_err;
-	err = ds90ub954_write(priv, 0xB2, (0<<TI954_PGEB_ENABLE));
-	if(err)
-		goto init_err;
-init_err:
-	dev_info(dev, "%s: disable test pattern failed\n", __func__);
+
+	if(reg >= REGCACHE_NUM_REGS)
+		return -EBUSY;
+
+	spin_lock_irqsave(&priv->cache_lock, flags);
+	if(test_bit(reg, priv->cache.valid))
+		*val = priv->cache.val[reg];
+	else
+		err = -EBUSY;
+	spin_unlock_irqrestore(&priv->cache_lock, flags);
 	return err;
 }
 
-static int ds90ub954_init_testpattern(struct ds90ub954_priv *priv)
+/*------------------------------------------------------------------------------
+ * DS90UB954 FUNCTIONS
+ *----------------------------------------------------------------------------*/
+
+static int ds90ub954_read(struct ds90ub954_priv *priv, unsigned int reg,
+			  unsigned int *val)
 {
-	struct device *dev = &priv->client->dev;
-	int i, err = 0;
-	for(i = 0; i < ARRAY_SIZE(ds90ub95x_tp_reg_val); i += 2) {
+	ktime_t start;
+	u64 ns;
+	int err;
 
-		err = ds90ub954_write(priv, ds90ub95x_tp_reg_val[i],
-					    ds90ub95x_tp_reg_val[i+1]);
-		if(unlikely(err)) {
-			dev_info(dev, "%s: enable test pattern failed\n", __func__);
-			return err;
-		}
+	if(ds90ub954_cache_only(priv))
+		return ds90ub954_regcache_read(priv, reg, val);
+
+	start = ktime_get();
+	err = ds90ub954_regmap_xfer(priv, priv->regmap, TARGET_LOCAL, 0, reg,
+				    val);
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	ds90ub954_reg_hist_add(&priv->hist, reg, 0, err, ns);
+	trace_ds90ub954_read(&priv->client->dev, READ_ONCE(priv->sel_rx_port),
+			     reg, err ? 0 : *val, err, ns);
+	if(err) {
+		dev_err(&priv->client->dev,
+			"Cannot read register 0x%02x (%d)!\n", reg, err);
 	}
-	dev_info(dev, "%s: enable test pattern successful\n", __func__);
 	return err;
 }
 
-#ifdef DEBUG
-static int ds90ub954_debug_prints(struct ds90ub954_priv *priv)
+static int ds90ub954_write(struct ds90ub954_priv *priv, unsigned int reg,
+			   unsigned int val)
 {
-	int i, val, ia_config = 0, err = 0;
-	/* print CSI timing of tx port 0 */
-	dev_info(dev, "%s: CSI timing\n", __func__);
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TCK_PREP, &val,
-					ia_config);
-	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: TCK_PREP: 0x%02x\n", __func__, val);
+	ktime_t start;
+	u64 ns;
+	int err;
 
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TCK_ZERO, &val,
-					ia_config);
-	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: TCK_ZERO: 0x%02x\n", __func__, val);
+	if(ds90ub954_cache_only(priv)) {
+		ds90ub954_regcache_update(priv, reg, val);
+		return 0;
+	}
 
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TCK_TRAIL, &val,
-					ia_config);
-	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: TCK_TRAIL: 0x%02x\n", __func__, val);
+	start = ktime_get();
+	err = ds90ub954_regmap_xfer(priv, priv->regmap, TARGET_LOCAL, 1, reg,
+				    &val);
+	if(!err)
+		ds90ub954_regcache_update(priv, reg, val);
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	ds90ub954_reg_hist_add(&priv->hist, reg, 1, err, ns);
+	trace_ds90ub954_write(&priv->client->dev, READ_ONCE(priv->sel_rx_port),
+			      reg, val, err, ns);
+	if(err) {
+		dev_err(&priv->client->dev,
+			"Cannot write register 0x%02x (%d)!\n", reg, err);
+	}
+	return err;
+}
 
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TCK_POST, &val,
-					ia_config);
-	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: TCK_POST: 0x%02x\n", __func__, val);
+/* burst read of consecutive registers of the deserializer or a serializer */
+static int ds90ub954_read_bulk(struct ds90ub954_priv *priv, struct regmap *map,
+			       unsigned int reg, u8 *buf, size_t len)
+{
+	int err;
 
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_THS_PREP, &val,
-					ia_config);
-	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: THS_PREP: 0x%02x\n", __func__, val);
+	if(ds90ub954_cache_only(priv))
+		return -EBUSY;
 
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_THS_ZERO, &val,
-					ia_config);
-	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: THS_ZERO: 0x%02x\n", __func__, val);
+	err = regmap_bulk_read(map, reg, buf, len);
+	if(err) {
+		dev_err(&priv->client->dev,
+			"Cannot read %zu registers from 0x%02x (%d)!\n", len,
+			reg, err);
+	}
+	return err;
+}
 
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_THS_TRAIL, &val,
-					ia_config);
-	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: THS_TRAIL: 0x%02x\n", __func__, val);
+/* burst write of consecutive registers, not recorded in the register cache */
+static int ds90ub954_write_bulk(struct ds90ub954_priv *priv, struct regmap *map,
+				unsigned int reg, const u8 *buf, size_t len)
+{
+	int err;
 
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_THS_EXIT, &val,
-					ia_config);
-	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: THS_EXIT: 0x%02x\n", __func__, val);
+	err = regmap_bulk_write(map, reg, buf, len);
+	if(err) {
+		dev_err(&priv->client->dev,
+			"Cannot write %zu registers to 0x%02x (%d)!\n", len,
+			reg, err);
+	}
+	return err;
+}
 
-	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TPLX, &val,
-					ia_config);
+/* read-modify-write of a global register under the device lock */
+static int ds90ub954_update_bits(struct ds90ub954_priv *priv, unsigned int reg,
+				 unsigned int mask, unsigned int val)
+{
+	unsigned int tmp;
+	int err;
+
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_read(priv, reg, &tmp);
 	if(unlikely(err))
-		return err;
-	dev_info(dev, "%s: CSI0_TPLX: 0x%02x\n", __func__, val);
+		goto update_err;
 
-	/* measure refclk */
-	for(i = 0; i < 5; i++) {
-		err = ds90ub954_read(priv, TI954_REG_REFCLK_FREQ, &val);
-		if(err)
-			return err;
-		dev_info(dev, "%s: REFCLK_FREQ measurement %d, %d\n", __func__,
-			 i, val);
-	}
+	tmp = (tmp & ~mask) | (val & mask);
+	err = ds90ub954_write(priv, reg, tmp);
+update_err:
+	mutex_unlock(&priv->reg_lock);
 	return err;
-};
-#endif
+}
 
-static int ds90ub954_init(struct ds90ub954_priv *priv, int rx_port)
+/* Select the rx port of the paged registers, rx_port == num_rx_ports selects
+ * all rx ports for writing */
+static int ds90ub954_select_rx_port_locked(struct ds90ub954_priv *priv,
+					   int rx_port)
 {
 	struct device *dev = &priv->client->dev;
-	unsigned char dev_id, rev;
-	int i, val;
+	int num_rx_ports = priv->chip->num_rx_ports;
 	int err = 0;
-	char id_code[TI954_RX_ID_LENGTH + 1];
-	int ser_nr = 0;
-	struct ds90ub953_priv *ds90ub953;
-
-	/*----------------------------------------------------------------------
-	 *  init deserializer
-	 *--------------------------------------------------------------------*/
-	dev_info(dev, "%s starting\n", __func__);
+	int port_reg = 0;
 
-	/* Read device id of deserializer */
-	err = ds90ub954_read(priv, TI954_REG_I2C_DEV_ID, &val);
-	if(unlikely(err))
-		goto init_err;
+	lockdep_assert_held(&priv->reg_lock);
 
-	dev_id = (unsigned char)val;
+	if(rx_port > num_rx_ports || rx_port < 0) {
+		dev_err(dev, "invalid port number %d. Cannot be selected\n",
+			rx_port);
+		return -EINVAL;
+	}
 
-	/* Read revision ID of deserializer */
-	err = ds90ub954_read(priv, TI954_REG_REVISION, &val);
-	if(unlikely(err))
-		goto init_err;
+	/* Check if port is selected, select port if needed */
+	if(priv->sel_rx_port == rx_port)
+		return 0;
 
-	rev = (unsigned char)val;
+	if(rx_port == num_rx_ports) {
+		/* Setting RX_WRITE_PORT_x of all ports */
+		port_reg |= ((1<<num_rx_ports)-1)<<TI954_RX_WRITE_PORT_0;
+	} else {
+		/* Setting RX_WRITE_PORT_x */
+		port_reg |= (1<<(TI954_RX_WRITE_PORT_0+rx_port));
+		/* Setting RX_READ_PORT to rx_port */
+		port_reg |= (rx_port<<TI954_RX_READ_PORT);
+	}
 
-	/* Read FPD3_RX_ID3 registers */
-	memset(id_code, 0, sizeof(id_code));
-	for(i = 0; i < TI954_RX_ID_LENGTH; i++) {
-		err = ds90ub954_read(priv, TI954_REG_FPD3_RX_ID0 + i, &val);
-		if(err) {
-			goto init_err;
-		}
-		id_code[i] = (char)val;
+	err = ds90ub954_write(priv, TI954_REG_FPD3_PORT_SEL, port_reg);
+	if(unlikely(err)) {
+		dev_err(dev,
+			"error writing register TI954_REG_FPD3_PORT_SEL (0x%02x)\n",
+			TI954_REG_FPD3_PORT_SEL);
+		return err;
 	}
-	dev_info(dev, "%s: device ID: 0x%x, code:%s, revision: 0x%x\n",
-		 __func__, dev_id, id_code, rev);
+	priv->sel_rx_port = rx_port;
+	return 0;
+}
 
-	/* disable BuiltIn Self Test */
-	err = ds90ub954_write(priv, TI954_REG_BIST_CONTROL, 0);
+static int ds90ub954_write_rx_port(struct ds90ub954_priv *priv, int rx_port,
+				   int addr, int val)
+{
+	int err = 0;
+
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_select_rx_port_locked(priv, rx_port);
 	if(unlikely(err))
-		goto init_err;
+		goto write_rx_port_err;
 
-	/* set CSI speed (REFCLK 25 MHz)
-	*  00 : 1.6 Gbps serial rate
-	*  01 : Reserved
-	*  10 : 800 Mbps serial rate
-	*  11 : 400 Mbps serial rate */
-	switch(priv->csi_lane_speed) {
-	case 400:
-		val=0x3;
-		break;
-	case 800:
-		val=0x2;
-		break;
-	default:
-		val=0x0;
-		break;
+	err = ds90ub954_write(priv, addr, val);
+	if(unlikely(err)) {
+		dev_err(&priv->client->dev, "error writing register (0x%02x)\n",
+			addr);
+		goto write_rx_port_err;
 	}
 
-	err = ds90ub954_write(priv, TI954_REG_CSI_PLL_CTL,
-				(val<<TI954_CSI_TX_SPEED));
-	if(unlikely(err))
-		goto init_err;
-#ifdef DEBUG
-	err = ds90ub954_debug_prints(priv);
-	if(unlikely(err))
-		goto init_err;
-#endif
-	/* set number of csi lanes */
-	switch(priv->csi_lane_count) {
-	case 1:
-		val = TI954_CSI_1_LANE;
-		break;
-	case 2:
-		val = TI954_CSI_2_LANE;
-		break;
-	case 3:
-		val = TI954_CSI_3_LANE;
-		break;
-	default:
-		val = TI954_CSI_4_LANE;
-		break;
-	}
+write_rx_port_err:
+	mutex_unlock(&priv->reg_lock);
+	return err;
+}
 
-	err = ds90ub954_write(priv, TI954_REG_CSI_CTL,
-				(1<<TI954_CSI_ENABLE)|
-				(priv->conts_clk<<TI954_CSI_CONTS_CLOCK)|
-				(val<<TI954_CSI_LANE_COUNT)|
-				(1<<TI954_CSI_CAL_EN));
-	if(unlikely(err))
-		goto init_err;
+/*------------------------------------------------------------------------------
+ * I2C ALIAS ALLOCATION
+ *----------------------------------------------------------------------------*/
 
-	msleep(500);
+/* Check if a host address is already used as alias by any serializer */
+static int ds90ub954_alias_in_use(struct ds90ub954_priv *priv, int alias)
+{
+	struct ds90ub953_priv *ser;
+	int ser_nr, i;
 
-	/* check if test pattern should be turned on */
-	if(priv->test_pattern == 1) {
-		dev_info(dev, "%s: deserializer init testpattern\n", __func__);
-		err = ds90ub954_init_testpattern(priv);
-		if(unlikely(err)) {
-			dev_info(dev,
-				"%s: deserializer init testpattern failed\n",
-				__func__);
+	for(ser_nr = 0; ser_nr < priv->num_ser; ser_nr++) {
+		ser = priv->ser[ser_nr];
+		if(!ser)
+			continue;
+		if(ser->i2c_address == alias)
+			return 1;
+		for(i = 0; i < NUM_ALIAS; i++) {
+			if(ser->alias[i].slave && ser->alias[i].alias == alias)
+				return 1;
 		}
 	}
+	return 0;
+}
 
-	/* Setting PASS and LOCK to "all enabled receiver ports */
-	val = 0b00111100;
-	err = ds90ub954_write(priv, TI954_REG_RX_PORT_CTL, val);
-	if(unlikely(err))
-		goto init_err;
+static int ds90ub954_alias_match(struct device *dev, void *data)
+{
+	struct i2c_client *client = i2c_verify_client(dev);
 
-	/* for loop goes through each serializer */
-	for( ; ser_nr < priv->num_ser; ser_nr++) {
-		ds90ub953 = priv->ser[ser_nr];
-		if(ds90ub953->initialized == 0) {
-			continue;
-		}
-		rx_port = ds90ub953->rx_channel;
+	return client && client->addr == *(int *)data;
+}
 
-		dev_info(dev, "%s: start init of serializer rx_port %i\n",
-			 __func__, rx_port);
+/* A host client at the alias (e.g. a sensor driver) keeps its slot */
+static int ds90ub954_alias_bound(struct ds90ub954_priv *priv, int alias)
+{
+	return device_for_each_child(&priv->client->adapter->dev, &alias,
+				     ds90ub954_alias_match);
+}
 
-		/* Get TI954_REG_RX_PORT_CTL and enable receiver rx_port */
-		err = ds90ub954_read(priv, TI954_REG_RX_PORT_CTL, &val);
-		if(unlikely(err))
-			goto ser_init_failed;
+static int ds90ub954_alias_program(struct ds90ub954_priv *priv,
+				   struct ds90ub953_priv *ser, int slot,
+				   int slave, int alias)
+{
+	int rx_port = ser->rx_channel;
+	int err;
 
-		val |= (1<<(TI954_PORT0_EN+rx_port));
-		err = ds90ub954_write(priv, TI954_REG_RX_PORT_CTL, val);
-		if(unlikely(err))
-			goto ser_init_failed;
+	/* disable the alias first, so the old slave never sees traffic that
+	 * is meant for the new one while the slot is being reprogrammed */
+	err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_ALIAS_ID0+slot,
+				      0);
+	if(unlikely(err))
+		return err;
 
-		/* wait for receiver to calibrate link */
-		msleep(400);
+	err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_SLAVE_ID0+slot,
+				      (slave<<TI954_SLAVE_ID0));
+	if(unlikely(err))
+		return err;
 
-		/* enable csi forwarding */
-		err = ds90ub954_read(priv, TI954_REG_FWD_CTL1, &val);
-		if(unlikely(err))
-			goto ser_init_failed;
+	return ds90ub954_write_rx_port(priv, rx_port, TI954_REG_ALIAS_ID0+slot,
+				       (alias<<TI954_ALIAS_ID0));
+}
 
-		val &= (0xEF<<rx_port);
-		err = ds90ub954_write(priv, TI954_REG_FWD_CTL1, val);
-		if(unlikely(err))
-			goto ser_init_failed;
+/*
+ * Return the host address a remote slave is reachable at. If the slave has no
+ * alias yet, one is taken from the alias pool and programmed into a free
+ * SLAVE_ID/ALIAS_ID slot of the serializer's rx port. If all slots are in use,
+ * the least recently used dynamic slot is reclaimed. Slots with a host client
+ * at their alias are never reclaimed, the client would silently talk to the
+ * new slave. pin (ALIAS_PIN_*) pins a dynamic slot, e.g. for a client that is
+ * instantiated at the alias.
+ */
+static int ds90ub954_alias_pin(struct ds90ub954_priv *priv,
+			       struct ds90ub953_priv *ser, int slave, int pin)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub953_alias *slot = NULL;
+	int i, alias = 0, err = 0;
 
-		msleep(500);
+	if(slave <= 0 || slave > 0x7f)
+		return -EINVAL;
 
-		/* config back channel RX port [specific register] */
-		err = ds90ub954_write_rx_port(priv, rx_port,
-				TI954_REG_BCC_CONFIG,
-				(TI954_BC_FREQ_50M<<TI954_BC_FREQ_SELECT)|
-				(1<<TI954_BC_CRC_GENERAOTR_ENABLE)|
-				(1<<TI954_BC_ALWAYS_ON)|
-				(ds90ub953->i2c_pt<<TI954_I2C_PASS_THROUGH_ALL)|
-				(1<<TI954_I2C_PASS_THROUGH));
-		if(unlikely(err))
-			goto ser_init_failed;
+	mutex_lock(&priv->alias_lock);
 
-		 /* wait for back channel */
-		for(i = 0; i < 50; i++) {
-			msleep(10);
-			err = ds90ub954_read(priv, TI954_REG_DEVICE_STS, &val);
-			if(unlikely(err))
-				goto ser_init_failed;
-			dev_info(dev, "%s: DEVICE STS: 0x%02x, id=%d x 10ms\n",
-				 __func__, val, i);
-			if((val & 0xff) == 0xdf) {
-				i = 0;
-				dev_info(dev, "%s: backchannel is ready\n",
-					 __func__);
+	for(i = 0; i < NUM_ALIAS; i++) {
+		if(ser->alias[i].slave == slave) {
+			slot = &ser->alias[i];
+			goto alias_found;
+		}
+	}
+
+	/* take a free slot or the least recently used dynamic one */
+	for(i = 0; i < NUM_ALIAS; i++) {
+		if(ser->alias[i].slave == 0) {
+			slot = &ser->alias[i];
+			break;
+		}
+		if(ser->alias[i].pinned ||
+		   ds90ub954_alias_bound(priv, ser->alias[i].alias))
+			continue;
+		if(!slot || ser->alias[i].last_used < slot->last_used)
+			slot = &ser->alias[i];
+	}
+	if(!slot) {
+		/* the remote write queue sends its messages and retries */
+		if(pin != ALIAS_PIN_BATCH)
+			dev_err(dev, "%s: rx_port %i: all alias slots are pinned or bound\n",
+				__func__, ser->rx_channel);
+		err = -EBUSY;
+		goto alias_err;
+	}
+
+	if(slot->slave) {
+		/* reuse the host address of the reclaimed slot */
+		alias = slot->alias;
+		dev_dbg(dev, "%s: rx_port %i: reclaim alias 0x%X from slave 0x%X\n",
+			__func__, ser->rx_channel, alias, slot->slave);
+	} else {
+		for(i = 0; i < priv->alias_pool_num; i++) {
+			if(!ds90ub954_alias_in_use(priv, priv->alias_pool[i]) &&
+			   !ds90ub954_alias_bound(priv, priv->alias_pool[i])) {
+				alias = priv->alias_pool[i];
 				break;
 			}
 		}
-		if(i) {
-			dev_err(dev, "%s: Backchannel setup failed!\n", __func__);
-			err = -EIO;
-			goto ser_init_failed;
-		}
-#ifdef DEBUG
-		/* check PORT_STS1 */
-		for(i = 0; i < 2; i++) {
-			err = ds90ub954_read_rx_port(priv, rx_port,
-							TI954_REG_RX_PORT_STS1,
-							&val);
-			if(unlikely(err))
-				goto ser_init_failed;
-			dev_info(dev, "%s: RX_PORT_STS1 read %d, 0x%02x\n",
-				 __func__, i, val);
+		if(!alias) {
+			dev_err(dev, "%s: alias pool exhausted\n", __func__);
+			err = -ENOSPC;
+			goto alias_err;
 		}
+	}
 
-		/* check PORT_STS2 */
-		for(i = 0; i < 2; i++) {
-			err = ds90ub954_read_rx_port(priv, rx_port,
-							TI954_REG_RX_PORT_STS2,
-							&val);
-			if(unlikely(err))
-				goto ser_init_failed;
-			dev_info(dev, "%s: RX_PORT_STS2 read %d, 0x%02x\n",
-				 __func__, i, val);
-		}
-#endif
-		/* setup i2c forwarding */
-		err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_SER_ALIAS_ID,
-				(ds90ub953->i2c_address<<TI954_SER_ALIAS_ID));
-		if(unlikely(err))
-			goto ser_init_failed;
+	err = ds90ub954_alias_program(priv, ser, slot - ser->alias, slave,
+				      alias);
+	if(unlikely(err)) {
+		slot->slave = 0;
+		goto alias_err;
+	}
+	slot->slave = slave;
+	slot->alias = alias;
+	slot->pinned = ALIAS_PIN_NONE;
+	slot->use_count = 0;
+	dev_dbg(dev, "%s: rx_port %i: slave 0x%X mapped to alias 0x%X\n",
+		__func__, ser->rx_channel, slave, alias);
+
+alias_found:
+	if(!slot->pinned)
+		slot->pinned = pin;
+	slot->last_used = ++priv->alias_seq;
+	slot->use_count++;
+	err = slot->alias;
+alias_err:
+	mutex_unlock(&priv->alias_lock);
+	return err;
+}
+
+static int ds90ub954_alias_get(struct ds90ub954_priv *priv,
+			       struct ds90ub953_priv *ser, int slave)
+{
+	return ds90ub954_alias_pin(priv, ser, slave, ALIAS_PIN_NONE);
+}
+
+/*
+ * The slot at alias pinned by owner pin becomes dynamic again. alias 0 unpins
+ * all slots of the owner.
+ */
+static void ds90ub954_alias_unpin(struct ds90ub954_priv *priv,
+				  struct ds90ub953_priv *ser, int alias, int pin)
+{
+	int i;
+
+	mutex_lock(&priv->alias_lock);
+	for(i = 0; i < NUM_ALIAS; i++) {
+		if(ser->alias[i].slave && ser->alias[i].pinned == pin &&
+		   (!alias || ser->alias[i].alias == alias))
+			ser->alias[i].pinned = ALIAS_PIN_NONE;
+	}
+	mutex_unlock(&priv->alias_lock);
+}
+
+static int ds90ub954_read_rx_port(struct ds90ub954_priv *priv, int rx_port,
+				  int addr, int *val)
+{
+	struct device *dev = &priv->client->dev;
+	int err = 0;
+
+	/* reading is only possible from a single rx_port */
+	if(rx_port >= priv->chip->num_rx_ports || rx_port < 0) {
+		dev_err(dev, "invalid port number %d. Cannot be selected\n",
+			rx_port);
+		err = -EINVAL;
+		goto read_rx_port_err;
+	}
+
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_select_rx_port_locked(priv, rx_port);
+	if(unlikely(err))
+		goto read_rx_port_unlock;
+
+	err = ds90ub954_read(priv, addr, val);
+	if(unlikely(err))
+		dev_err(&priv->client->dev, "error read register (0x%02x)\n",
+			addr);
+
+read_rx_port_unlock:
+	mutex_unlock(&priv->reg_lock);
+read_rx_port_err:
+	return err;
+}
+
+/* Select the indirect access bank, called with reg_lock held */
+static int ds90ub954_select_ia_locked(struct ds90ub954_priv *priv,
+				      int ia_config)
+{
+	int err = 0;
+
+	lockdep_assert_held(&priv->reg_lock);
+
+	/* ia_configs:
+	 *	0000: CSI-2 Pattern Generator & Timing Registers
+	 *	0001: FPD-Link III RX Port 0 Reserved Registers
+	 *	0010: FPD-Link III RX Port 1 Reserved Registers
+	 *	0101: FPD-Link III RX Shared Reserved Registers
+	 *	0110: Simultaneous write to FPD-Link III RX Reserved */
+
+	/* Check if bank is selected, select bank if needed */
+	if(priv->sel_ia_config != ia_config) {
+		err = ds90ub954_write(priv, TI954_REG_IND_ACC_CTL, ia_config);
+		if(unlikely(err)) {
+			dev_err(&priv->client->dev,
+				"error writing register TI954_REG_IND_ACC_CTL (0x%02x)\n",
+				TI954_REG_IND_ACC_CTL);
+			priv->sel_ia_config = -1;
+			return err;
+		}
+		priv->sel_ia_config = ia_config;
+	}
+	return err;
+}
+
+static int ds90ub954_write_ia_reg(struct ds90ub954_priv *priv, int reg, int val,
+				  int ia_config)
+{
+	int err = 0;
+
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_select_ia_locked(priv, ia_config);
+	if(unlikely(err))
+		goto write_ia_reg_err;
+
+	err = ds90ub954_write(priv, TI954_REG_IND_ACC_ADDR, reg);
+	if(unlikely(err)) {
+		dev_err(&priv->client->dev,
+			"error writing register TI954_REG_IND_ACC_ADDR (0x%02x)\n",
+			TI954_REG_IND_ACC_ADDR);
+		goto write_ia_reg_err;
+	}
+
+	err = ds90ub954_write(priv, TI954_REG_IND_ACC_DATA, val);
+	if(unlikely(err)) {
+		dev_err(&priv->client->dev,
+			"error writing register TI954_REG_IND_ACC_DATA (0x%02x)\n",
+			TI954_REG_IND_ACC_DATA);
+		goto write_ia_reg_err;
+	}
+
+write_ia_reg_err:
+	mutex_unlock(&priv->reg_lock);
+	return err;
+}
+
+#ifdef DEBUG
+static int ds90ub954_read_ia_reg(struct ds90ub954_priv *priv, int reg, int *val,
+				 int ia_config)
+{
+	int err = 0;
+
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_select_ia_locked(priv, ia_config);
+	if(unlikely(err))
+		goto read_ia_reg_err;
+
+	err = ds90ub954_write(priv, TI954_REG_IND_ACC_ADDR, reg);
+	if(unlikely(err)) {
+		dev_err(&priv->client->dev,
+			"error writing register TI954_REG_IND_ACC_ADDR (0x%02x)\n",
+			TI954_REG_IND_ACC_ADDR);
+		goto read_ia_reg_err;
+	}
+
+	err = ds90ub954_read(priv, TI954_REG_IND_ACC_DATA, val);
+	if(unlikely(err)) {
+		dev_err(&priv->client->dev,
+			"error reading register TI954_REG_IND_ACC_DATA (0x%02x)\n",
+			TI954_REG_IND_ACC_DATA);
+		goto read_ia_reg_err;
+	}
+
+read_ia_reg_err:
+	mutex_unlock(&priv->reg_lock);
+	return err;
+}
+#endif
+
+static int ds90ub954_disable_testpattern(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	int err = 0;
+	/* Indirect Pattern Gen Registers */
+	err = ds90ub954_write_ia_reg(priv, TI954_REG_IA_PGEN_CTL,
+				     (0<<TI954_PGEB_ENABLE), 0);
+	if(err)
+		dev_warn(dev, "%s: disable test pattern failed\n", __func__);
+	return err;
+}
+
+/* csi-2 rate of all lanes in kbit/s */
+static u64 ds90ub954_csi_kbps(struct ds90ub954_priv *priv)
+{
+	return (u64)priv->csi_lane_count * priv->csi_lane_speed * 1000;
+}
+
+/*
+ * Writes the pattern generator registers with auto increment: the generator
+ * is stopped, reconfigured and started again.
+ */
+static int ds90ub954_write_pgen(struct ds90ub954_priv *priv,
+				const struct ds90ub954_pgen_timing *t)
+{
+	struct device *dev = &priv->client->dev;
+	int reg, err = 0;
+
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_select_ia_locked(priv, (0<<TI954_IA_SEL) |
+					 (1<<TI954_IA_AUTO_INC));
+	if(unlikely(err))
+		goto write_pgen_err;
+
+	err = ds90ub954_write(priv, TI954_REG_IND_ACC_ADDR,
+			      TI954_REG_IA_PGEN_CTL);
+	if(unlikely(err))
+		goto write_pgen_err;
+	err = ds90ub954_write(priv, TI954_REG_IND_ACC_DATA,
+			      (0<<TI954_PGEB_ENABLE));
+	if(unlikely(err))
+		goto write_pgen_err;
+	for(reg = TI954_REG_IA_PGEB_CFG; reg < TI954_PGEN_NUM_REGS; reg++) {
+		err = ds90ub954_write(priv, TI954_REG_IND_ACC_DATA,
+				      t->regs[reg]);
+		if(unlikely(err))
+			goto write_pgen_err;
+	}
+
+	err = ds90ub954_write(priv, TI954_REG_IND_ACC_ADDR,
+			      TI954_REG_IA_PGEN_CTL);
+	if(unlikely(err))
+		goto write_pgen_err;
+	err = ds90ub954_write(priv, TI954_REG_IND_ACC_DATA,
+			      t->regs[TI954_REG_IA_PGEN_CTL]);
+
+write_pgen_err:
+	mutex_unlock(&priv->reg_lock);
+	if(unlikely(err))
+		dev_err(dev, "%s: writing pattern generator failed\n", __func__);
+	return err;
+}
+
+static int ds90ub954_init_testpattern(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub954_pgen_timing t;
+	struct ds90ub954_pgen cfg;
+	int err = 0;
+
+	mutex_lock(&priv->reg_lock);
+	cfg = priv->pgen;
+	mutex_unlock(&priv->reg_lock);
+
+	err = ds90ub954_pgen_calc(&cfg, ds90ub954_csi_kbps(priv), &t);
+	if(unlikely(err)) {
+		dev_err(dev, "%s: invalid pattern generator config (%d)\n",
+			__func__, err);
+		goto init_err;
+	}
+
+	err = ds90ub954_write_pgen(priv, &t);
+	if(unlikely(err)) {
+		dev_warn(dev, "%s: enable test pattern failed\n", __func__);
+		goto init_err;
+	}
+	dev_dbg(dev, "%s: enable test pattern successful, %dx%d dt 0x%02x %u.%03u fps %llu kbit/s\n",
+		__func__, cfg.width, cfg.height, cfg.dt,
+		t.fps_milli / 1000, t.fps_milli % 1000, t.kbps);
+init_err:
+	return err;
+}
+
+#ifdef DEBUG
+static int ds90ub954_debug_prints(struct ds90ub954_priv *priv)
+{
+	int i, val, ia_config = 0, err = 0;
+	/* print CSI timing of tx port 0 */
+	dev_info(dev, "%s: CSI timing\n", __func__);
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TCK_PREP, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: TCK_PREP: 0x%02x\n", __func__, val);
+
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TCK_ZERO, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: TCK_ZERO: 0x%02x\n", __func__, val);
+
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TCK_TRAIL, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: TCK_TRAIL: 0x%02x\n", __func__, val);
+
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TCK_POST, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: TCK_POST: 0x%02x\n", __func__, val);
+
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_THS_PREP, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: THS_PREP: 0x%02x\n", __func__, val);
+
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_THS_ZERO, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: THS_ZERO: 0x%02x\n", __func__, val);
+
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_THS_TRAIL, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: THS_TRAIL: 0x%02x\n", __func__, val);
+
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_THS_EXIT, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: THS_EXIT: 0x%02x\n", __func__, val);
+
+	err = ds90ub954_read_ia_reg(priv, TI954_REG_IA_CSI0_TPLX, &val,
+					ia_config);
+	if(unlikely(err))
+		return err;
+	dev_info(dev, "%s: CSI0_TPLX: 0x%02x\n", __func__, val);
+
+	/* measure refclk */
+	for(i = 0; i < 5; i++) {
+		err = ds90ub954_read(priv, TI954_REG_REFCLK_FREQ, &val);
+		if(err)
+			return err;
+		dev_info(dev, "%s: REFCLK_FREQ measurement %d, %d\n", __func__,
+			 i, val);
+	}
+	return err;
+};
+#endif
+
+static int ds90ub954_init_i2c_timing(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub95x_i2c_timing t;
+	int val, err;
+
+	err = ds90ub95x_calc_i2c_timing(priv->i2c_scl_freq, &t);
+	if(err) {
+		dev_err(dev, "%s: invalid i2c scl frequency %i\n", __func__,
+			priv->i2c_scl_freq);
+		return err;
+	}
+
+	err = ds90ub954_write(priv, TI954_REG_SCL_HIGH_TIME,
+			      (t.scl_high<<TI954_SCL_HIGH_TIME));
+	if(unlikely(err))
+		return err;
+
+	err = ds90ub954_write(priv, TI954_REG_SCL_LOW_TIME,
+			      (t.scl_low<<TI954_SCL_LOW_TIME));
+	if(unlikely(err))
+		return err;
+
+	err = ds90ub954_read(priv, TI954_REG_I2C_CTL2, &val);
+	if(unlikely(err))
+		return err;
+
+	val &= ~(0x3<<TI954_SDA_OUTPUT_SETUP);
+	val |= (t.sda_setup<<TI954_SDA_OUTPUT_SETUP);
+	err = ds90ub954_write(priv, TI954_REG_I2C_CTL2, val);
+	if(unlikely(err))
+		return err;
+
+	dev_dbg(dev, "%s: i2c scl %i Hz, high 0x%02x, low 0x%02x\n", __func__,
+		priv->i2c_scl_freq, t.scl_high, t.scl_low);
+	return 0;
+}
+
+/*
+ * Early presence check after enabling a receiver: a port without cable or
+ * camera neither locks nor measures a forward channel frequency. Returns 1 if
+ * a serializer is there, 0 if not.
+ */
+static int ds90ub954_port_present(struct ds90ub954_priv *priv, int rx_port)
+{
+	int i, val, freq, err;
+
+	for(i = 0; i <= PRESENCE_TIMEOUT_MS; i += PRESENCE_POLL_MS) {
+		err = ds90ub954_read_rx_port(priv, rx_port,
+					     TI954_REG_RX_PORT_STS1, &val);
+		if(unlikely(err))
+			return err;
+		if(val & (1<<TI954_LOCK_STS))
+			return 1;
+
+		err = ds90ub954_read_rx_port(priv, rx_port,
+					     TI954_REG_RX_FREQ_HIGH, &freq);
+		if(unlikely(err))
+			return err;
+		err = ds90ub954_read_rx_port(priv, rx_port,
+					     TI954_REG_RX_FERQ_LOQ, &val);
+		if(unlikely(err))
+			return err;
+		if(freq || val)
+			return 1;
+
+		ds90ub954_msleep(priv, PRESENCE_POLL_MS);
+	}
+	return 0;
+}
+
+/* back channel config of the deserializer rx port */
+static int ds90ub954_bcc_config(struct ds90ub954_priv *priv,
+				struct ds90ub953_priv *ser)
+{
+	return (priv->bc_freq_select<<TI954_BC_FREQ_SELECT)|
+	       (1<<TI954_BC_CRC_GENERAOTR_ENABLE)|
+	       (1<<TI954_BC_ALWAYS_ON)|
+	       (ser->i2c_pt<<TI954_I2C_PASS_THROUGH_ALL)|
+	       (1<<TI954_I2C_PASS_THROUGH);
+}
+
+/* BCC watchdog register value, same layout on 954 and 953 (2 ms units) */
+static int ds90ub954_bcc_wd_ctl(int wd_ms)
+{
+	if(!wd_ms)
+		return (1<<TI954_BCC_WATCHDOG_TIMER_DISABLE);
+	return clamp(wd_ms / 2, 1, 127)<<TI954_BCC_WATCHDOG_TIMER;
+}
+
+/* parity error threshold and its interrupt, RX_PAR_ERR restarts from zero */
+static int ds90ub954_init_par_err(struct ds90ub954_priv *priv,
+				  struct ds90ub953_priv *ser)
+{
+	int rx_port = ser->rx_channel;
+	int thold = ser->par_err_thold;
+	int val, err;
+
+	if(thold) {
+		/* the threshold counts the errors of the parity checker */
+		err = ds90ub954_update_bits(priv, TI954_REG_GENERAL_CFG,
+					    (1<<TI954_RX_PARITY_CHECKER_ENABLE),
+					    (1<<TI954_RX_PARITY_CHECKER_ENABLE));
+		if(unlikely(err))
+			return err;
+		err = ds90ub954_write_rx_port(priv, rx_port,
+					      TI954_REG_PAR_ERR_THOLD_HI,
+					      (thold>>8) & 0xff);
+		if(unlikely(err))
+			return err;
+		err = ds90ub954_write_rx_port(priv, rx_port,
+					      TI954_REG_PAR_ERR_THOLD_LO,
+					      thold & 0xff);
+		if(unlikely(err))
+			return err;
+	}
+
+	/* reg_lock orders the read with the snapshot and the alarm */
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_select_rx_port_locked(priv, rx_port);
+	if(!err)
+		err = ds90ub954_read(priv, TI954_REG_RX_PAR_ERR_HI, &val);
+	if(!err)
+		err = ds90ub954_read(priv, TI954_REG_RX_PAR_ERR_LO, &val);
+	if(!err)
+		priv->counters[rx_port].par_read = ktime_get();
+	mutex_unlock(&priv->reg_lock);
+	if(unlikely(err))
+		return err;
+
+	return ds90ub954_write_rx_port(priv, rx_port, TI954_REG_PORT_ICR_LO,
+				       thold ? (1<<TI954_IE_FPD3_PAR_ERR) : 0);
+}
+
+/* rx port specific setup for a serializer, also used when it is hot-plugged */
+static int ds90ub954_init_rx_port(struct ds90ub954_priv *priv,
+				  struct ds90ub953_priv *ds90ub953)
+{
+	struct device *dev = &priv->client->dev;
+	int rx_port = ds90ub953->rx_channel;
+	int i, val;
+	int err = 0;
+
+	dev_dbg(dev, "%s: start init of serializer rx_port %i\n",
+		__func__, rx_port);
+
+	/* Get TI954_REG_RX_PORT_CTL and enable receiver rx_port */
+	err = ds90ub954_update_bits(priv, TI954_REG_RX_PORT_CTL,
+				    (1<<(TI954_PORT0_EN+rx_port)),
+				    (1<<(TI954_PORT0_EN+rx_port)));
+	if(unlikely(err))
+		return err;
+	ds90ub954_port_set_state(priv, rx_port, PORT_TRAINING);
+
+	err = ds90ub954_port_present(priv, rx_port);
+	if(err <= 0)
+		return err ? err : -ENODEV;
+
+	/* wait for receiver to calibrate link */
+	ds90ub954_msleep(priv, 400);
+
+	/* enable csi forwarding */
+	err = ds90ub954_update_bits(priv, TI954_REG_FWD_CTL1,
+				    (1<<(TI954_FWD_PORT0_DIS+rx_port)), 0);
+	if(unlikely(err))
+		return err;
+
+	ds90ub954_msleep(priv, 500);
+
+	/* config back channel RX port [specific register] */
+	err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_BCC_CONFIG,
+				      ds90ub954_bcc_config(priv, ds90ub953));
+	if(unlikely(err))
+		return err;
+
+	 /* wait for back channel */
+	for(i = 0; i < 50; i++) {
+		ds90ub954_msleep(priv, 10);
+		err = ds90ub954_read(priv, TI954_REG_DEVICE_STS, &val);
+		if(unlikely(err))
+			return err;
+		dev_dbg(dev, "%s: DEVICE STS: 0x%02x, id=%d x 10ms\n",
+			__func__, val, i);
+		if((val & 0xff) == 0xdf) {
+			i = 0;
+			ds90ub954_port_set_state(priv, rx_port,
+						 PORT_LOCKED);
+			dev_dbg(dev, "%s: backchannel is ready\n",
+				__func__);
+			break;
+		}
+	}
+	if(i) {
+		dev_err(dev, "%s: Backchannel setup failed!\n", __func__);
+		return -EIO;
+	}
+#ifdef DEBUG
+	/* check PORT_STS1 */
+	for(i = 0; i < 2; i++) {
+		err = ds90ub954_read_rx_port(priv, rx_port,
+						TI954_REG_RX_PORT_STS1,
+						&val);
+		if(unlikely(err))
+			return err;
+		dev_dbg(dev, "%s: RX_PORT_STS1 read %d, 0x%02x\n",
+			__func__, i, val);
+	}
+
+	/* check PORT_STS2 */
+	for(i = 0; i < 2; i++) {
+		err = ds90ub954_read_rx_port(priv, rx_port,
+						TI954_REG_RX_PORT_STS2,
+						&val);
+		if(unlikely(err))
+			return err;
+		dev_dbg(dev, "%s: RX_PORT_STS2 read %d, 0x%02x\n",
+			__func__, i, val);
+	}
+#endif
+	/* setup i2c forwarding */
+	err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_SER_ALIAS_ID,
+			(ds90ub953->i2c_address<<TI954_SER_ALIAS_ID));
+	if(unlikely(err))
+		return err;
+	ds90ub954_port_set_state(priv, rx_port, PORT_BC_READY);
+
+	/* Serializer GPIO control */
+	err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_BC_GPIO_CTL0,
+			(ds90ub953->gpio_oc[0]<<TI954_BC_GPIO0_SEL) |
+			(ds90ub953->gpio_oc[1]<<TI954_BC_GPIO1_SEL));
+	if(err)
+		dev_warn(dev, "%s: could not set TI954_REG_BC_GPIO_CTL0\n",
+			 __func__);
+	else
+		dev_dbg(dev, "%s: Successfully set TI954_REG_BC_GPIO_CTL0\n",
+			__func__);
+
+	err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_BC_GPIO_CTL1,
+			(ds90ub953->gpio_oc[2]<<TI954_BC_GPIO2_SEL) |
+			(ds90ub953->gpio_oc[3]<<TI954_BC_GPIO3_SEL));
+	if(err)
+		dev_warn(dev, "%s: could not set TI954_REG_BC_GPIO_CTL1\n",
+			 __func__);
+	else
+		dev_dbg(dev, "%s: Successfully set TI954_REG_BC_GPIO_CTL1\n",
+			__func__);
+
+	/* set i2c slave ids and aliases, device tree pairs are pinned,
+	 * remaining slots are filled on demand from the alias pool */
+	mutex_lock(&priv->alias_lock);
+	memset(ds90ub953->alias, 0, sizeof(ds90ub953->alias));
+	for(i=0; (i < ds90ub953->i2c_alias_num) && (i < NUM_ALIAS); i++) {
+		val = ds90ub953->i2c_slave[i];
+		if(val == 0) {
+			continue;
+		}
+		err = ds90ub954_write_rx_port(priv, rx_port,
+					      TI954_REG_SLAVE_ID0+i,
+					      (val<<TI954_ALIAS_ID0));
+		if(unlikely(err)) {
+			mutex_unlock(&priv->alias_lock);
+			return err;
+		}
+		dev_dbg(dev, "%s: slave id %i: 0x%X\n", __func__, i, val);
+
+		val = ds90ub953->i2c_alias[i];
+		if(val == 0) {
+			continue;
+		}
+		err = ds90ub954_write_rx_port(priv, rx_port,
+					      TI954_REG_ALIAS_ID0+i,
+					      (val<<TI954_ALIAS_ID0));
+		if(unlikely(err)) {
+			mutex_unlock(&priv->alias_lock);
+			return err;
+		}
+		dev_dbg(dev, "%s: alias id %i: 0x%X\n", __func__, i, val);
+
+		ds90ub953->alias[i].slave = ds90ub953->i2c_slave[i];
+		ds90ub953->alias[i].alias = val;
+		ds90ub953->alias[i].pinned = ALIAS_PIN_DT;
+	}
+	mutex_unlock(&priv->alias_lock);
+	ds90ub954_port_set_state(priv, rx_port, PORT_ALIASED);
+
+	/* set virtual channel id mapping */
+	err = ds90ub954_write_rx_port(priv, rx_port,
+				      TI954_REG_CSI_VC_MAP,
+				      ds90ub953->vc_map);
+	if(unlikely(err))
+		return err;
+	else {
+		val = ds90ub953->vc_map & 0b11;
+		dev_dbg(dev, "%s: VC-ID 0 mapped to %i\n", __func__, val);
+		val = ((ds90ub953->vc_map & 0b1100)>>2);
+		dev_dbg(dev, "%s: VC-ID 1 mapped to %i\n", __func__, val);
+		val = ((ds90ub953->vc_map & 0b110000)>>4);
+		dev_dbg(dev, "%s: VC-ID 2 mapped to %i\n", __func__, val);
+		val = ((ds90ub953->vc_map & 0b11000000)>>6);
+		dev_dbg(dev, "%s: VC-ID 3 mapped to %i\n", __func__, val);
+	}
+
+	/* errors of the bring-up are cleared, later ones reported on INTB */
+	err = ds90ub954_read_rx_port(priv, rx_port, TI954_REG_PORT_ISR_HI, &val);
+	if(unlikely(err))
+		return err;
+	err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_PRT_ICR_HI,
+				      (1<<TI954_IE_BC_CRC_ERR)|
+				      (1<<TI954_IE_BCC_SEQ_ERR));
+	if(unlikely(err))
+		return err;
+	err = ds90ub954_init_par_err(priv, ds90ub953);
+	if(unlikely(err))
+		return err;
+	err = ds90ub954_update_bits(priv, TI954_REG_INTERRUPT_CTL,
+				    (1<<TI954_INT_EN)|(1<<(TI954_IE_RX0+rx_port)),
+				    (1<<TI954_INT_EN)|(1<<(TI954_IE_RX0+rx_port)));
+	if(unlikely(err))
+		return err;
+
+	/* all rx_port specific registers set for rx_port X */
+	dev_dbg(dev, "%s: init of deserializer rx_port %i successful\n",
+		__func__, rx_port);
+	return 0;
+}
+
+static int ds90ub954_init(struct ds90ub954_priv *priv, int rx_port)
+{
+	struct device *dev = &priv->client->dev;
+	unsigned char dev_id, rev;
+	int i, val;
+	int err = 0;
+	char id_code[TI954_RX_ID_LENGTH + 1];
+	int ser_nr = 0;
+	struct ds90ub953_priv *ds90ub953;
+
+	/*----------------------------------------------------------------------
+	 *  init deserializer
+	 *--------------------------------------------------------------------*/
+	dev_dbg(dev, "%s starting\n", __func__);
+
+	/* Read device id of deserializer */
+	err = ds90ub954_read(priv, TI954_REG_I2C_DEV_ID, &val);
+	if(unlikely(err))
+		goto init_err;
+
+	dev_id = (unsigned char)val;
+
+	/* Read revision ID of deserializer */
+	err = ds90ub954_read(priv, TI954_REG_REVISION, &val);
+	if(unlikely(err))
+		goto init_err;
+
+	rev = (unsigned char)val;
+
+	/* Read FPD3_RX_ID3 registers */
+	memset(id_code, 0, sizeof(id_code));
+	for(i = 0; i < TI954_RX_ID_LENGTH; i++) {
+		err = ds90ub954_read(priv, TI954_REG_FPD3_RX_ID0 + i, &val);
+		if(err) {
+			goto init_err;
+		}
+		id_code[i] = (char)val;
+	}
+	dev_dbg(dev, "%s: device ID: 0x%x, code:%s, revision: 0x%x\n",
+		__func__, dev_id, id_code, rev);
+	priv->dev_id = dev_id;
+	priv->revision = rev;
+	memcpy(priv->id_code, id_code, sizeof(priv->id_code));
+
+	/* disable BuiltIn Self Test */
+	err = ds90ub954_write(priv, TI954_REG_BIST_CONTROL, 0);
+	if(unlikely(err))
+		goto init_err;
+
+	/* back channel watchdog, keep the reset value if not configured */
+	if(priv->bcc.wd_ms >= 0) {
+		err = ds90ub954_write(priv, TI954_REG_BCC_WD_CTL,
+				      ds90ub954_bcc_wd_ctl(priv->bcc.wd_ms));
+		if(unlikely(err))
+			goto init_err;
+	}
+
+	/* REFCLK defines the forward channel rate in synchronous mode */
+	if(!priv->refclk_freq) {
+		err = ds90ub954_read(priv, TI954_REG_REFCLK_FREQ, &val);
+		if(unlikely(err))
+			goto init_err;
+		if(!val)
+			val = TI954_REFCLK_DEFAULT_MHZ;
+		priv->refclk_freq = val * 1000000;
+		dev_dbg(dev, "%s: REFCLK %i MHz\n", __func__, val);
+	}
+
+	/* set i2c master timing, reset default is standard mode */
+	if(priv->i2c_scl_freq) {
+		err = ds90ub954_init_i2c_timing(priv);
+		if(unlikely(err))
+			goto init_err;
+	}
+
+	/* set CSI speed (REFCLK 25 MHz)
+	*  00 : 1.6 Gbps serial rate
+	*  01 : Reserved
+	*  10 : 800 Mbps serial rate
+	*  11 : 400 Mbps serial rate */
+	switch(priv->csi_lane_speed) {
+	case 400:
+		val=0x3;
+		break;
+	case 800:
+		val=0x2;
+		break;
+	default:
+		val=0x0;
+		break;
+	}
+
+	err = ds90ub954_write(priv, TI954_REG_CSI_PLL_CTL,
+				(val<<TI954_CSI_TX_SPEED));
+	if(unlikely(err))
+		goto init_err;
+#ifdef DEBUG
+	err = ds90ub954_debug_prints(priv);
+	if(unlikely(err))
+		goto init_err;
+#endif
+	/* set number of csi lanes */
+	switch(priv->csi_lane_count) {
+	case 1:
+		val = TI954_CSI_1_LANE;
+		break;
+	case 2:
+		val = TI954_CSI_2_LANE;
+		break;
+	case 3:
+		val = TI954_CSI_3_LANE;
+		break;
+	default:
+		val = TI954_CSI_4_LANE;
+		break;
+	}
+
+	err = ds90ub954_write(priv, TI954_REG_CSI_CTL,
+				(1<<TI954_CSI_ENABLE)|
+				(priv->conts_clk<<TI954_CSI_CONTS_CLOCK)|
+				(val<<TI954_CSI_LANE_COUNT)|
+				(1<<TI954_CSI_CAL_EN));
+	if(unlikely(err))
+		goto init_err;
+
+	ds90ub954_msleep(priv, 500);
+
+	/* check if test pattern should be turned on */
+	if(priv->test_pattern == 1) {
+		dev_dbg(dev, "%s: deserializer init testpattern\n", __func__);
+		err = ds90ub954_init_testpattern(priv);
+		if(unlikely(err)) {
+			dev_warn(dev,
+				"%s: deserializer init testpattern failed\n",
+				__func__);
+		}
+	}
+
+	/* Setting PASS and LOCK to "all enabled receiver ports */
+	val = priv->chip->rx_port_ctl;
+	err = ds90ub954_write(priv, TI954_REG_RX_PORT_CTL, val);
+	if(unlikely(err))
+		goto init_err;
+
+	/* for loop goes through each serializer */
+	for( ; ser_nr < priv->num_ser; ser_nr++) {
+		ds90ub953 = priv->ser[ser_nr];
+		if(!ds90ub953 || ds90ub953->initialized == 0) {
+			continue;
+		}
+		rx_port = ds90ub953->rx_channel;
+
+		err = ds90ub954_init_rx_port(priv, ds90ub953);
+		if(err == -ENODEV && priv->hotplug.poll_ms) {
+			/* receiver stays on, the hot-plug work retries */
+			dev_info(dev, "%s: rx_port %i: no camera, bring-up deferred\n",
+				 __func__, rx_port);
+			ds90ub953->initialized = 0;
+			continue;
+		}
+		if(unlikely(err))
+			goto ser_init_failed;
+		continue;
+ser_init_failed:
+		dev_err(dev, "%s: init deserializer rx_port %i failed\n",
+			__func__, rx_port);
+		dev_err(dev, "%s: deserializer rx_port %i is deactivated\n",
+			__func__, rx_port);
+
+		ds90ub953->initialized = 0;
+		ds90ub954_port_set_state(priv, rx_port, PORT_FAULT);
+
+		/* DISABLE RX PORT, kept on to detect a hot-plugged camera */
+		if(!priv->hotplug.poll_ms) {
+			err = ds90ub954_update_bits(priv, TI954_REG_RX_PORT_CTL,
+						    (1<<(TI954_PORT0_EN+rx_port)),
+						    0);
+			if(err)
+				continue;
+		}
+		/* DISABLE CSI FORWARDING */
+		err = ds90ub954_update_bits(priv, TI954_REG_FWD_CTL1,
+					    (1<<(TI954_FWD_PORT0_DIS+rx_port)),
+					    (1<<(TI954_FWD_PORT0_DIS+rx_port)));
+		if(err)
+			continue;
+		continue;
+	}
+
+	/* setup gpio forwarding, default all input */
+	err = ds90ub954_write(priv, TI954_REG_GPIO_INPUT_CTL,
+			      (1<<TI954_GPIO6_INPUT_EN)|
+			      (1<<TI954_GPIO5_INPUT_EN)|
+			      (1<<TI954_GPIO4_INPUT_EN)|
+			      (1<<TI954_GPIO3_INPUT_EN)|
+			      (1<<TI954_GPIO2_INPUT_EN)|
+			      (1<<TI954_GPIO1_INPUT_EN)|
+			      (1<<TI954_GPIO0_INPUT_EN));
+	if(err)
+		goto init_err;
+
+	err = ds90ub954_write(priv, TI954_REG_GPIO0_PIN_CTL, 0);
+	if(err)
+		goto init_err;
+
+	err = ds90ub954_write(priv, TI954_REG_GPIO1_PIN_CTL, 0);
+	if(err)
+		goto init_err;
+
+	err = ds90ub954_write(priv, TI954_REG_GPIO2_PIN_CTL, 0);
+	if(err)
+		goto init_err;
+
+	err = ds90ub954_write(priv, TI954_REG_GPIO3_PIN_CTL, 0);
+	if(err)
+		goto init_err;
+
+	err = ds90ub954_write(priv, TI954_REG_GPIO4_PIN_CTL, 0);
+	if(err)
+		goto init_err;
+
+	err = ds90ub954_write(priv, TI954_REG_GPIO5_PIN_CTL, 0);
+	if(err)
+		goto init_err;
+
+	err = ds90ub954_write(priv, TI954_REG_GPIO6_PIN_CTL, 0);
+	if(err)
+		goto init_err;
+
+init_err:
+	return err;
+}
+
+static int ds90ub954_init_gpio(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	int err = 0;
+
+	priv->pass_gpio = devm_gpiod_get_optional(dev, "pass", GPIOD_IN);
+	if(IS_ERR(priv->pass_gpio)) {
+		err = PTR_ERR(priv->pass_gpio);
+		dev_err(dev, "unable to request pass-gpio (%d)\n", err);
+		goto done;
+	}
+	if(!priv->pass_gpio)
+		dev_dbg(dev, "pass-gpio not found, ignoring\n");
+
+	priv->lock_gpio = devm_gpiod_get_optional(dev, "lock", GPIOD_IN);
+	if(IS_ERR(priv->lock_gpio)) {
+		err = PTR_ERR(priv->lock_gpio);
+		dev_err(dev, "unable to request lock-gpio (%d)\n", err);
+		goto done;
+	}
+	if(!priv->lock_gpio)
+		dev_dbg(dev, "lock-gpio not found, ignoring\n");
+
+	/* keep the deserializer powered down until ds90ub954_pwr_enable */
+	priv->pdb_gpio = devm_gpiod_get_optional(dev, "pdb", GPIOD_OUT_LOW);
+	if(IS_ERR(priv->pdb_gpio)) {
+		err = PTR_ERR(priv->pdb_gpio);
+		dev_err(dev, "unable to request pdb-gpio (%d)\n", err);
+		goto done;
+	}
+	if(!priv->pdb_gpio)
+		dev_dbg(dev, "pdb-gpio not found, ignoring\n");
+
+	/* INTB is open drain and active low, polled by hot-plug if missing */
+	priv->intb_gpio = devm_gpiod_get_optional(dev, "intb", GPIOD_IN);
+	if(IS_ERR(priv->intb_gpio)) {
+		err = PTR_ERR(priv->intb_gpio);
+		dev_err(dev, "unable to request intb-gpio (%d)\n", err);
+		goto done;
+	}
+	if(!priv->intb_gpio)
+		dev_dbg(dev, "intb-gpio not found, ignoring\n");
+
+done:
+	return err;
+}
+
+static void ds90ub954_pwr_enable(const struct ds90ub954_priv *priv)
+{
+	gpiod_set_value_cansleep(priv->pdb_gpio, 1);
+}
+
+static void ds90ub954_pwr_disable(const struct ds90ub954_priv *priv)
+{
+	gpiod_set_value_cansleep(priv->pdb_gpio, 0);
+}
+
+/*------------------------------------------------------------------------------
+ * LINK STATE
+ *----------------------------------------------------------------------------*/
+
+static const char * const ds90ub954_link_state_names[] = {
+	[LINK_STATE_UNKNOWN] = "unknown",
+	[LINK_STATE_DOWN] = "down",
+	[LINK_STATE_LOCKED] = "locked",
+	[LINK_STATE_PASS] = "pass",
+};
+
+/* sample LOCK/PASS and update the link state, called with link.lock held */
+static void ds90ub954_link_update_locked(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub954_link *link = &priv->link;
+	enum ds90ub954_link_state old = link->state;
+	enum ds90ub954_link_state state;
+	ktime_t now = ktime_get();
+	int lock, pass, i;
+
+	lock = gpiod_get_value_cansleep(priv->lock_gpio);
+	pass = priv->pass_gpio ? gpiod_get_value_cansleep(priv->pass_gpio) : 0;
+	if(lock < 0 || pass < 0)
+		return;
+
+	if(!lock)
+		state = LINK_STATE_DOWN;
+	else if(!pass)
+		state = LINK_STATE_LOCKED;
+	else
+		state = LINK_STATE_PASS;
+
+	if(state == old)
+		return;
+
+	if(state == LINK_STATE_DOWN) {
+		link->last_loss = now;
+		/* LOCK is the or of all ports, every port past training lost it */
+		for(i = 0; i < priv->chip->num_rx_ports; i++) {
+			if(ds90ub954_port_get_state(priv, i) >= PORT_LOCKED &&
+			   ds90ub954_port_get_state(priv, i) < PORT_FAULT)
+				ds90ub954_port_set_state(priv, i, PORT_FAULT);
+		}
+		if(old != LINK_STATE_UNKNOWN) {
+			link->loss_events++;
+			dev_warn(dev, "%s: link lost after %lld ms\n", __func__,
+				 ktime_ms_delta(now, link->last_lock));
+		}
+	} else if(old == LINK_STATE_DOWN || old == LINK_STATE_UNKNOWN) {
+		link->last_lock = now;
+		if(old == LINK_STATE_DOWN) {
+			link->lock_events++;
+			dev_info(dev, "%s: link locked after %lld ms\n",
+				 __func__, ktime_ms_delta(now, link->last_loss));
+		}
+	}
+	if(old == LINK_STATE_PASS && state == LINK_STATE_LOCKED)
+		link->pass_loss_events++;
+
+	link->state = state;
+	link->changed = now;
+	sysfs_notify(&dev->kobj, NULL, "link_status");
+}
+
+static irqreturn_t ds90ub954_link_irq(int irq, void *dev_id)
+{
+	struct ds90ub954_priv *priv = dev_id;
+
+	mutex_lock(&priv->link.lock);
+	ds90ub954_link_update_locked(priv);
+	mutex_unlock(&priv->link.lock);
+	return IRQ_HANDLED;
+}
+
+static int ds90ub954_link_request_irq(struct ds90ub954_priv *priv,
+				      struct gpio_desc *gpio, const char *name)
+{
+	struct device *dev = &priv->client->dev;
+	int irq, err;
+
+	if(!gpio)
+		return -ENOENT;
+
+	irq = gpiod_to_irq(gpio);
+	if(irq < 0) {
+		dev_dbg(dev, "%s: %s-gpio has no irq, no link events\n",
+			__func__, name);
+		return irq;
+	}
+
+	err = devm_request_threaded_irq(dev, irq, NULL, ds90ub954_link_irq,
+					IRQF_TRIGGER_RISING |
+					IRQF_TRIGGER_FALLING | IRQF_ONESHOT,
+					name, priv);
+	if(unlikely(err)) {
+		dev_err(dev, "%s: unable to request %s irq (%d)\n", __func__,
+			name, err);
+		return err;
+	}
+	return irq;
+}
+
+/* sample the initial link state and request edge interrupts on LOCK/PASS */
+static void ds90ub954_link_init(struct ds90ub954_priv *priv)
+{
+	struct ds90ub954_link *link = &priv->link;
+
+	link->lock_irq = -ENOENT;
+	link->pass_irq = -ENOENT;
+	if(!priv->lock_gpio)
+		return;
+
+	mutex_lock(&link->lock);
+	ds90ub954_link_update_locked(priv);
+	mutex_unlock(&link->lock);
+
+	link->lock_irq = ds90ub954_link_request_irq(priv, priv->lock_gpio,
+						    "ds90ub954_lock");
+	link->pass_irq = ds90ub954_link_request_irq(priv, priv->pass_gpio,
+						    "ds90ub954_pass");
+}
+
+static ssize_t link_status_show(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	struct ds90ub954_priv *priv = dev_get_drvdata(dev);
+	struct ds90ub954_link *link = &priv->link;
+	ktime_t now = ktime_get();
+	int len;
+
+	mutex_lock(&link->lock);
+	len = scnprintf(buf, PAGE_SIZE,
+			"state: %s\nirq: %s\nin state: %lld ms\n"
+			"lock events: %u\nloss events: %u\n"
+			"pass loss events: %u\n",
+			ds90ub954_link_state_names[link->state],
+			link->lock_irq >= 0 ? "yes" : "no",
+			link->state == LINK_STATE_UNKNOWN ? 0 :
+			ktime_ms_delta(now, link->changed),
+			link->lock_events, link->loss_events,
+			link->pass_loss_events);
+	mutex_unlock(&link->lock);
+	return len;
+}
+
+static DEVICE_ATTR_RO(link_status);
+
+static int ds90ub954_parse_dt(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct device_node *np = dev->of_node;
+	const struct of_device_id *match;
+	u32 pool[NUM_ALIAS_POOL];
+	int err = 0;
+	int val = 0;
+	int i;
+
+	if(!np)
+		return -ENODEV;
+
+	dev_dbg(dev, "%s: deserializer:\n", __func__);
+	match = of_match_device(ds90ub954_of_match, dev);
+	if(!match) {
+		dev_err(dev, "Failed to find matching dt id\n");
+		return -ENODEV;
+	}
+	priv->chip = match->data;
+	dev_dbg(dev, "%s: - %s with %i rx ports\n", __func__, priv->chip->name,
+		priv->chip->num_rx_ports);
+
+	err = of_property_read_u32(np, "csi-lane-count", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - csi-lane-count property not found\n", __func__);
+
+		/* default value: 4 */
+		priv->csi_lane_count = 4;
+		dev_dbg(dev, "%s: - csi-lane-count set to default val: 4\n", __func__);
+	} else {
+		/* set csi-lane-count*/
+		priv->csi_lane_count = val;
+		dev_dbg(dev, "%s: - csi-lane-count %i\n", __func__, val);
+	}
+
+	err = of_property_read_u32(np, "csi-lane-speed", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - csi-lane-speed property not found\n", __func__);
+
+		/* default value: 4 */
+		priv->csi_lane_speed = 1600;
+		dev_dbg(dev, "%s: - csi-lane-speed set to default val: 4\n", __func__);
+	} else {
+		/* set csi-lane-speed*/
+		priv->csi_lane_speed = val;
+		dev_dbg(dev, "%s: - csi-lane-speed %i\n", __func__, val);
+	}
+
+	if(of_property_read_bool(np, "test-pattern")) {
+		dev_dbg(dev, "%s: - test-pattern enabled\n", __func__);
+		priv->test_pattern = 1;
+	} else {
+		/* default value: 0 */
+		priv->test_pattern = 0;
+		dev_dbg(dev, "%s: - test-pattern disabled\n", __func__);
+	}
+
+	if(of_property_read_bool(np, "continuous-clock")) {
+		dev_dbg(dev, "%s: - continuous clock enabled\n", __func__);
+		priv->conts_clk = 1;
+	} else {
+		/* default value: 0 */
+		priv->conts_clk = 0;
+		dev_dbg(dev, "%s: - discontinuous clock used\n", __func__);
+	}
+
+	/* back channel rate in kbps */
+	err = of_property_read_u32(np, "back-channel-rate", &val);
+	if(err) {
+		priv->bc_freq_select = TI954_BC_FREQ_50M;
+		dev_dbg(dev, "%s: - back-channel-rate set to default val: 50000\n",
+			__func__);
+	} else {
+		switch(val) {
+		case 250:
+			priv->bc_freq_select = TI954_BC_FREQ_250;
+			break;
+		case 2500:
+			priv->bc_freq_select = TI954_BC_FREQ_2M5;
+			break;
+		case 10000:
+			priv->bc_freq_select = TI954_BC_FREQ_10M;
+			break;
+		case 25000:
+			priv->bc_freq_select = TI954_BC_FREQ_25M;
+			break;
+		case 50000:
+			priv->bc_freq_select = TI954_BC_FREQ_50M;
+			break;
+		default:
+			priv->bc_freq_select = TI954_BC_FREQ_50M;
+			dev_warn(dev, "%s: - %i no valid value for back-channel-rate, 50000 used\n",
+				 __func__, val);
+			break;
+		}
+		dev_dbg(dev, "%s: - back-channel-rate %i\n", __func__, val);
+	}
+
+	err = of_property_read_u32(np, "i2c-scl-frequency", &val);
+	if(err) {
+		/* default value: 0, keep reset timing */
+		priv->i2c_scl_freq = 0;
+		dev_dbg(dev, "%s: - i2c-scl-frequency not found, reset default used\n",
+			__func__);
+	} else {
+		priv->i2c_scl_freq = val;
+		dev_dbg(dev, "%s: - i2c-scl-frequency %i\n", __func__, val);
+	}
+
+	err = of_property_read_u32(np, "refclk-frequency", &val);
+	if(err) {
+		/* default value: 0, measured by the deserializer */
+		priv->refclk_freq = 0;
+		dev_dbg(dev, "%s: - refclk-frequency not found, measured at init\n",
+			__func__);
+	} else {
+		priv->refclk_freq = val;
+		dev_dbg(dev, "%s: - refclk-frequency %i\n", __func__, val);
+	}
+
+	err = of_property_read_u32(np, "hotplug-poll-ms", &val);
+	if(err) {
+		priv->hotplug.poll_ms = HOTPLUG_POLL_DEFAULT_MS;
+		dev_dbg(dev, "%s: - hotplug-poll-ms set to default val: %i\n",
+			__func__, HOTPLUG_POLL_DEFAULT_MS);
+	} else {
+		priv->hotplug.poll_ms = val;
+		dev_dbg(dev, "%s: - hotplug-poll-ms %i\n", __func__, val);
+	}
+
+	err = of_property_read_u32(np, "bcc-watchdog-ms", &val);
+	if(err) {
+		priv->bcc.wd_ms = -1;
+		dev_dbg(dev, "%s: - bcc-watchdog-ms not found, reset value used\n",
+			__func__);
+	} else {
+		priv->bcc.wd_ms = min_t(u32, val, BCC_WD_MAX_MS);
+		dev_dbg(dev, "%s: - bcc-watchdog-ms %i\n", __func__,
+			priv->bcc.wd_ms);
+	}
+
+	err = of_property_read_u32(np, "i2c-retries", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - i2c-retries not found, default %i used\n",
+			__func__, RETRY_LOCAL_DEFAULT);
+	} else {
+		priv->retry.policy[TARGET_LOCAL].retries = min_t(u32, val,
+								 RETRY_MAX);
+		dev_dbg(dev, "%s: - i2c-retries %i\n", __func__,
+			priv->retry.policy[TARGET_LOCAL].retries);
+	}
+
+	err = of_property_read_u32(np, "remote-i2c-retries", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - remote-i2c-retries not found, default %i used\n",
+			__func__, RETRY_REMOTE_DEFAULT);
+	} else {
+		priv->retry.policy[TARGET_REMOTE].retries = min_t(u32, val,
+								  RETRY_MAX);
+		dev_dbg(dev, "%s: - remote-i2c-retries %i\n", __func__,
+			priv->retry.policy[TARGET_REMOTE].retries);
+	}
+
+	err = of_property_read_u32(np, "i2c-retry-backoff-us", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - i2c-retry-backoff-us not found, default %i used\n",
+			__func__, RETRY_BACKOFF_DEFAULT_US);
+	} else {
+		val = clamp_t(u32, val, 1, RETRY_BACKOFF_MAX_US);
+		priv->retry.policy[TARGET_LOCAL].backoff_us = val;
+		priv->retry.policy[TARGET_REMOTE].backoff_us = val;
+		dev_dbg(dev, "%s: - i2c-retry-backoff-us %i\n", __func__, val);
+	}
+
+	/* free host addresses for on-demand remote i2c aliases */
+	val = of_property_count_u32_elems(np, "i2c-alias-pool");
+	if(val <= 0) {
+		priv->alias_pool_num = 0;
+		dev_dbg(dev, "%s: - i2c-alias-pool not found, dynamic aliases disabled\n",
+			__func__);
+	} else {
+		if(val > NUM_ALIAS_POOL) {
+			dev_dbg(dev, "%s: - i2c-alias-pool limited to %i entries\n",
+				__func__, NUM_ALIAS_POOL);
+			val = NUM_ALIAS_POOL;
+		}
+		err = of_property_read_u32_array(np, "i2c-alias-pool", pool, val);
+		if(err) {
+			dev_err(dev, "%s: - reading i2c-alias-pool failed (%d)\n",
+				__func__, err);
+			return err;
+		}
+		for(i = 0; i < val; i++)
+			priv->alias_pool[i] = pool[i];
+		priv->alias_pool_num = val;
+		dev_dbg(dev, "%s: - i2c-alias-pool with %i addresses\n",
+			__func__, val);
+	}
+
+	return 0;
+
+}
+
+#ifdef ENABLE_SYSFS_TP
+static ssize_t test_pattern_show_des(struct device *dev,
+				     struct device_attribute *attr,
+				     char *buf)
+{
+	struct ds90ub954_priv *priv;
+	priv = dev_get_drvdata(dev);
+	return snprintf(buf, PAGE_SIZE,
+			"Test Pattern is set to: %i\n", priv->test_pattern);
+}
+
+static ssize_t test_pattern_set_des(struct device *dev,
+				    struct device_attribute *attr,
+				    const char *buf, size_t count)
+{
+	struct ds90ub954_priv *priv;
+	int testpat;
+
+	priv = dev_get_drvdata(dev);
+	sscanf(buf, "%d", &testpat);
+	if(testpat > 1 || testpat < 0) {
+		dev_info(dev,
+			 "Invalid value: %i for test pattern (0/1)\n", testpat);
+		return PAGE_SIZE;
+	}
+	if(testpat == 1) {
+		dev_info(dev, "enabling testpattern for deserializer\n");
+		priv->test_pattern = 1;
+		ds90ub954_init_testpattern(priv);
+	} else {
+		dev_info(dev, "disabling testpattern for deserializer\n");
+		priv->test_pattern = 0;
+		ds90ub954_disable_testpattern(priv);
+	}
+	return PAGE_SIZE;
+}
+static DEVICE_ATTR(test_pattern_des, 0664,test_pattern_show_des,
+		   test_pattern_set_des);
+#endif
+
+/*------------------------------------------------------------------------------
+ * DS90UB953 FUNCTIONS
+ *----------------------------------------------------------------------------*/
+
+static int ds90ub953_read(struct ds90ub953_priv *priv, unsigned int reg,
+			  unsigned int *val)
+{
+	ktime_t start;
+	u64 ns;
+	int err;
+
+	if(ds90ub954_cache_only(priv->parent))
+		return ds90ub953_regcache_read(priv, reg, val);
+
+	start = ktime_get();
+	err = ds90ub954_regmap_xfer(priv->parent, priv->regmap, TARGET_REMOTE, 0,
+				    reg, val);
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	ds90ub954_reg_hist_add(&priv->hist, reg, 0, err, ns);
+	trace_ds90ub953_read(&priv->client->dev, priv->rx_channel, reg,
+			     err ? 0 : *val, err, ns);
+	if(err) {
+		dev_err(&priv->client->dev,
+			"Cannot read subdev 0x%02x register 0x%02x (%d)!\n",
+			priv->client->addr, reg, err);
+	}
+	return err;
+}
+
+static int ds90ub953_write(struct ds90ub953_priv *priv, unsigned int reg,
+			   unsigned int val)
+{
+	ktime_t start;
+	u64 ns;
+	int err;
+
+	if(ds90ub954_cache_only(priv->parent)) {
+		ds90ub953_regcache_update(priv, reg, val);
+		return 0;
+	}
+
+	start = ktime_get();
+	err = ds90ub954_regmap_xfer(priv->parent, priv->regmap, TARGET_REMOTE, 1,
+				    reg, &val);
+	if(!err)
+		ds90ub953_regcache_update(priv, reg, val);
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	ds90ub954_reg_hist_add(&priv->hist, reg, 1, err, ns);
+	trace_ds90ub953_write(&priv->client->dev, priv->rx_channel, reg, val,
+			      err, ns);
+	if(err) {
+		dev_err(&priv->parent->client->dev,
+			"Cannot write subdev 0x%02x register 0x%02x (%d)!\n",
+			priv->client->addr, reg, err);
+	}
+	return err;
+}
+
+static int ds90ub953_disable_testpattern(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	int err = 0;
+	/* Indirect Pattern Gen Registers */
+	err = ds90ub953_write(priv, TI953_REG_IND_ACC_CTL,
+			      (TI953_IA_PGEN_BANK<<TI953_IA_SEL));
+	if(err)
+		goto init_err;
+	err = ds90ub953_write(priv, TI953_REG_IND_ACC_ADDR,
+			      TI953_REG_IA_PGEN_CTL);
+	if(err)
+		goto init_err;
+	err = ds90ub953_write(priv, TI953_REG_IND_ACC_DATA,
+			      (0<<TI953_PGEN_ENABLE));
+init_err:
+	if(err)
+		dev_warn(dev, "%s: disable test pattern failed\n", __func__);
+	return err;
+}
+
+/*
+ * Writes the indirect pattern generator registers of the serializer with auto
+ * increment, they have the layout of the deserializer pattern generator.
+ */
+static int ds90ub953_write_pgen(struct ds90ub953_priv *priv,
+				const struct ds90ub954_pgen_timing *t)
+{
+	int reg, err = 0;
+
+	err = ds90ub953_write(priv, TI953_REG_IND_ACC_CTL,
+			      (TI953_IA_PGEN_BANK<<TI953_IA_SEL) |
+			      (1<<TI953_IA_AUTO_INC));
+	if(unlikely(err))
+		return err;
+
+	err = ds90ub953_write(priv, TI953_REG_IND_ACC_ADDR,
+			      TI953_REG_IA_PGEN_CTL);
+	if(unlikely(err))
+		return err;
+	err = ds90ub953_write(priv, TI953_REG_IND_ACC_DATA,
+			      (0<<TI953_PGEN_ENABLE));
+	if(unlikely(err))
+		return err;
+	for(reg = TI953_REG_IA_PGEN_CFG; reg < TI954_PGEN_NUM_REGS; reg++) {
+		err = ds90ub953_write(priv, TI953_REG_IND_ACC_DATA,
+				      t->regs[reg]);
+		if(unlikely(err))
+			return err;
+	}
+
+	err = ds90ub953_write(priv, TI953_REG_IND_ACC_ADDR,
+			      TI953_REG_IA_PGEN_CTL);
+	if(unlikely(err))
+		return err;
+	err = ds90ub953_write(priv, TI953_REG_IND_ACC_DATA,
+			      t->regs[TI953_REG_IA_PGEN_CTL]);
+	if(unlikely(err))
+		return err;
+
+	/* leave auto increment off for single indirect accesses */
+	return ds90ub953_write(priv, TI953_REG_IND_ACC_CTL,
+			       (TI953_IA_PGEN_BANK<<TI953_IA_SEL));
+}
+
+/* called with the port state lock held */
+static int ds90ub953_init_testpattern(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub954_pgen_timing t;
+	int err = 0;
+
+	/* the pattern leaves the deserializer on its csi-2 port */
+	err = ds90ub954_pgen_calc(&priv->pgen,
+				  ds90ub954_csi_kbps(priv->parent), &t);
+	if(unlikely(err)) {
+		dev_err(dev, "%s: invalid pattern generator config (%d)\n",
+			__func__, err);
+		goto init_err;
+	}
+
+	err = ds90ub953_write_pgen(priv, &t);
+	if(unlikely(err)) {
+		dev_warn(dev, "%s: enable test pattern failed\n", __func__);
+		goto init_err;
+	}
+	dev_dbg(dev, "%s: enable test pattern successful, %dx%d dt 0x%02x %u.%03u fps %llu kbit/s\n",
+		__func__, priv->pgen.width, priv->pgen.height, priv->pgen.dt,
+		t.fps_milli / 1000, t.fps_milli % 1000, t.kbps);
+init_err:
+	return err;
+}
+
+/* read the clear-on-read status of the rx port of a serializer */
+static int ds90ub953_pgen_read_sts(struct ds90ub953_priv *priv,
+				   struct ds90ub953_pgen_result *res)
+{
+	struct ds90ub954_priv *des = priv->parent;
+	int port = priv->rx_channel;
+	int err, val;
+
+	err = ds90ub954_read_rx_port(des, port, TI954_REG_RX_PORT_STS2, &val);
+	if(unlikely(err))
+		return err;
+	res->port_sts2 = val & ((1<<TI954_LINE_CNT_CHG) |
+				(1<<TI954_LINE_LEN_CHG) |
+				(1<<TI954_LINE_LEN_UNSTABLE));
+
+	err = ds90ub954_read_rx_port(des, port, TI954_REG_CSI_RX_STS, &val);
+	if(unlikely(err))
+		return err;
+	res->csi_rx_sts = val & ((1<<TI954_ECC1_ERR) | (1<<TI954_ECC2_ERR) |
+				 (1<<TI954_CKSUM_ERR) | (1<<TI954_LENGTH_ERR));
+
+	err = ds90ub954_read_rx_port(des, port, TI954_REG_CSI_ERR_COUNTER,
+				     &val);
+	if(unlikely(err))
+		return err;
+	res->csi_errors = val;
+	return 0;
+}
+
+/* sleep without priv->lock, the serializer may be torn down meanwhile */
+static int ds90ub953_pgen_sleep(struct ds90ub953_priv *priv, int ms)
+{
+	mutex_unlock(&priv->lock);
+	ds90ub954_msleep(priv->parent, ms);
+	mutex_lock(&priv->lock);
+	return priv->initialized ? 0 : -ENODEV;
+}
+
+/*
+ * End-to-end check of a cable: the serializer sends its pattern for
+ * duration_ms, the deserializer has to receive every frame with the
+ * configured number of lines and line length and without csi-2 errors.
+ * Called with the port state lock and priv->lock held. priv->lock is dropped
+ * while the pattern runs, so the other accesses to the serializer are not
+ * blocked for up to a minute. The pattern is left in the state of
+ * test_pattern.
+ */
+static int ds90ub953_pgen_test(struct ds90ub953_priv *priv, int duration_ms)
+{
+	struct ds90ub954_priv *des = priv->parent;
+	struct ds90ub953_pgen_result res;
+	struct ds90ub954_pgen_timing t;
+	int err, hi, lo;
+
+	lockdep_assert_held(&priv->lock);
+
+	if(priv->pgen_testing)
+		return -EBUSY;
+
+	memset(&res, 0, sizeof(res));
+	err = ds90ub954_pgen_calc(&priv->pgen, ds90ub954_csi_kbps(des), &t);
+	if(err)
+		return err;
+
+	priv->pgen_testing = true;
+	err = ds90ub953_init_testpattern(priv);
+	if(unlikely(err))
+		goto test_err;
+
+	/* settle for two frames, then clear the status */
+	err = ds90ub953_pgen_sleep(priv,
+				   DIV_ROUND_UP(2 * 1000 * 1000, t.fps_milli));
+	if(!err)
+		err = ds90ub953_pgen_read_sts(priv, &res);
+	if(unlikely(err))
+		goto test_err;
+
+	err = ds90ub953_pgen_sleep(priv, duration_ms);
+	if(!err)
+		err = ds90ub953_pgen_read_sts(priv, &res);
+	if(unlikely(err))
+		goto test_err;
+
+	err = ds90ub954_read_rx_port(des, priv->rx_channel,
+				     TI954_REG_LINE_COUNT_HI, &hi);
+	if(!err)
+		err = ds90ub954_read_rx_port(des, priv->rx_channel,
+					     TI954_REG_LINE_COUNT_LO, &lo);
+	if(unlikely(err))
+		goto test_err;
+	res.line_count = (hi<<8) | lo;
+
+	err = ds90ub954_read_rx_port(des, priv->rx_channel,
+				     TI954_REG_LINE_LEN_1, &hi);
+	if(!err)
+		err = ds90ub954_read_rx_port(des, priv->rx_channel,
+					     TI954_REG_LINE_LEN_0, &lo);
+	if(unlikely(err))
+		goto test_err;
+	res.line_len = (hi<<8) | lo;
+
+	res.valid = 1;
+	res.duration_ms = duration_ms;
+	res.exp_line_count = priv->pgen.height;
+	res.exp_line_len = t.line_size;
+	res.kbps = t.kbps;
+	res.pass = res.line_count == res.exp_line_count &&
+		   res.line_len == res.exp_line_len &&
+		   !res.csi_errors && !res.csi_rx_sts && !res.port_sts2;
+	priv->pgen_result = res;
+
+	dev_info(&priv->client->dev,
+		 "%s: rx port %d %s: %d lines of %d bytes (expected %d of %d), %d csi errors, %llu kbit/s\n",
+		 __func__, priv->rx_channel, res.pass ? "pass" : "fail",
+		 res.line_count, res.line_len, res.exp_line_count,
+		 res.exp_line_len, res.csi_errors, res.kbps);
+
+test_err:
+	priv->pgen_testing = false;
+	if(priv->initialized && priv->test_pattern != 1)
+		ds90ub953_disable_testpattern(priv);
+	return err;
+}
+
+#ifdef ENABLE_SYSFS_TP
+static ssize_t test_pattern_show_ser(struct device *dev,
+				     struct device_attribute *attr, char *buf)
+{
+	struct ds90ub953_priv *priv;
+	priv = dev_get_drvdata(dev);
+	return snprintf(buf, PAGE_SIZE,
+			"Test Pattern is set to: %i\n", priv->test_pattern);
+}
+
+static ssize_t test_pattern_set_ser(struct device *dev,
+				    struct device_attribute *attr,
+				    const char *buf, size_t count)
+{
+	struct ds90ub953_priv *priv;
+	int testpat;
+
+	priv = dev_get_drvdata(dev);
+
+	sscanf(buf, "%d", &testpat);
+	if(testpat > 1 || testpat < 0) {
+		dev_info(dev,
+			 "Invalid value: %i for test pattern (0/1)\n", testpat);
+		return PAGE_SIZE;
+	}
+	mutex_lock(&priv->lock);
+	if(testpat == 1) {
+		dev_info(dev, "enabling testpattern for serializer\n");
+		priv->test_pattern = 1;
+		ds90ub953_init_testpattern(priv);
+	} else {
+		dev_info(dev, "disabling testpattern for serializer\n");
+		priv->test_pattern = 0;
+		ds90ub953_disable_testpattern(priv);
+	}
+	mutex_unlock(&priv->lock);
+	return PAGE_SIZE;
+}
+static DEVICE_ATTR(test_pattern_ser, 0664, test_pattern_show_ser,
+		   test_pattern_set_ser);
+
+#endif
+
+static ssize_t i2c_alias_show(struct device *dev,
+			      struct device_attribute *attr, char *buf)
+{
+	struct ds90ub953_priv *priv = dev_get_drvdata(dev);
+	struct ds90ub953_alias *slot;
+	int i, len = 0;
+
+	mutex_lock(&priv->parent->alias_lock);
+	for(i = 0; i < NUM_ALIAS; i++) {
+		slot = &priv->alias[i];
+		if(slot->slave == 0)
+			continue;
+		len += scnprintf(buf + len, PAGE_SIZE - len,
+				 "slot %i: slave 0x%02X alias 0x%02X %s uses %u\n",
+				 i, slot->slave, slot->alias,
+				 slot->pinned == ALIAS_PIN_DT ? "static" :
+				 slot->pinned == ALIAS_PIN_REMOTE ? "remote" :
+				 "dynamic",
+				 slot->use_count);
+	}
+	mutex_unlock(&priv->parent->alias_lock);
+	return len;
+}
+
+/* writing a remote slave address maps it to an alias from the pool */
+static ssize_t i2c_alias_store(struct device *dev,
+			       struct device_attribute *attr,
+			       const char *buf, size_t count)
+{
+	struct ds90ub953_priv *priv = dev_get_drvdata(dev);
+	unsigned int slave;
+	int err;
+
+	err = kstrtouint(buf, 0, &slave);
+	if(err)
+		return err;
+
+	err = ds90ub954_alias_get(priv->parent, priv, slave);
+	if(err < 0)
+		return err;
+	return count;
+}
+static DEVICE_ATTR(i2c_alias, 0664, i2c_alias_show, i2c_alias_store);
+
+/*------------------------------------------------------------------------------
+ * REMOTE WRITE QUEUE
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Send the queued messages. Their alias slots are pinned while they are in
+ * flight and are released once the transfer is done. Returns the number of
+ * messages acknowledged by the adapter or an error code.
+ */
+static int ds90ub953_batch_send(struct ds90ub953_priv *priv, int num_msgs)
+{
+	struct ds90ub953_batch *batch = &priv->batch;
+	struct ds90ub954_priv *des = priv->parent;
+	int ret;
+
+	ret = i2c_transfer(des->client->adapter, batch->msgs, num_msgs);
+	ds90ub954_alias_unpin(des, priv, 0, ALIAS_PIN_BATCH);
+	if(ret > 0)
+		batch->transfers += ret;
+	return ret;
+}
+
+/*
+ * Send all queued remote writes. Writes to consecutive registers of the same
+ * slave are coalesced into one burst, the bursts are sent with as few
+ * i2c_transfer() calls as possible (repeated start between the messages).
+ * The alias of a slave is pinned until its messages are sent, so a lookup
+ * for a later slave can not reclaim it; if only in-flight slots are left,
+ * the messages queued so far are sent first. If a transfer fails, the writes
+ * of the messages sent before are applied and the rest is dropped; both are
+ * reported. Must be called with batch->lock held.
+ */
+static int ds90ub953_batch_flush_locked(struct ds90ub953_priv *priv)
+{
+	struct ds90ub953_batch *batch = &priv->batch;
+	struct ds90ub954_priv *des = priv->parent;
+	struct device *dev = &des->client->dev;
+	struct ds90ub953_reg_write *w, *prev = NULL;
+	struct i2c_msg *msgs = batch->msgs;
+	int first[BATCH_MAX_MSGS]; /* first queued write of each message */
+	int i, alias = 0, num_msgs = 0, sent = 0, ret = 0, err = 0;
+
+	lockdep_assert_held(&batch->lock);
+
+	cancel_delayed_work(&batch->deadline_work);
+
+	for(i = 0; i < batch->num; i++) {
+		w = &batch->queue[i];
+
+		/* extend the current burst if the register follows directly */
+		if(prev && num_msgs && prev->slave == w->slave &&
+		   prev->reg_bytes == w->reg_bytes && prev->reg + 1 == w->reg &&
+		   msgs[num_msgs-1].len < w->reg_bytes + BATCH_MAX_BURST) {
+			batch->bufs[num_msgs-1][msgs[num_msgs-1].len++] = w->val;
+			prev = w;
+			continue;
+		}
+
+		if(num_msgs == BATCH_MAX_MSGS) {
+			ret = ds90ub953_batch_send(priv, num_msgs);
+			if(ret != num_msgs)
+				goto xfer_err;
+			sent = i;
+			num_msgs = 0;
+		}
+
+		if(!prev || prev->slave != w->slave) {
+			alias = ds90ub954_alias_pin(des, priv, w->slave,
+						    ALIAS_PIN_BATCH);
+			if(alias == -EBUSY && num_msgs) {
+				ret = ds90ub953_batch_send(priv, num_msgs);
+				if(ret != num_msgs)
+					goto xfer_err;
+				sent = i;
+				num_msgs = 0;
+				alias = ds90ub954_alias_pin(des, priv, w->slave,
+							    ALIAS_PIN_BATCH);
+			}
+			if(alias < 0) {
+				err = alias;
+				goto flush_err;
+			}
+		}
+
+		first[num_msgs] = i;
+		msgs[num_msgs].addr = alias;
+		msgs[num_msgs].flags = 0;
+		msgs[num_msgs].buf = batch->bufs[num_msgs];
+		msgs[num_msgs].len = 0;
+		if(w->reg_bytes == 2)
+			batch->bufs[num_msgs][msgs[num_msgs].len++] = w->reg >> 8;
+		batch->bufs[num_msgs][msgs[num_msgs].len++] = w->reg & 0xff;
+		batch->bufs[num_msgs][msgs[num_msgs].len++] = w->val;
+		num_msgs++;
+		prev = w;
+	}
+
+	if(num_msgs) {
+		ret = ds90ub953_batch_send(priv, num_msgs);
+		if(ret != num_msgs)
+			goto xfer_err;
+	}
+	batch->writes += batch->num;
+	batch->num = 0;
+	return 0;
+
+xfer_err:
+	/* messages before ret were acknowledged by the adapter */
+	if(ret > 0)
+		sent = first[ret];
+	err = (ret < 0) ? ret : -EIO;
+flush_err:
+	/* release the slots of messages that were never sent */
+	ds90ub954_alias_unpin(des, priv, 0, ALIAS_PIN_BATCH);
+	batch->errors++;
+	batch->dropped += batch->num - sent;
+	dev_err(dev, "%s: rx_port %i: remote write batch failed after %i of %i writes (%d)\n",
+		__func__, priv->rx_channel, sent, batch->num, err);
+	batch->writes += sent;
+	batch->num = 0;
+	return err;
+}
+
+/*
+ * Queue a batch of remote register writes. The batch is queued completely or
+ * not at all, so a frame never sees only a part of it as long as the flush
+ * succeeds. The queue is flushed at the next frame start or when the
+ * deadline expires. Nothing is queued while the link is powered down.
+ */
+static int ds90ub953_batch_queue(struct ds90ub953_priv *priv,
+				 const struct ds90ub953_reg_write *writes,
+				 int num)
+{
+	struct ds90ub953_batch *batch = &priv->batch;
+	int err = 0;
+
+	if(num <= 0)
+		return -EINVAL;
+
+	mutex_lock(&batch->lock);
+	/* suspend flushes the queue, a write queued after it would be sent
+	 * over a link that is down */
+	if(batch->suspended) {
+		err = -EAGAIN;
+		goto queue_err;
+	}
+	if(batch->num + num > BATCH_MAX_WRITES) {
+		err = -ENOSPC;
+		goto queue_err;
+	}
+	memcpy(&batch->queue[batch->num], writes, num * sizeof(*writes));
+	if(batch->num == 0)
+		schedule_delayed_work(&batch->deadline_work,
+				      msecs_to_jiffies(batch->deadline_ms));
+	batch->num += num;
+	batch->batches++;
+queue_err:
+	mutex_unlock(&batch->lock);
+	return err;
+}
+
+static void ds90ub953_batch_deadline_work(struct work_struct *work)
+{
+	struct ds90ub953_batch *batch = container_of(to_delayed_work(work),
+						     struct ds90ub953_batch,
+						     deadline_work);
+	struct ds90ub953_priv *priv = container_of(batch, struct ds90ub953_priv,
+						   batch);
+
+	mutex_lock(&batch->lock);
+	if(batch->num) {
+		batch->deadline_flushes++;
+		ds90ub953_batch_flush_locked(priv);
+	}
+	mutex_unlock(&batch->lock);
+}
+
+static irqreturn_t ds90ub953_frame_start_irq(int irq, void *dev_id)
+{
+	struct ds90ub953_priv *priv = dev_id;
+	struct ds90ub953_batch *batch = &priv->batch;
+
+	mutex_lock(&batch->lock);
+	if(batch->num) {
+		batch->frame_flushes++;
+		ds90ub953_batch_flush_locked(priv);
+	}
+	mutex_unlock(&batch->lock);
+	return IRQ_HANDLED;
+}
+
+/* frame-start-gpio of the serializer node, the queue runs on deadlines only
+ * without it */
+static int ds90ub953_batch_init_irq(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->parent->client->dev;
+	struct ds90ub953_batch *batch = &priv->batch;
+	struct gpio_desc *gpio;
+	int irq, err;
+
+	batch->frame_start_irq = -ENOENT;
+	gpio = devm_fwnode_gpiod_get(dev, of_fwnode_handle(priv->np),
+				     "frame-start", GPIOD_IN,
+				     "ds90ub953_frame_start");
+	if(IS_ERR(gpio)) {
+		err = PTR_ERR(gpio);
+		if(err == -ENOENT)
+			return 0;
+		dev_err(dev, "unable to request frame-start-gpio (%d)\n", err);
+		return err;
+	}
+	batch->frame_start_gpio = gpio;
+
+	irq = gpiod_to_irq(gpio);
+	if(irq < 0) {
+		dev_err(dev, "frame-start-gpio has no interrupt (%d)\n", irq);
+		return irq;
+	}
+
+	err = devm_request_threaded_irq(dev, irq, NULL,
+					ds90ub953_frame_start_irq,
+					IRQF_TRIGGER_RISING | IRQF_ONESHOT,
+					"ds90ub953_frame_start", priv);
+	if(unlikely(err)) {
+		dev_err(dev, "unable to request frame start irq (%d)\n", err);
+		return err;
+	}
+	batch->frame_start_irq = irq;
+	return 0;
+}
+
+static ssize_t reg_batch_show(struct device *dev,
+			      struct device_attribute *attr, char *buf)
+{
+	struct ds90ub953_priv *priv = dev_get_drvdata(dev);
+	struct ds90ub953_batch *batch = &priv->batch;
+	int len;
+
+	mutex_lock(&batch->lock);
+	len = scnprintf(buf, PAGE_SIZE,
+			"queued: %i\nbatches: %u\nwrites: %u\ntransfers: %u\n"
+			"frame flushes: %u\ndeadline flushes: %u\nerrors: %u\n"
+			"dropped: %u\n",
+			batch->num, batch->batches, batch->writes,
+			batch->transfers, batch->frame_flushes,
+			batch->deadline_flushes, batch->errors, batch->dropped);
+	mutex_unlock(&batch->lock);
+	return len;
+}
+
+/* one write per line: "<slave> <reg> <val> [<reg_bytes>]" */
+static ssize_t reg_batch_store(struct device *dev,
+			       struct device_attribute *attr,
+			       const char *buf, size_t count)
+{
+	struct ds90ub953_priv *priv = dev_get_drvdata(dev);
+	struct ds90ub953_reg_write *writes;
+	unsigned int slave, reg, val, reg_bytes;
+	char *kbuf, *cur, *line;
+	int num = 0, n, err = 0;
+
+	writes = kcalloc(BATCH_MAX_WRITES, sizeof(*writes), GFP_KERNEL);
+	kbuf = kstrndup(buf, count, GFP_KERNEL);
+	if(!writes || !kbuf) {
+		err = -ENOMEM;
+		goto store_err;
+	}
+
+	cur = kbuf;
+	while((line = strsep(&cur, "\n;")) != NULL) {
+		line = strim(line);
+		if(!*line)
+			continue;
+		reg_bytes = 1;
+		n = sscanf(line, "%i %i %i %i", &slave, &reg, &val, &reg_bytes);
+		if(n < 3 || num == BATCH_MAX_WRITES || slave > 0x7f ||
+		   val > 0xff || (reg_bytes != 1 && reg_bytes != 2) ||
+		   reg >= (1U << (8 * reg_bytes))) {
+			err = -EINVAL;
+			goto store_err;
+		}
+		writes[num].slave = slave;
+		writes[num].reg_bytes = reg_bytes;
+		writes[num].reg = reg;
+		writes[num].val = val;
+		num++;
+	}
+
+	err = ds90ub953_batch_queue(priv, writes, num);
+
+store_err:
+	kfree(kbuf);
+	kfree(writes);
+	return err ? err : count;
+}
+static DEVICE_ATTR(reg_batch, 0664, reg_batch_show, reg_batch_store);
+
+static int ds90ub953_init_i2c_timing(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub95x_i2c_timing t;
+	int val, err;
+
+	err = ds90ub95x_calc_i2c_timing(priv->i2c_scl_freq, &t);
+	if(err) {
+		dev_err(dev, "%s: invalid i2c scl frequency %i\n", __func__,
+			priv->i2c_scl_freq);
+		return err;
+	}
+
+	err = ds90ub953_write(priv, TI953_REG_SCL_HIGH_TIME,
+			      (t.scl_high<<TI953_SCL_HIGH_TIME));
+	if(unlikely(err))
+		return err;
+
+	err = ds90ub953_write(priv, TI953_REG_SCL_LOW_TIME,
+			      (t.scl_low<<TI953_SCL_LOW_TIME));
+	if(unlikely(err))
+		return err;
+
+	err = ds90ub953_read(priv, TI953_REG_I2C_CONTROL2, &val);
+	if(unlikely(err))
+		return err;
+
+	val &= ~(0x3<<TI953_SDA_OUTPUT_SETUP);
+	val |= (t.sda_setup<<TI953_SDA_OUTPUT_SETUP);
+	err = ds90ub953_write(priv, TI953_REG_I2C_CONTROL2, val);
+	if(unlikely(err))
+		return err;
+
+	dev_dbg(dev, "%s: remote i2c scl %i Hz, high 0x%02x, low 0x%02x\n",
+		__func__, priv->i2c_scl_freq, t.scl_high, t.scl_low);
+	return 0;
+}
+
+/*------------------------------------------------------------------------------
+ * CLOCK OUTPUT
+ *----------------------------------------------------------------------------*/
+
+#define to_ds90ub953_clkout(_hw) container_of(_hw, struct ds90ub953_priv, clkout)
+
+struct ds90ub953_clkout_cfg {
+	int hs_clk_div; // TI953_HS_CLK_DIV_*, divides by 1<<hs_clk_div
+	int div_m_val;
+	int div_n_val;
+};
+
+/* forward channel rate in synchronous mode, REFCLK of deserializer * 160 */
+static u64 ds90ub953_fc_rate(const struct ds90ub953_priv *priv)
+{
+	return (u64)priv->parent->refclk_freq * TI953_FC_RATE_MULT;
+}
+
+/*                fc_rate        div_m_val
+ *  CLK_OUT = ---------------- * ---------
+ *               hs-clk-div      div_n_val */
+static unsigned long ds90ub953_clkout_rate(u64 fc_rate,
+					   const struct ds90ub953_clkout_cfg *cfg)
+{
+	return div64_u64(fc_rate * cfg->div_m_val,
+			 (u64)cfg->div_n_val << cfg->hs_clk_div);
+}
+
+/* Check the limits: CLK_OUT < 100 MHz and fc_rate/hs-clk-div < 1.05 GHz
+ * (REFCLK/hs-clk-div < 6.56 MHz) */
+static int ds90ub953_clkout_valid(u64 fc_rate,
+				  const struct ds90ub953_clkout_cfg *cfg)
+{
+	if(cfg->hs_clk_div < TI953_HS_CLK_DIV_1 ||
+	   cfg->hs_clk_div > TI953_HS_CLK_DIV_16 ||
+	   cfg->div_m_val < 1 || cfg->div_m_val > TI953_DIV_M_MAX ||
+	   cfg->div_n_val < 1 || cfg->div_n_val > TI953_DIV_N_MAX)
+		return 0;
+	if((fc_rate >> cfg->hs_clk_div) >= TI953_HS_CLK_MAX)
+		return 0;
+	return ds90ub953_clkout_rate(fc_rate, cfg) < TI953_CLKOUT_MAX;
+}
+
+/* find the valid dividers with the rate closest to the requested rate */
+static int ds90ub953_clkout_calc(u64 fc_rate, unsigned long rate,
+				 struct ds90ub953_clkout_cfg *best)
+{
+	struct ds90ub953_clkout_cfg cfg;
+	unsigned long best_diff = ULONG_MAX;
+	unsigned long diff, r;
+	u64 n;
+
+	if(!rate || !fc_rate)
+		return -EINVAL;
+
+	for(cfg.hs_clk_div = TI953_HS_CLK_DIV_1;
+	    cfg.hs_clk_div <= TI953_HS_CLK_DIV_16; cfg.hs_clk_div++) {
+		for(cfg.div_m_val = 1; cfg.div_m_val <= TI953_DIV_M_MAX;
+		    cfg.div_m_val++) {
+			/* closest N for this HS_CLK_DIV and M */
+			n = div64_u64(fc_rate * cfg.div_m_val +
+				      ((u64)rate << cfg.hs_clk_div) / 2,
+				      (u64)rate << cfg.hs_clk_div);
+			cfg.div_n_val = clamp_t(u64, n, 1, TI953_DIV_N_MAX);
+			if(!ds90ub953_clkout_valid(fc_rate, &cfg))
+				continue;
+
+			r = ds90ub953_clkout_rate(fc_rate, &cfg);
+			diff = (r > rate) ? r - rate : rate - r;
+			if(diff < best_diff) {
+				best_diff = diff;
+				*best = cfg;
+				if(!diff)
+					return 0;
+			}
+		}
+	}
+	return (best_diff == ULONG_MAX) ? -ERANGE : 0;
+}
+
+static int ds90ub953_write_clkout(struct ds90ub953_priv *priv)
+{
+	int err;
+
+	err = ds90ub953_write(priv, TI953_REG_CLKOUT_CTRL0,
+			      (priv->hs_clk_div<<TI953_HS_CLK_DIV) |
+			      (priv->div_m_val<<TI953_DIV_M_VAL));
+	if(unlikely(err))
+		return err;
+
+	return ds90ub953_write(priv, TI953_REG_CLKOUT_CTRL1,
+			       priv->div_n_val<<TI953_DIV_N_VAL);
+}
+
+/* apply clkout-frequency or check the dividers from the device tree */
+static int ds90ub953_init_clkout(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->parent->client->dev;
+	struct ds90ub953_clkout_cfg cfg = {
+		.hs_clk_div = priv->hs_clk_div,
+		.div_m_val = priv->div_m_val,
+		.div_n_val = priv->div_n_val,
+	};
+	u64 fc_rate = ds90ub953_fc_rate(priv);
+	int err;
+
+	if(priv->clkout_rate) {
+		err = ds90ub953_clkout_calc(fc_rate, priv->clkout_rate, &cfg);
+		if(err) {
+			dev_err(dev, "%s: rx_port %i: no dividers for %lu Hz\n",
+				__func__, priv->rx_channel, priv->clkout_rate);
+			return err;
+		}
+		priv->hs_clk_div = cfg.hs_clk_div;
+		priv->div_m_val = cfg.div_m_val;
+		priv->div_n_val = cfg.div_n_val;
+	} else if(!ds90ub953_clkout_valid(fc_rate, &cfg)) {
+		dev_warn(dev, "%s: rx_port %i: hs-clk-div %i, div-m-val %i, div-n-val %i out of spec\n",
+			 __func__, priv->rx_channel, 1<<cfg.hs_clk_div,
+			 cfg.div_m_val, cfg.div_n_val);
+	}
+
+	dev_dbg(dev, "%s: rx_port %i: CLK_OUT %lu Hz (hs-clk-div %i, m %i, n %i)\n",
+		__func__, priv->rx_channel, ds90ub953_clkout_rate(fc_rate, &cfg),
+		1<<cfg.hs_clk_div, cfg.div_m_val, cfg.div_n_val);
+	return ds90ub953_write_clkout(priv);
+}
+
+static unsigned long ds90ub953_clkout_recalc_rate(struct clk_hw *hw,
+						  unsigned long parent_rate)
+{
+	struct ds90ub953_priv *priv = to_ds90ub953_clkout(hw);
+	struct ds90ub953_clkout_cfg cfg = {
+		.hs_clk_div = priv->hs_clk_div,
+		.div_m_val = priv->div_m_val,
+		.div_n_val = priv->div_n_val,
+	};
+
+	if(!cfg.div_n_val)
+		return 0;
+	return ds90ub953_clkout_rate(ds90ub953_fc_rate(priv), &cfg);
+}
+
+static long ds90ub953_clkout_round_rate(struct clk_hw *hw, unsigned long rate,
+					unsigned long *parent_rate)
+{
+	struct ds90ub953_priv *priv = to_ds90ub953_clkout(hw);
+	struct ds90ub953_clkout_cfg cfg;
+	u64 fc_rate = ds90ub953_fc_rate(priv);
+	int err;
+
+	err = ds90ub953_clkout_calc(fc_rate, rate, &cfg);
+	if(err)
+		return err;
+	return ds90ub953_clkout_rate(fc_rate, &cfg);
+}
+
+static int ds90ub953_clkout_set_rate(struct clk_hw *hw, unsigned long rate,
+				     unsigned long parent_rate)
+{
+	struct ds90ub953_priv *priv = to_ds90ub953_clkout(hw);
+	struct ds90ub953_clkout_cfg cfg;
+	int err;
+
+	err = ds90ub953_clkout_calc(ds90ub953_fc_rate(priv), rate, &cfg);
+	if(err)
+		return err;
+
+	mutex_lock(&priv->lock);
+	priv->hs_clk_div = cfg.hs_clk_div;
+	priv->div_m_val = cfg.div_m_val;
+	priv->div_n_val = cfg.div_n_val;
+	err = ds90ub953_write_clkout(priv);
+	mutex_unlock(&priv->lock);
+	return err;
+}
+
+static const struct clk_ops ds90ub953_clkout_ops = {
+	.recalc_rate = ds90ub953_clkout_recalc_rate,
+	.round_rate = ds90ub953_clkout_round_rate,
+	.set_rate = ds90ub953_clkout_set_rate,
+};
+
+/* register CLK_OUT as clock provider on the serializer node */
+static int ds90ub953_clkout_register(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->parent->client->dev;
+	struct clk_init_data init = {};
+	const char *name;
+	int err;
+
+	if(of_property_read_string(priv->np, "clock-output-names", &name)) {
+		name = devm_kasprintf(dev, GFP_KERNEL, "%s-rx%i-clkout",
+				      dev_name(dev), priv->rx_channel);
+		if(!name)
+			return -ENOMEM;
+	}
+
+	init.name = name;
+	init.ops = &ds90ub953_clkout_ops;
+	init.num_parents = 0;
+	priv->clkout.init = &init;
+
+	err = devm_clk_hw_register(dev, &priv->clkout);
+	if(unlikely(err)) {
+		dev_err(dev, "%s: rx_port %i: unable to register clock (%d)\n",
+			__func__, priv->rx_channel, err);
+		return err;
+	}
+
+	err = of_clk_add_hw_provider(priv->np, of_clk_hw_simple_get,
+				     &priv->clkout);
+	if(unlikely(err))
+		dev_err(dev, "%s: rx_port %i: unable to add clock provider (%d)\n",
+			__func__, priv->rx_channel, err);
+	return err;
+}
+
+/* write TI953_REG_GPIO_CTRL from the gpio output enable settings */
+static int ds90ub953_write_gpio_ctrl(struct ds90ub953_priv *priv)
+{
+	int i, val = 0;
+
+	for(i = 0; i < TI953_NUM_GPIO; i++) {
+		if(priv->gpio_oe[i])
+			val |= (1<<(TI953_GPIO0_OUT_EN+i));
+		else
+			val |= (1<<(TI953_GPIO0_INPUT_EN+i));
+	}
+	return ds90ub953_write(priv, TI953_REG_GPIO_CTRL, val);
+}
+
+/* serializer side of the back channel, also restored after a bcc error */
+static int ds90ub953_init_bcc(struct ds90ub953_priv *priv)
+{
+	int wd_ms = priv->parent->bcc.wd_ms;
+	int err;
+
+	err = ds90ub953_write(priv, TI953_REG_BCC_CONFIG,
+			      (0x1<<TI953_I2C_PASS_THROUGH_ALL) |
+			      (0x1<<TI953_RX_PARITY_CHECKER_ENABLE));
+	if(unlikely(err) || wd_ms < 0)
+		return err;
+
+	return ds90ub953_write(priv, TI953_REG_BBC_WATCHDOG,
+			       ds90ub954_bcc_wd_ctl(wd_ms));
+}
+
+static int ds90ub953_init(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	int val, dev_id, i;
+	int err = 0;
+	char id_code[TI953_RX_ID_LENGTH + 1];
+
+	dev_dbg(dev, "%s: start\n", __func__);
+
+	err = ds90ub953_read(priv, TI953_REG_I2C_DEV_ID, &val);
+	if(unlikely(err))
+		goto init_err;
+
+	dev_id = (unsigned char)val;
+
+	memset(id_code, 0, sizeof(id_code));
+	for(i = 0; i < TI953_RX_ID_LENGTH; i++) {
+		err = ds90ub953_read(priv, TI953_REG_FPD3_RX_ID0 + i, &val);
+		if(unlikely(err))
+			goto init_err;
+		id_code[i] = (char)val;
+	}
+	dev_dbg(dev, "%s: device ID: 0x%x, code:%s\n", __func__, dev_id, id_code);
+
+	 /* set to csi lanes */
+	switch(priv->csi_lane_count) {
+	case 1:
+		val = TI953_CSI_LANE_SEL1;
+		break;
+	case 2:
+		val = TI953_CSI_LANE_SEL2;
+		break;
+	default:
+		val = TI953_CSI_LANE_SEL4;
+		break;
+	}
+	err = ds90ub953_write(priv, TI953_REG_GENERAL_CFG,
+			      (1<<TI953_I2C_STRAP_MODE) |
+			      (1<<TI953_CRC_TX_GEN_ENABLE) |
+			      (val<<TI953_CSI_LANE_SEL) |
+			      (priv->conts_clk<<TI953_CONTS_CLK));
+	if(unlikely(err))
+		goto init_err;
+
+	/* set clock output frequency */
+	err = ds90ub953_init_clkout(priv);
+	if(unlikely(err))
+		goto init_err;
+
+	/* setup GPIOs to input/output */
+	err = ds90ub953_write_gpio_ctrl(priv);
+	if(unlikely(err))
+		goto init_err;
+
+	err = ds90ub953_write(priv, TI953_REG_LOCAL_GPIO_DATA,
+			      (0xf<<TI953_GPIO_RMTEN));
+	if(unlikely(err))
+		goto init_err;
+
+	/* set remote i2c master timing, reset default is standard mode */
+	if(priv->i2c_scl_freq) {
+		err = ds90ub953_init_i2c_timing(priv);
+		if(unlikely(err))
+			goto init_err;
+	}
+
+	err = ds90ub953_init_bcc(priv);
+	if(unlikely(err))
+		goto init_err;
+
+	/* check if test pattern should be turned on*/
+	if(priv->test_pattern == 1) {
+		dev_dbg(dev,"%s: serializer rx_port %i init testpattern\n",
+			__func__, priv->rx_channel);
+		err = ds90ub953_init_testpattern(priv);
+		if(unlikely(err))
+			dev_warn(dev,
+				 "%s: serializer rx_port %i init testpattern failed\n",
+				 __func__, priv->rx_channel);
+	}
+
+	/* device attributes on sysfs, created by ds90ub953_register() */
+	dev_set_drvdata(dev, priv);
+	err = 0;
+	dev_dbg(dev, "%s: successful\n", __func__);
+
+init_err:
+	ds90ub954_port_set_state(priv->parent, priv->rx_channel,
+				 err ? PORT_FAULT : PORT_STREAMING);
+	return err;
+}
+
+static void ds90ub953_free(struct ds90ub954_priv *priv)
+{
+	int i;
+	for(i = 0; i < priv->num_ser; i++) {
+		if(priv->ser[i]) {
+			cancel_delayed_work_sync(&priv->ser[i]->batch.deadline_work);
+			i2c_unregister_device(priv->ser[i]->client);
+			of_clk_del_provider(priv->ser[i]->np);
+			of_node_put(priv->ser[i]->np);
+		}
+	}
+}
+
+static int ds90ub953_regmap_init(struct ds90ub954_priv *priv, int ser_nr)
+{
+	struct regmap *new_regmap = NULL;
+	struct device *dev = &priv->client->dev;
+	int err = 0;
+
+	/* setup now regmap */
+	new_regmap = devm_regmap_init_i2c(priv->ser[ser_nr]->client,
+					  &ds90ub953_regmap_config);
+	if(IS_ERR_VALUE(priv->regmap)) {
+		err = PTR_ERR(priv->regmap);
+		dev_err(dev, "regmap init of subdevice failed (%d)\n", err);
+		return err;
+	}
+	dev_dbg(dev, "%s init regmap done\n", __func__);
+
+	priv->ser[ser_nr]->regmap = new_regmap;
+	return err;
+}
+
+static int ds90ub953_alloc(struct ds90ub954_priv *priv, int ser_nr)
+{
+	struct ds90ub953_priv *priv_ser;
+	struct device *dev = &priv->client->dev;
+
+	priv_ser = devm_kzalloc(dev, sizeof(struct ds90ub953_priv), GFP_KERNEL);
+	if(!priv_ser)
+		return -ENOMEM;
+
+	priv->ser[ser_nr] = priv_ser;
+	priv->ser[ser_nr]->parent = priv;
+	priv->ser[ser_nr]->initialized = 0;
+
+	mutex_init(&priv_ser->lock);
+	mutex_init(&priv_ser->gpio_lock);
+	spin_lock_init(&priv_ser->hist.lock);
+	spin_lock_init(&priv_ser->cache_lock);
+	ds90ub954_pgen_default(&priv_ser->pgen);
+	mutex_init(&priv_ser->batch.lock);
+	INIT_DELAYED_WORK(&priv_ser->batch.deadline_work,
+			  ds90ub953_batch_deadline_work);
+	priv_ser->batch.frame_start_irq = -ENOENT;
+	return 0;
+}
+
+static int ds90ub953_i2c_client(struct ds90ub954_priv *priv, int ser_nr,
+				int addr)
+{
+	struct i2c_client *new_client = NULL;
+	struct device *dev = &priv->client->dev;
+
+	struct i2c_board_info *ser_board_info;
+	ser_board_info = devm_kzalloc(dev, sizeof(struct i2c_board_info), GFP_KERNEL);
+	ser_board_info->addr = addr;
+
+	new_client = i2c_new_client_device(priv->client->adapter, ser_board_info);
+	if(!new_client) {
+		dev_warn(dev, "failed to add i2c client\n");
+		return -1;
+	}
+
+	priv->ser[ser_nr]->client = new_client;
+	dev_dbg(dev, "%s init client done\n", __func__);
+	return 0;
+}
+
+/*
+ * Serializer properties of the device tree node ser, see ti,ds90ub954.txt.
+ * Properties that are not set get their default value. No hardware access,
+ * so the parser also runs on a test node.
+ */
+static int ds90ub953_parse_dt_ser(struct ds90ub954_priv *priv,
+				  struct ds90ub953_priv *ds90ub953,
+				  struct device_node *ser)
+{
+	struct device *dev = &priv->client->dev;
+	u32 val = 0;
+	int err;
+
+	/* get rx-channel */
+	err = of_property_read_u32(ser, "rx-channel", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - rx-channel property not found\n",
+			__func__);
+		/* default value: 0 */
+		ds90ub953->rx_channel = 0;
+		dev_dbg(dev, "%s: rx-channel set to default val: 0\n",
+			__func__);
+	} else {
+		/* set rx-channel*/
+		ds90ub953->rx_channel = val;
+		dev_dbg(dev,"%s: - serializer rx-channel: %i\n",
+			__func__, val);
+	}
+	if(ds90ub953->rx_channel >= priv->chip->num_rx_ports) {
+		dev_err(dev, "%s: - rx-channel %i not available on %s\n",
+			__func__, ds90ub953->rx_channel, priv->chip->name);
+		return -EINVAL;
+	}
+
+	if(of_property_read_bool(ser, "test-pattern")) {
+		dev_dbg(dev, "%s: - test-pattern enabled\n", __func__);
+		ds90ub953->test_pattern = 1;
+	} else {
+		/* default value: 0 */
+		ds90ub953->test_pattern = 0;
+		dev_dbg(dev,"%s: -test-pattern disabled\n", __func__);
+	}
+
+	err = of_property_read_u32(ser, "csi-lane-count", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - csi-lane-count property not found\n",
+			__func__);
+		/* default value: 4 */
+		ds90ub953->csi_lane_count = 4;
+		dev_dbg(dev, "%s: csi-lane-count set to default val: 4\n",
+			__func__);
+	} else {
+		/* set csi-lane-count*/
+		ds90ub953->csi_lane_count = val;
+		dev_dbg(dev, "%s: - csi-lane-count %i\n", __func__, val);
+	}
+
+	/* GPIO output enable */
+	err = of_property_read_u32(ser, "gpio0-output-enable", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - gpio0-output-enable property not found\n",
+			__func__);
+		/* default value: 0 */
+		ds90ub953->gpio_oe[0] = 0;
+		dev_dbg(dev, "%s: gpio0-output-enable to default val: 0\n",
+			__func__);
+	} else {
+		/* set gpio0-output-enable*/
+		ds90ub953->gpio_oe[0] = val;
+		dev_dbg(dev, "%s: - gpio0-output-enable %i\n",
+			__func__, val);
+	}
+
+	err = of_property_read_u32(ser, "gpio1-output-enable", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - gpio1-output-enable property not found\n",
+			__func__);
+
+		/* default value: 0 */
+		ds90ub953->gpio_oe[1] = 0;
+		dev_dbg(dev, "%s: gpio1-output-enable to default val: 0\n",
+			__func__);
+	} else {
+		/* set gpio1-output-enable*/
+		ds90ub953->gpio_oe[1] = val;
+		dev_dbg(dev, "%s: - gpio1-output-enable %i\n",
+			__func__, val);
+	}
+
+	err = of_property_read_u32(ser, "gpio2-output-enable", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - gpio2-output-enable property not found\n",
+			__func__);
+		/* default value: 0 */
+		ds90ub953->gpio_oe[2] = 0;
+		dev_dbg(dev, "%s: gpio2-output-enable to default val: 0\n",
+			__func__);
+	} else {
+		/* set gpio2-output-enable*/
+		ds90ub953->gpio_oe[2] = val;
+		dev_dbg(dev,"%s: - gpio2-output-enable %i\n", __func__,
+			val);
+	}
+
+	err = of_property_read_u32(ser, "gpio3-output-enable", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - gpio3-output-enable property not found\n",
+			__func__);
+		/* default value: 0 */
+		ds90ub953->gpio_oe[3] = 0;
+		dev_dbg(dev, "%s: gpio3-output-enable to default val: 0\n",
+			__func__);
+	} else {
+		/* set gpio3-output-enable*/
+		ds90ub953->gpio_oe[3] = val;
+		dev_dbg(dev, "%s: - gpio3-output-enable %i\n",
+			__func__, val);
+	}
+
+	/* GPIO output control */
+	err = of_property_read_u32(ser, "gpio0-control", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - gpio0-control property not found\n",
+			__func__);
+		/* default value: 0b1000 */
+		ds90ub953->gpio_oc[0] = 0b1000;
+		dev_dbg(dev, "%s: gpio0-control to default val: 0b1000\n",
+			__func__);
+	} else {
+		/* set gpio0-control*/
+		ds90ub953->gpio_oc[0] = val;
+		dev_dbg(dev,"%s: - gpio0-control %i\n",
+			__func__, val);
+	}
+
+	err = of_property_read_u32(ser, "gpio1-control", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - gpio1-control property not found\n",
+			__func__);
+
+		/* default value: 0b1000 */
+		ds90ub953->gpio_oc[1] = 0b1000;
+		dev_dbg(dev, "%s: gpio1-control to default val: 0b1000\n",
+			__func__);
+	} else {
+		/* set gpio1-control*/
+		ds90ub953->gpio_oc[1] = val;
+		dev_dbg(dev, "%s: - gpio1-control %i\n",
+			__func__, val);
+	}
+
+	err = of_property_read_u32(ser, "gpio2-control", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - gpio2-control property not found\n",
+			__func__);
+		/* default value: 0b1000 */
+		ds90ub953->gpio_oc[2] = 0b1000;
+		dev_dbg(dev, "%s: gpio2-control to default val: 0b1000\n",
+			__func__);
+	} else {
+		/* set gpio2-control*/
+		ds90ub953->gpio_oc[2] = val;
+		dev_dbg(dev, "%s: - gpio2-control %i\n",
+			__func__, val);
+	}
+
+	err = of_property_read_u32(ser, "gpio3-control", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - gpio3-control property not found\n",
+			__func__);
+		/* default value: 0b1000 */
+		ds90ub953->gpio_oc[3] = 0b1000;
+		dev_dbg(dev, "%s: gpio3-control to default val: 0b1000\n",
+			__func__);
+	} else {
+		/* set gpio3-control*/
+		ds90ub953->gpio_oc[3] = val;
+		dev_dbg(dev, "%s: - gpio3-control %i\n",
+			__func__, val);
+	}
+
+	err = of_property_read_u32(ser, "hs-clk-div", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - hs-clk-div property not found\n",
+			__func__);
+
+		/* default value: 0x2 */
+		ds90ub953->hs_clk_div = 0x2;
+		dev_dbg(dev, "%s: - hs-clk-div set to default val: 0x2 (div by 4)\n",
+			__func__);
+	} else {
+		switch(val) {
+		case 1:
+			ds90ub953->hs_clk_div = 0b000;
+			break;
+		case 2:
+			ds90ub953->hs_clk_div = 0b001;
+			break;
+		case 4:
+			ds90ub953->hs_clk_div = 0b010;
+			break;
+		case 8:
+			ds90ub953->hs_clk_div = 0b011;
+			break;
+		case 16:
+			ds90ub953->hs_clk_div = 0b100;
+			break;
+		default:
+			ds90ub953->hs_clk_div = 0b010;
+			dev_dbg(dev, "%s: - %i no valid value for hs-clk-div\n",
+				__func__, val);
+			break;
+		}
+		dev_dbg(dev,"%s: - hs-clk-div set to val: %i (div by %i)\n",
+			__func__, ds90ub953->hs_clk_div, val);
+	}
+
+	err = of_property_read_u32(ser, "div-m-val", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - div-m-val property not found\n",
+			__func__);
+		/* default value: 1 */
+		ds90ub953->div_m_val = 1;
+		dev_dbg(dev, "%s: - div-m-val set to default val: 1\n",
+			__func__);
+	} else {
+		/* set div-m-val*/
+		ds90ub953->div_m_val = val;
+		dev_dbg(dev, "%s: - div-m-val %i\n", __func__, val);
+	}
+
+	err = of_property_read_u32(ser, "div-n-val", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - div-n-val property not found\n",
+			__func__);
+		/* default value: 0x28 */
+		ds90ub953->div_n_val = 0x28;
+		dev_dbg(dev, "%s: - div-n-val set to default val: 0x28\n",
+			__func__);
+	} else {
+		/* set div-n-val*/
+		ds90ub953->div_n_val = val;
+		dev_dbg(dev, "%s: - div-n-val %i\n", __func__, val);
+	}
+
+	err = of_property_read_u32(ser, "clkout-frequency", &val);
+	if(err) {
+		/* default value: 0, use the dividers */
+		ds90ub953->clkout_rate = 0;
+	} else {
+		ds90ub953->clkout_rate = val;
+		dev_dbg(dev, "%s: - clkout-frequency %i\n", __func__,
+			val);
+	}
+
+	err = of_property_read_u32(ser, "parity-error-threshold", &val);
+	if(err) {
+		/* default value: 0, no parity alarms */
+		ds90ub953->par_err_thold = 0;
+	} else {
+		ds90ub953->par_err_thold = min_t(u32, val, 0xffff);
+		dev_dbg(dev, "%s: - parity-error-threshold %i\n",
+			__func__, ds90ub953->par_err_thold);
+	}
+
+	/* get i2c address */
+	err = of_property_read_u32(ser, "i2c-address", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - i2c-address not found\n", __func__);
+		ds90ub953->i2c_address = 0x18;
+		dev_dbg(dev, "%s: - i2c-address set to default val: 0x18\n",
+			__func__);
+	} else {
+		dev_dbg(dev, "%s: - i2c-address: 0x%X \n", __func__, val);
+		ds90ub953->i2c_address=val;
+	}
+
+	if(of_property_read_bool(ser, "continuous-clock")) {
+		dev_dbg(dev, "%s: - continuous clock enabled\n",
+			__func__);
+		ds90ub953->conts_clk = 1;
+	} else {
+		/* default value: 0 */
+		ds90ub953->conts_clk = 0;
+		dev_dbg(dev, "%s: - discontinuous clock used\n",
+			__func__);
+	}
+
+	if(of_property_read_bool(ser, "i2c-pass-through-all")) {
+		dev_dbg(dev, "%s: - i2c-pass-through-all enabled\n",
+			__func__);
+		ds90ub953->i2c_pt = 1;
+	} else {
+		/* default value: 0 */
+		ds90ub953->i2c_pt = 0;
+		dev_dbg(dev, "%s: - i2c-pass-through-all disabled\n",
+			__func__);
+	}
+
+	err = of_property_read_u32(ser, "i2c-scl-frequency", &val);
+	if(err) {
+		/* default value: deserializer setting */
+		ds90ub953->i2c_scl_freq = priv->i2c_scl_freq;
+		dev_dbg(dev, "%s: - i2c-scl-frequency set to deserializer val: %i\n",
+			__func__, priv->i2c_scl_freq);
+	} else {
+		ds90ub953->i2c_scl_freq = val;
+		dev_dbg(dev, "%s: - i2c-scl-frequency %i\n", __func__, val);
+	}
+
+	err = of_property_read_u32(ser, "virtual-channel-map", &val);
+	if(err) {
+		dev_dbg(dev, "%s: - virtual-channel-map property not found\n",
+			__func__);
+		ds90ub953->vc_map = 0xE4;
+		dev_dbg(dev, "%s: - virtual-channel-map set to default val: 0xE4\n",
+			__func__);
+	} else {
+		/* set vc_map*/
+		ds90ub953->vc_map = val;
+		dev_dbg(dev, "%s: - virtual-channel-map 0x%x\n", __func__, val);
+	}
+
+	err = of_property_read_u32(ser, "batch-deadline-ms", &val);
+	if(err) {
+		/* default value: 33, one frame at 30 fps */
+		ds90ub953->batch.deadline_ms = 33;
+		dev_dbg(dev, "%s: - batch-deadline-ms set to default val: 33\n",
+			__func__);
+	} else {
+		ds90ub953->batch.deadline_ms = val;
+		dev_dbg(dev, "%s: - batch-deadline-ms %i\n", __func__, val);
+	}
+
+	return 0;
+}
+
+/*
+ * Slave/alias pairs from the i2c-slave and slave-alias phandle lists, NULL if
+ * a list could not be read. The pairs are only used if both lists are there.
+ */
+static void ds90ub953_parse_alias_pairs(struct ds90ub954_priv *priv,
+					struct ds90ub953_priv *ds90ub953,
+					const struct of_phandle_args *slaves,
+					const struct of_phandle_args *aliases)
+{
+	struct device *dev = &priv->client->dev;
+	int i;
+
+	ds90ub953->i2c_alias_num = 0;
+	if(!slaves || !aliases)
+		return;
+
+	ds90ub953->i2c_alias_num = min_t(int, slaves->args_count, NUM_ALIAS);
+	dev_dbg(dev, "%s: - num of slave alias pairs: %i\n", __func__,
+		ds90ub953->i2c_alias_num);
+	for(i = 0; i < ds90ub953->i2c_alias_num; i++) {
+		ds90ub953->i2c_slave[i] = slaves->args[i];
+		ds90ub953->i2c_alias[i] = (i < aliases->args_count) ?
+					  aliases->args[i] : 0;
+		dev_dbg(dev, "%s: - slave addr: 0x%X, alias addr: 0x%X\n",
+			__func__, ds90ub953->i2c_slave[i],
+			ds90ub953->i2c_alias[i]);
+	}
+}
+
+static int ds90ub953_parse_dt(struct i2c_client *client,
+			      struct ds90ub954_priv *priv)
+{
+	struct device *dev = &client->dev;
+	struct device_node *des = dev->of_node;
+	struct device_node *ser;
+	struct device_node *sers;
+	struct of_phandle_args i2c_slaves, i2c_aliases;
+	struct ds90ub953_priv *ds90ub953;
+	int err = 0, err2 = 0;
+	int counter = 0;
+	priv->num_ser = 0;
+
+	/* get serializers device_node from dt */
+	sers = of_get_child_by_name(des, "serializers");
+	if(!sers) {
+		dev_dbg(dev, "%s: no serializers found in device tree\n",
+			__func__);
+		return 0;
+	}
+
+	dev_dbg(dev, "%s: parsing serializers device tree:\n", __func__);
+
+	/* go through all serializers in list */
+	for_each_child_of_node(sers, ser) {
+
+		if(counter >= priv->chip->num_rx_ports) {
+			dev_dbg(dev, "%s: too many serializers found in device tree\n",
+				__func__);
+			of_node_put(ser);
+			break;
+		}
+
+		/* allocate memory for serializer */
+		err = ds90ub953_alloc(priv, counter);
+		if(err) {
+			dev_warn(dev, "%s: - allocating ds90ub953 failed\n",
+				 __func__);
+			goto next;
+		}
+		ds90ub953 = priv->ser[counter];
+		ds90ub953->np = of_node_get(ser);
+
+		err = ds90ub953_parse_dt_ser(priv, ds90ub953, ser);
+		if(err)
+			goto next;
+
+		err = ds90ub953_i2c_client(priv, counter,
+					   ds90ub953->i2c_address);
+		if(err) {
+			dev_warn(dev, "%s: - ds90ub953_i2c_client failed\n",
+				 __func__);
+			goto next;
+		}
+
+		err = ds90ub953_regmap_init(priv, counter);
+		if(err) {
+			dev_warn(dev, "%s: - ds90ub953_regmap_init failed\n",
+				 __func__);
+			goto next;
+		}
+
+		/* get i2c-slave addresses and slave-aliases */
+		err = of_parse_phandle_with_args(ser, "i2c-slave", "list-cells",
+						 0, &i2c_slaves);
+		if(err)
+			dev_warn(dev, "%s: - reading i2c-slave addresses failed\n",
+				 __func__);
+		err2 = of_parse_phandle_with_args(ser, "slave-alias",
+						  "list-cells", 0,
+						  &i2c_aliases);
+		if(err2)
+			dev_warn(dev, "%s: - reading i2c slave-alias addresses failed\n",
+				 __func__);
+		ds90ub953_parse_alias_pairs(priv, ds90ub953,
+					    err ? NULL : &i2c_slaves,
+					    err2 ? NULL : &i2c_aliases);
+		if(!err)
+			of_node_put(i2c_slaves.np);
+		if(!err2)
+			of_node_put(i2c_aliases.np);
+
+		/* frame start signal for the remote write queue */
+		err = ds90ub953_batch_init_irq(ds90ub953);
+		if(err == -EPROBE_DEFER)
+			dev_err(dev, "%s: - frame-start-gpio not ready, ignoring\n",
+				__func__);
+
+		/* all initialization of this serializer complete */
+		ds90ub953->initialized = 1;
+		ds90ub953->configured = 1;
+		dev_dbg(dev, "%s: serializer %i successfully parsed\n", __func__,
+			counter);
+next:
+		counter +=1;
+	}
+	priv->num_ser = counter;
+	of_node_put(sers);
+	dev_dbg(dev, "%s: done\n", __func__);
+	return 0;
+
+}
+
+/*------------------------------------------------------------------------------
+ * GPIO CHIPS
+ *----------------------------------------------------------------------------*/
+
+static int ds90ub954_gpio_get_direction(struct gpio_chip *gc,
+					unsigned int offset)
+{
+	struct ds90ub954_priv *priv = gpiochip_get_data(gc);
+	int val, err;
+
+	err = ds90ub954_read(priv, TI954_REG_GPIO0_PIN_CTL + offset, &val);
+	if(unlikely(err))
+		return err;
+
+	if(val & (1<<TI954_GPIO0_OUT_EN))
+		return GPIO_LINE_DIRECTION_OUT;
+	return GPIO_LINE_DIRECTION_IN;
+}
+
+static int ds90ub954_gpio_direction_input(struct gpio_chip *gc,
+					  unsigned int offset)
+{
+	struct ds90ub954_priv *priv = gpiochip_get_data(gc);
+	int err;
+
+	mutex_lock(&priv->gpio_lock);
+	err = ds90ub954_write(priv, TI954_REG_GPIO0_PIN_CTL + offset, 0);
+	if(unlikely(err))
+		goto direction_err;
+
+	err = ds90ub954_update_bits(priv, TI954_REG_GPIO_INPUT_CTL,
+				    (1<<(TI954_GPIO0_INPUT_EN+offset)),
+				    (1<<(TI954_GPIO0_INPUT_EN+offset)));
+direction_err:
+	mutex_unlock(&priv->gpio_lock);
+	return err;
+}
+
+/* drive the pin with GPIOx_OUT_VAL, a single local register write */
+static int ds90ub954_gpio_write_out(struct ds90ub954_priv *priv,
+				    unsigned int offset, int value)
+{
+	return ds90ub954_write(priv, TI954_REG_GPIO0_PIN_CTL + offset,
+			       (TI954_GPIO_OUT_SEL_VAL<<TI954_GPIO0_OUT_SEL) |
+			       (TI954_GPIO_OUT_SRC_DEV<<TI954_GPIO0_OUT_SRC) |
+			       ((!!value)<<TI954_GPIO0_OUT_VAL) |
+			       (1<<TI954_GPIO0_OUT_EN));
+}
+
+static int ds90ub954_gpio_direction_output(struct gpio_chip *gc,
+					   unsigned int offset, int value)
+{
+	struct ds90ub954_priv *priv = gpiochip_get_data(gc);
+	int err;
+
+	mutex_lock(&priv->gpio_lock);
+	err = ds90ub954_update_bits(priv, TI954_REG_GPIO_INPUT_CTL,
+				    (1<<(TI954_GPIO0_INPUT_EN+offset)), 0);
+	if(unlikely(err))
+		goto direction_err;
+
+	err = ds90ub954_gpio_write_out(priv, offset, value);
+direction_err:
+	mutex_unlock(&priv->gpio_lock);
+	return err;
+}
+
+static int ds90ub954_gpio_get(struct gpio_chip *gc, unsigned int offset)
+{
+	struct ds90ub954_priv *priv = gpiochip_get_data(gc);
+	int val, err;
+
+	err = ds90ub954_read(priv, TI954_REG_GPIO_PIN_STS, &val);
+	if(unlikely(err))
+		return err;
+	return !!(val & (1<<(TI954_GPIO0_STS+offset)));
+}
+
+static void ds90ub954_gpio_set(struct gpio_chip *gc, unsigned int offset,
+			       int value)
+{
+	struct ds90ub954_priv *priv = gpiochip_get_data(gc);
+
+	ds90ub954_gpio_write_out(priv, offset, value);
+}
+
+static int ds90ub954_gpiochip_init(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct gpio_chip *gc = &priv->gpio_chip;
+	int err;
+
+	gc->label = dev_name(dev);
+	gc->parent = dev;
+	gc->owner = THIS_MODULE;
+	gc->base = -1;
+	gc->ngpio = priv->chip->num_gpios;
+	gc->can_sleep = true;
+	gc->get_direction = ds90ub954_gpio_get_direction;
+	gc->direction_input = ds90ub954_gpio_direction_input;
+	gc->direction_output = ds90ub954_gpio_direction_output;
+	gc->get = ds90ub954_gpio_get;
+	gc->set = ds90ub954_gpio_set;
+
+	err = devm_gpiochip_add_data(dev, gc, priv);
+	if(unlikely(err))
+		dev_err(dev, "%s: unable to add gpiochip (%d)\n", __func__, err);
+	return err;
+}
+
+/* BC_GPIO_CTL0 selects the output of GPIO0/1, BC_GPIO_CTL1 of GPIO2/3 */
+static int ds90ub953_gpio_write_bc(struct ds90ub953_priv *priv,
+				   unsigned int offset)
+{
+	unsigned int pair = offset & ~1;
+	int reg = (pair == 0) ? TI954_REG_BC_GPIO_CTL0 : TI954_REG_BC_GPIO_CTL1;
+
+	return ds90ub954_write_rx_port(priv->parent, priv->rx_channel, reg,
+				       (priv->gpio_oc[pair]<<TI954_BC_GPIO0_SEL) |
+				       (priv->gpio_oc[pair+1]<<TI954_BC_GPIO1_SEL));
+}
+
+static int ds90ub953_gpio_get_direction(struct gpio_chip *gc,
+					unsigned int offset)
+{
+	struct ds90ub953_priv *priv = gpiochip_get_data(gc);
+
+	if(priv->gpio_oe[offset])
+		return GPIO_LINE_DIRECTION_OUT;
+	return GPIO_LINE_DIRECTION_IN;
+}
+
+static int ds90ub953_gpio_direction_input(struct gpio_chip *gc,
+					  unsigned int offset)
+{
+	struct ds90ub953_priv *priv = gpiochip_get_data(gc);
+	int val, fc_gpio_en, err = 0;
+
+	mutex_lock(&priv->gpio_lock);
+	if(priv->gpio_oe[offset]) {
+		priv->gpio_oe[offset] = 0;
+		err = ds90ub953_write_gpio_ctrl(priv);
+		if(unlikely(err))
+			goto direction_err;
+	}
+
+	/* forward the input to FC_GPIO_STS of the deserializer,
+	 * FC_GPIO_EN: 1: GPIO0, 2: GPIO0/1, 3: GPIO0..3 */
+	fc_gpio_en = min_t(int, offset + 1, 3);
+	if(fc_gpio_en > priv->fc_gpio_en) {
+		err = ds90ub953_read(priv, TI953_REG_DATAPATH_CTL1, &val);
+		if(unlikely(err))
+			goto direction_err;
+		val &= ~(TI953_FC_GPIO_EN_MASK<<TI953_FC_GPIO_EN);
+		val |= (fc_gpio_en<<TI953_FC_GPIO_EN);
+		err = ds90ub953_write(priv, TI953_REG_DATAPATH_CTL1, val);
+		if(unlikely(err))
+			goto direction_err;
+		priv->fc_gpio_en = fc_gpio_en;
+	}
+direction_err:
+	mutex_unlock(&priv->gpio_lock);
+	return err;
+}
+
+static int ds90ub953_gpio_direction_output(struct gpio_chip *gc,
+					   unsigned int offset, int value)
+{
+	struct ds90ub953_priv *priv = gpiochip_get_data(gc);
+	int err;
+
+	mutex_lock(&priv->gpio_lock);
+	priv->gpio_oc[offset] = value ? TI954_BC_GPIO_SEL_HIGH :
+					TI954_BC_GPIO_SEL_LOW;
+	err = ds90ub953_gpio_write_bc(priv, offset);
+	if(unlikely(err))
+		goto direction_err;
+
+	if(!priv->gpio_oe[offset]) {
+		priv->gpio_oe[offset] = 1;
+		err = ds90ub953_write_gpio_ctrl(priv);
+	}
+direction_err:
+	mutex_unlock(&priv->gpio_lock);
+	return err;
+}
+
+static int ds90ub953_gpio_get(struct gpio_chip *gc, unsigned int offset)
+{
+	struct ds90ub953_priv *priv = gpiochip_get_data(gc);
+	int val, err;
+
+	if(priv->gpio_oe[offset])
+		return priv->gpio_oc[offset] == TI954_BC_GPIO_SEL_HIGH;
+
+	err = ds90ub954_read_rx_port(priv->parent, priv->rx_channel,
+				     TI954_REG_FC_GPIO_STS, &val);
+	if(unlikely(err))
+		return err;
+	return !!(val & (1<<(TI954_FC_GPIO0_STS+offset)));
+}
+
+/* remote outputs are driven by the deserializer over the back channel,
+ * so setting a value is one local register write */
+static void ds90ub953_gpio_set(struct gpio_chip *gc, unsigned int offset,
+			       int value)
+{
+	struct ds90ub953_priv *priv = gpiochip_get_data(gc);
+
+	mutex_lock(&priv->gpio_lock);
+	priv->gpio_oc[offset] = value ? TI954_BC_GPIO_SEL_HIGH :
+					TI954_BC_GPIO_SEL_LOW;
+	ds90ub953_gpio_write_bc(priv, offset);
+	mutex_unlock(&priv->gpio_lock);
+}
+
+static int ds90ub953_gpiochip_init(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->parent->client->dev;
+	struct gpio_chip *gc = &priv->gpio_chip;
+	int err;
+
+	gc->label = devm_kasprintf(dev, GFP_KERNEL, "%s-rx%i", dev_name(dev),
+				   priv->rx_channel);
+	if(!gc->label)
+		return -ENOMEM;
+	gc->parent = dev;
+	gc->fwnode = of_fwnode_handle(priv->np);
+	gc->owner = THIS_MODULE;
+	gc->base = -1;
+	gc->ngpio = TI953_NUM_GPIO;
+	gc->can_sleep = true;
+	gc->get_direction = ds90ub953_gpio_get_direction;
+	gc->direction_input = ds90ub953_gpio_direction_input;
+	gc->direction_output = ds90ub953_gpio_direction_output;
+	gc->get = ds90ub953_gpio_get;
+	gc->set = ds90ub953_gpio_set;
+
+	err = devm_gpiochip_add_data(dev, gc, priv);
+	if(unlikely(err))
+		dev_err(dev, "%s: rx_port %i: unable to add gpiochip (%d)\n",
+			__func__, priv->rx_channel, err);
+	return err;
+}
+
+/*------------------------------------------------------------------------------
+ * DEBUGFS
+ *----------------------------------------------------------------------------*/
+
+static struct ds90ub953_priv *ds90ub954_get_ser(struct ds90ub954_priv *priv,
+						int rx_port)
+{
+	int i;
+
+	for(i = 0; i < priv->num_ser; i++) {
+		if(priv->ser[i] && priv->ser[i]->initialized &&
+		   priv->ser[i]->rx_channel == rx_port)
+			return priv->ser[i];
+	}
+	return NULL;
+}
+
+/* raw transfer to an aliased remote slave, 16 bit register address if needed */
+static int ds90ub954_bench_remote(struct ds90ub954_priv *priv, int alias,
+				  int reg, u8 *buf, int len, int write)
+{
+	struct i2c_msg msg[2];
+	u8 wbuf[2 + BENCH_MAX_BURST];
+	int alen = 0, num, ret;
+
+	if(reg > 0xff)
+		wbuf[alen++] = (reg >> 8) & 0xff;
+	wbuf[alen++] = reg & 0xff;
+
+	msg[0].addr = alias;
+	msg[0].flags = 0;
+	msg[0].buf = wbuf;
+	if(write) {
+		memcpy(wbuf + alen, buf, len);
+		msg[0].len = alen + len;
+		num = 1;
+	} else {
+		msg[0].len = alen;
+		msg[1].addr = alias;
+		msg[1].flags = I2C_M_RD;
+		msg[1].len = len;
+		msg[1].buf = buf;
+		num = 2;
+	}
+
+	ret = i2c_transfer(priv->client->adapter, msg, num);
+	if(ret < 0)
+		return ret;
+	return (ret == num) ? 0 : -EIO;
+}
+
+static int ds90ub954_bench_op(struct ds90ub954_priv *priv,
+			      struct ds90ub953_priv *ser, int alias,
+			      u8 *buf, int write)
+{
+	struct ds90ub954_bench *b = &priv->bench;
+	unsigned int val;
+	int err;
+
+	if(b->target)
+		return ds90ub954_bench_remote(priv, alias, b->reg, buf,
+					      b->burst, write);
+
+	if(b->burst > 1) {
+		if(write)
+			return regmap_bulk_write(ser->regmap, b->reg, buf,
+						 b->burst);
+		return regmap_bulk_read(ser->regmap, b->reg, buf, b->burst);
+	}
+
+	if(write)
+		return ds90ub953_write(ser, b->reg, buf[0]);
+	err = ds90ub953_read(ser, b->reg, &val);
+	buf[0] = val;
+	return err;
+}
+
+static int ds90ub954_bench_cmp(const void *a, const void *b)
+{
+	u32 x = *(const u32 *)a;
+	u32 y = *(const u32 *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Issue b->count transactions to the serializer or an aliased remote slave and
+ * collect latency statistics. Writes restore the register content read at the
+ * start, so the benchmark does not change the device configuration.
+ */
+static int ds90ub954_bench_run(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub954_bench *b = &priv->bench;
+	struct ds90ub953_priv *ser;
+	u8 orig[BENCH_MAX_BURST], buf[BENCH_MAX_BURST];
+	u32 *samples;
+	ktime_t start;
+	u64 ns;
+	int i, write, bucket, alias = 0, err;
+
+	ser = ds90ub954_get_ser(priv, b->port);
+	if(!ser) {
+		dev_err(dev, "%s: no serializer on rx_port %i\n", __func__,
+			b->port);
+		return -ENODEV;
+	}
+
+	if(b->target) {
+		alias = ds90ub954_alias_get(priv, ser, b->target);
+		if(alias < 0)
+			return alias;
+	}
+
+	samples = kvmalloc_array(b->count, sizeof(*samples), GFP_KERNEL);
+	if(!samples)
+		return -ENOMEM;
+
+	err = ds90ub954_bench_op(priv, ser, alias, orig, 0);
+	if(err) {
+		dev_err(dev, "%s: initial read failed (%d)\n", __func__, err);
+		goto bench_err;
+	}
+
+	b->valid = 0;
+	b->ops = 0;
+	b->reads = 0;
+	b->writes = 0;
+	b->errors = 0;
+	b->total_ns = 0;
+	memset(b->hist, 0, sizeof(b->hist));
+
+	for(i = 0; i < b->count; i++) {
+		/* spread the writes evenly over the run */
+		write = ((i + 1) * b->write_pct / 100) !=
+			(i * b->write_pct / 100);
+		if(write)
+			memcpy(buf, orig, b->burst);
+
+		start = ktime_get();
+		err = ds90ub954_bench_op(priv, ser, alias, buf, write);
+		ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		samples[i] = min_t(u64, ns, U32_MAX);
+		b->total_ns += ns;
+		bucket = ilog2(max_t(u32, samples[i] / 1000, 1));
+		b->hist[min(bucket, BENCH_HIST_BUCKETS - 1)]++;
+		if(write)
+			b->writes++;
+		else
+			b->reads++;
+		if(err)
+			b->errors++;
+		b->ops++;
+	}
+
+	sort(samples, b->ops, sizeof(*samples), ds90ub954_bench_cmp, NULL);
+	b->min_ns = samples[0];
+	b->p50_ns = samples[b->ops / 2];
+	b->p99_ns = samples[(b->ops * 99) / 100];
+	b->max_ns = samples[b->ops - 1];
+	b->valid = 1;
+	err = 0;
+
+bench_err:
+	kvfree(samples);
+	return err;
+}
+
+static int ds90ub954_bench_show(struct seq_file *s, void *data)
+{
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_bench *b = &priv->bench;
+	int i;
+
+	mutex_lock(&b->lock);
+	seq_printf(s, "port=%i target=0x%02x reg=0x%02x count=%i burst=%i write=%i\n",
+		   b->port, b->target, b->reg, b->count, b->burst,
+		   b->write_pct);
+	if(!b->valid) {
+		seq_puts(s, "no results\n");
+		goto show_done;
+	}
+
+	seq_printf(s, "ops: %i (reads %i, writes %i), errors: %i\n",
+		   b->ops, b->reads, b->writes, b->errors);
+	seq_printf(s, "transactions/s: %llu\n",
+		   b->total_ns ? div64_u64((u64)b->ops * NSEC_PER_SEC,
+					   b->total_ns) : 0);
+	seq_printf(s, "latency ns: min %u p50 %u p99 %u max %u\n",
+		   b->min_ns, b->p50_ns, b->p99_ns, b->max_ns);
+	seq_puts(s, "histogram:\n");
+	for(i = 0; i < BENCH_HIST_BUCKETS; i++) {
+		if(!b->hist[i])
+			continue;
+		seq_printf(s, "  < %6u us: %u\n", 2U << i, b->hist[i]);
+	}
+
+show_done:
+	mutex_unlock(&b->lock);
+	return 0;
+}
+
+static int ds90ub954_bench_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub954_bench_show, inode->i_private);
+}
+
+/* parameters as key=value pairs, any write starts a new run */
+static ssize_t ds90ub954_bench_write(struct file *file,
+				     const char __user *ubuf, size_t count,
+				     loff_t *ppos)
+{
+	struct seq_file *s = file->private_data;
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_bench *b = &priv->bench;
+	struct ds90ub954_bench cfg;
+	char *kbuf, *cur, *tok, *val;
+	int num, err = 0;
+
+	kbuf = memdup_user_nul(ubuf, count);
+	if(IS_ERR(kbuf))
+		return PTR_ERR(kbuf);
+
+	mutex_lock(&b->lock);
+	cfg = *b;
+	cur = kbuf;
+	while((tok = strsep(&cur, " \t\n")) != NULL) {
+		if(!*tok)
+			continue;
+		val = strchr(tok, '=');
+		if(!val) {
+			err = -EINVAL;
+			goto write_err;
+		}
+		*val++ = '\0';
+		err = kstrtoint(val, 0, &num);
+		if(err)
+			goto write_err;
+
+		if(!strcmp(tok, "port"))
+			cfg.port = num;
+		else if(!strcmp(tok, "target"))
+			cfg.target = num;
+		else if(!strcmp(tok, "reg"))
+			cfg.reg = num;
+		else if(!strcmp(tok, "count"))
+			cfg.count = num;
+		else if(!strcmp(tok, "burst"))
+			cfg.burst = num;
+		else if(!strcmp(tok, "write"))
+			cfg.write_pct = num;
+		else {
+			err = -EINVAL;
+			goto write_err;
+		}
+	}
 
-		/* Serializer GPIO control */
-		err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_BC_GPIO_CTL0,
-				(ds90ub953->gpio0_oc<<TI954_BC_GPIO0_SEL) |
-				(ds90ub953->gpio1_oc<<TI954_BC_GPIO1_SEL));
-		if(err)
-			dev_info(dev, "%s: could not set TI954_REG_BC_GPIO_CTL0\n",
-				 __func__);
-		else
-			dev_info(dev, "%s: Successfully set TI954_REG_BC_GPIO_CTL0\n",
-				 __func__);
+	if(cfg.count < 1 || cfg.count > BENCH_MAX_OPS ||
+	   cfg.burst < 1 || cfg.burst > BENCH_MAX_BURST ||
+	   cfg.write_pct < 0 || cfg.write_pct > 100 ||
+	   cfg.target < 0 || cfg.target > 0x7f ||
+	   cfg.reg < 0 || cfg.reg > 0xffff ||
+	   (!cfg.target && cfg.reg + cfg.burst > 0x100)) {
+		err = -EINVAL;
+		goto write_err;
+	}
 
-		err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_BC_GPIO_CTL1,
-				(ds90ub953->gpio2_oc<<TI954_BC_GPIO2_SEL) |
-				(ds90ub953->gpio3_oc<<TI954_BC_GPIO3_SEL));
-		if(err)
-			dev_info(dev, "%s: could not set TI954_REG_BC_GPIO_CTL1\n",
-				 __func__);
-		else
-			dev_info(dev, "%s: Successfully set TI954_REG_BC_GPIO_CTL1\n",
-				 __func__);
+	b->port = cfg.port;
+	b->target = cfg.target;
+	b->reg = cfg.reg;
+	b->count = cfg.count;
+	b->burst = cfg.burst;
+	b->write_pct = cfg.write_pct;
+	err = ds90ub954_bench_run(priv);
+
+write_err:
+	mutex_unlock(&b->lock);
+	kfree(kbuf);
+	return err ? err : count;
+}
 
-		/* set i2c slave ids and aliases */
-		for(i=0; (i < ds90ub953->i2c_alias_num) && (i < NUM_ALIAS); i++) {
-			val = ds90ub953->i2c_slave[i];
-			if(val == 0) {
-				continue;
-			}
-			err = ds90ub954_write_rx_port(priv, rx_port,
-						      TI954_REG_SLAVE_ID0+i,
-						      (val<<TI954_ALIAS_ID0));
-			if(unlikely(err))
-				goto ser_init_failed;
-			dev_info(dev, "%s: slave id %i: 0x%X\n", __func__, i, val);
+static const struct file_operations ds90ub954_bench_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_bench_open,
+	.read = seq_read,
+	.write = ds90ub954_bench_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
 
-			val = ds90ub953->i2c_alias[i];
-			if(val == 0) {
-				continue;
-			}
-			err = ds90ub954_write_rx_port(priv, rx_port,
-						      TI954_REG_ALIAS_ID0+i,
-						      (val<<TI954_ALIAS_ID0));
-			if(unlikely(err))
-				goto ser_init_failed;
-			dev_info(dev, "%s: alias id %i: 0x%X\n", __func__, i, val);
-		}
+static int ds90ub954_reg_hist_show(struct seq_file *s, void *data)
+{
+	struct ds90ub954_reg_hist *hist = s->private;
+	struct ds90ub954_reg_stat st;
+	unsigned long flags;
+	u32 n;
+	int reg;
+
+	seq_printf(s, "%-4s %8s %8s %6s %12s %8s %8s\n", "reg", "reads",
+		   "writes", "errors", "total us", "avg ns", "max ns");
+	for(reg = 0; reg < REG_HIST_NUM; reg++) {
+		spin_lock_irqsave(&hist->lock, flags);
+		st = hist->stat[reg];
+		spin_unlock_irqrestore(&hist->lock, flags);
+
+		n = st.reads + st.writes;
+		if(!n)
+			continue;
+		seq_printf(s, "0x%02x %8u %8u %6u %12llu %8llu %8u\n", reg,
+			   st.reads, st.writes, st.errors,
+			   div_u64(st.total_ns, 1000), div_u64(st.total_ns, n),
+			   st.max_ns);
+	}
+	return 0;
+}
 
-		/* set virtual channel id mapping */
-		err = ds90ub954_write_rx_port(priv, rx_port,
-					      TI954_REG_CSI_VC_MAP,
-					      ds90ub953->vc_map);
-		if(unlikely(err))
-			goto ser_init_failed;
+static int ds90ub954_reg_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub954_reg_hist_show, inode->i_private);
+}
+
+/* any write resets the histogram */
+static ssize_t ds90ub954_reg_hist_write(struct file *file,
+					const char __user *ubuf, size_t count,
+					loff_t *ppos)
+{
+	struct seq_file *s = file->private_data;
+	struct ds90ub954_reg_hist *hist = s->private;
+	unsigned long flags;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	memset(hist->stat, 0, sizeof(hist->stat));
+	spin_unlock_irqrestore(&hist->lock, flags);
+	return count;
+}
+
+static const struct file_operations ds90ub954_reg_hist_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_reg_hist_open,
+	.read = seq_read,
+	.write = ds90ub954_reg_hist_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static const char * const ds90ub954_target_names[] = {
+	[TARGET_LOCAL] = "local",
+	[TARGET_REMOTE] = "remote",
+};
+
+static int ds90ub954_retry_show(struct seq_file *s, void *data)
+{
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_retry_policy policy[TARGET_NUM];
+	struct ds90ub954_retry_stats st[TARGET_NUM];
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	memcpy(policy, priv->retry.policy, sizeof(policy));
+	memcpy(st, priv->retry.stats, sizeof(st));
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
+
+	seq_printf(s, "%-6s %7s %10s %8s %9s %6s %15s %15s\n", "target",
+		   "retries", "backoff us", "retried", "recovered", "failed",
+		   "avg recovery us", "max recovery us");
+	for(i = 0; i < TARGET_NUM; i++)
+		seq_printf(s, "%-6s %7d %10d %8u %9u %6u %15llu %15u\n",
+			   ds90ub954_target_names[i], policy[i].retries,
+			   policy[i].backoff_us, st[i].retries, st[i].recovered,
+			   st[i].failed,
+			   st[i].recovered ?
+			   div_u64(st[i].recovery_ns, st[i].recovered * 1000) : 0,
+			   st[i].max_recovery_ns / 1000);
+	return 0;
+}
+
+static int ds90ub954_retry_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub954_retry_show, inode->i_private);
+}
+
+/* key=value pairs, e.g. "remote_retries=5 remote_backoff_us=200 reset=1" */
+static ssize_t ds90ub954_retry_write(struct file *file,
+				     const char __user *ubuf, size_t count,
+				     loff_t *ppos)
+{
+	struct seq_file *s = file->private_data;
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_retry_policy policy[TARGET_NUM];
+	char *kbuf, *cur, *tok, *val;
+	unsigned long flags;
+	int num, reset = 0, err = 0;
+	int i;
+
+	kbuf = memdup_user_nul(ubuf, count);
+	if(IS_ERR(kbuf))
+		return PTR_ERR(kbuf);
+
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	memcpy(policy, priv->retry.policy, sizeof(policy));
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
+
+	cur = kbuf;
+	while((tok = strsep(&cur, " \t\n")) != NULL) {
+		if(!*tok)
+			continue;
+		val = strchr(tok, '=');
+		if(!val) {
+			err = -EINVAL;
+			goto write_err;
+		}
+		*val++ = '\0';
+		err = kstrtoint(val, 0, &num);
+		if(err)
+			goto write_err;
+
+		if(!strcmp(tok, "local_retries"))
+			policy[TARGET_LOCAL].retries = num;
+		else if(!strcmp(tok, "local_backoff_us"))
+			policy[TARGET_LOCAL].backoff_us = num;
+		else if(!strcmp(tok, "remote_retries"))
+			policy[TARGET_REMOTE].retries = num;
+		else if(!strcmp(tok, "remote_backoff_us"))
+			policy[TARGET_REMOTE].backoff_us = num;
+		else if(!strcmp(tok, "reset"))
+			reset = num;
 		else {
-			val = ds90ub953->vc_map & 0b11;
-			dev_info(dev, "%s: VC-ID 0 mapped to %i\n", __func__, val);
-			val = ((ds90ub953->vc_map & 0b1100)>>2);
-			dev_info(dev, "%s: VC-ID 1 mapped to %i\n", __func__, val);
-			val = ((ds90ub953->vc_map & 0b110000)>>4);
-			dev_info(dev, "%s: VC-ID 2 mapped to %i\n", __func__, val);
-			val = ((ds90ub953->vc_map & 0b11000000)>>6);
-			dev_info(dev, "%s: VC-ID 3 mapped to %i\n", __func__, val);
+			err = -EINVAL;
+			goto write_err;
 		}
+	}
 
-		/* all rx_port specific registers set for rx_port X */
-		dev_info(dev, "%s: init of deserializer rx_port %i successful\n",
-			 __func__, rx_port);
-		continue;
-ser_init_failed:
-		dev_err(dev, "%s: init deserializer rx_port %i failed\n",
-			__func__, rx_port);
-		dev_err(dev, "%s: deserializer rx_port %i is deactivated\n",
-			__func__, rx_port);
+	for(i = 0; i < TARGET_NUM; i++) {
+		if(policy[i].retries < 0 || policy[i].retries > RETRY_MAX ||
+		   policy[i].backoff_us < 1 ||
+		   policy[i].backoff_us > RETRY_BACKOFF_MAX_US) {
+			err = -EINVAL;
+			goto write_err;
+		}
+	}
 
-		ds90ub953->initialized = 0;
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	memcpy(priv->retry.policy, policy, sizeof(policy));
+	if(reset)
+		memset(priv->retry.stats, 0, sizeof(priv->retry.stats));
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
+
+write_err:
+	kfree(kbuf);
+	return err ? err : count;
+}
+
+static const struct file_operations ds90ub954_retry_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_retry_open,
+	.read = seq_read,
+	.write = ds90ub954_retry_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+#ifdef CONFIG_VIDEO_DS90UB954_FAULT_INJECTION
+static int ds90ub954_fault_show(struct seq_file *s, void *data)
+{
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_fault f;
+	unsigned long flags;
+
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	f = priv->retry.fault;
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
+
+	seq_printf(s, "targets=0x%x nak=%d timeout=%d timeout_us=%d corrupt=%d times=%d\n",
+		   f.targets, f.nak_pct, f.timeout_pct, f.timeout_us,
+		   f.corrupt_pct, f.times);
+	seq_printf(s, "injected: %u\n", f.injected);
+	return 0;
+}
+
+static int ds90ub954_fault_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub954_fault_show, inode->i_private);
+}
 
-		/* DISABLE RX PORT */
-		err = ds90ub954_read(priv, TI954_REG_RX_PORT_CTL, &val);
+/* key=value pairs, e.g. "targets=2 nak=10 times=100", targets=0 disables */
+static ssize_t ds90ub954_fault_write(struct file *file,
+				     const char __user *ubuf, size_t count,
+				     loff_t *ppos)
+{
+	struct seq_file *s = file->private_data;
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_fault cfg;
+	char *kbuf, *cur, *tok, *val;
+	unsigned long flags;
+	int num, err = 0;
+
+	kbuf = memdup_user_nul(ubuf, count);
+	if(IS_ERR(kbuf))
+		return PTR_ERR(kbuf);
+
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	cfg = priv->retry.fault;
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
+
+	cur = kbuf;
+	while((tok = strsep(&cur, " \t\n")) != NULL) {
+		if(!*tok)
+			continue;
+		val = strchr(tok, '=');
+		if(!val) {
+			err = -EINVAL;
+			goto write_err;
+		}
+		*val++ = '\0';
+		err = kstrtoint(val, 0, &num);
 		if(err)
+			goto write_err;
+
+		if(!strcmp(tok, "targets"))
+			cfg.targets = num;
+		else if(!strcmp(tok, "nak"))
+			cfg.nak_pct = num;
+		else if(!strcmp(tok, "timeout"))
+			cfg.timeout_pct = num;
+		else if(!strcmp(tok, "timeout_us"))
+			cfg.timeout_us = num;
+		else if(!strcmp(tok, "corrupt"))
+			cfg.corrupt_pct = num;
+		else if(!strcmp(tok, "times"))
+			cfg.times = num;
+		else {
+			err = -EINVAL;
+			goto write_err;
+		}
+	}
+
+	if(cfg.targets & ~(BIT(TARGET_NUM) - 1) ||
+	   cfg.nak_pct < 0 || cfg.nak_pct > 100 ||
+	   cfg.timeout_pct < 0 || cfg.timeout_pct > 100 ||
+	   cfg.corrupt_pct < 0 || cfg.corrupt_pct > 100 ||
+	   cfg.timeout_us < 0 || cfg.timeout_us > RETRY_BACKOFF_MAX_US ||
+	   cfg.times < -1) {
+		err = -EINVAL;
+		goto write_err;
+	}
+
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	cfg.injected = 0;
+	priv->retry.fault = cfg;
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
+
+write_err:
+	kfree(kbuf);
+	return err ? err : count;
+}
+
+static const struct file_operations ds90ub954_fault_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_fault_open,
+	.read = seq_read,
+	.write = ds90ub954_fault_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+#endif
+
+static void ds90ub954_pgen_show_cfg(struct seq_file *s,
+				    const struct ds90ub954_pgen *cfg,
+				    int enable, u64 csi_kbps)
+{
+	struct ds90ub954_pgen_timing t;
+	int i, err;
+
+	seq_printf(s, "enable=%d width=%d height=%d dt=0x%02x vc=%d fps=%d kbps=%d line_pd=%d tot_lpf=%d vbp=%d vfp=%d bars=%d fixed=%d\n",
+		   enable, cfg->width, cfg->height, cfg->dt, cfg->vc,
+		   cfg->fps, cfg->kbps, cfg->line_pd, cfg->tot_lpf, cfg->vbp,
+		   cfg->vfp, cfg->num_bars, cfg->fixed);
+	seq_puts(s, "colors:");
+	for(i = 0; i < TI954_PGEN_NUM_COLORS; i++)
+		seq_printf(s, " %02x", cfg->color[i]);
+	seq_puts(s, "\n");
+
+	err = ds90ub954_pgen_calc(cfg, csi_kbps, &t);
+	if(err) {
+		seq_printf(s, "invalid config (%d)\n", err);
+		return;
+	}
+	seq_printf(s, "line_size=%d bar_size=%d act_lpf=%d tot_lpf=%d line_pd=%d (%d ns)\n",
+		   t.line_size, t.bar_size, cfg->height, t.tot_lpf, t.line_pd,
+		   t.line_pd * 10);
+	seq_printf(s, "frame rate %u.%03u fps, payload %llu kbit/s, csi-2 %llu kbit/s\n",
+		   t.fps_milli / 1000, t.fps_milli % 1000, t.kbps, csi_kbps);
+}
+
+/*
+ * One key=value of a pattern generator config, -ENOENT for other keys. fps
+ * and kbps clear a line_pd given before, height and the porches a tot_lpf.
+ */
+static int ds90ub954_pgen_parse(struct ds90ub954_pgen *cfg, const char *key,
+				int num)
+{
+	unsigned int color;
+
+	if(!strcmp(key, "width"))
+		cfg->width = num;
+	else if(!strcmp(key, "height")) {
+		cfg->height = num;
+		cfg->tot_lpf = 0;
+	} else if(!strcmp(key, "dt"))
+		cfg->dt = num;
+	else if(!strcmp(key, "vc"))
+		cfg->vc = num;
+	else if(!strcmp(key, "fps")) {
+		cfg->fps = num;
+		cfg->line_pd = 0;
+	} else if(!strcmp(key, "kbps")) {
+		cfg->kbps = num;
+		cfg->line_pd = 0;
+	} else if(!strcmp(key, "line_pd"))
+		cfg->line_pd = num;
+	else if(!strcmp(key, "tot_lpf"))
+		cfg->tot_lpf = num;
+	else if(!strcmp(key, "vbp")) {
+		cfg->vbp = num;
+		cfg->tot_lpf = 0;
+	} else if(!strcmp(key, "vfp")) {
+		cfg->vfp = num;
+		cfg->tot_lpf = 0;
+	} else if(!strcmp(key, "bars"))
+		cfg->num_bars = num;
+	else if(!strcmp(key, "fixed"))
+		cfg->fixed = !!num;
+	else if(sscanf(key, "color%u", &color) == 1 &&
+		color < TI954_PGEN_NUM_COLORS) {
+		if(num < 0 || num > 0xff)
+			return -EINVAL;
+		cfg->color[color] = num;
+	} else
+		return -ENOENT;
+	return 0;
+}
+
+static int ds90ub954_pgen_show(struct seq_file *s, void *data)
+{
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_pgen cfg;
+
+	mutex_lock(&priv->reg_lock);
+	cfg = priv->pgen;
+	mutex_unlock(&priv->reg_lock);
+
+	ds90ub954_pgen_show_cfg(s, &cfg, priv->test_pattern,
+				ds90ub954_csi_kbps(priv));
+	return 0;
+}
+
+static int ds90ub954_pgen_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub954_pgen_show, inode->i_private);
+}
+
+/* key=value pairs, e.g. "width=1920 height=1080 dt=0x1e kbps=800000 enable=1" */
+static ssize_t ds90ub954_pgen_write(struct file *file,
+				    const char __user *ubuf, size_t count,
+				    loff_t *ppos)
+{
+	struct seq_file *s = file->private_data;
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_pgen_timing t;
+	struct ds90ub954_pgen cfg;
+	char *kbuf, *cur, *tok, *val;
+	int num, enable = -1, err = 0;
+
+	kbuf = memdup_user_nul(ubuf, count);
+	if(IS_ERR(kbuf))
+		return PTR_ERR(kbuf);
+
+	mutex_lock(&priv->reg_lock);
+	cfg = priv->pgen;
+	mutex_unlock(&priv->reg_lock);
+
+	cur = kbuf;
+	while((tok = strsep(&cur, " \t\n")) != NULL) {
+		if(!*tok)
 			continue;
-		val &= (0xFF^(1<<(TI954_PORT0_EN+rx_port)));
-		err = ds90ub954_write(priv, TI954_REG_RX_PORT_CTL, val);
+		val = strchr(tok, '=');
+		if(!val) {
+			err = -EINVAL;
+			goto write_err;
+		}
+		*val++ = '\0';
+		err = kstrtoint(val, 0, &num);
 		if(err)
+			goto write_err;
+
+		if(!strcmp(tok, "enable")) {
+			enable = num;
 			continue;
-		/* DISABLE CSI FORWARDING */
-		err = ds90ub954_read(priv, TI954_REG_FWD_CTL1, &val);
+		}
+		err = ds90ub954_pgen_parse(&cfg, tok, num);
+		if(err) {
+			err = -EINVAL;
+			goto write_err;
+		}
+	}
+
+	err = ds90ub954_pgen_calc(&cfg, ds90ub954_csi_kbps(priv), &t);
+	if(err)
+		goto write_err;
+
+	mutex_lock(&priv->reg_lock);
+	priv->pgen = cfg;
+	mutex_unlock(&priv->reg_lock);
+
+	if(enable > 0 || (enable < 0 && priv->test_pattern == 1)) {
+		priv->test_pattern = 1;
+		err = ds90ub954_init_testpattern(priv);
+	} else if(enable == 0) {
+		priv->test_pattern = 0;
+		err = ds90ub954_disable_testpattern(priv);
+	}
+
+write_err:
+	kfree(kbuf);
+	return err ? err : count;
+}
+
+static const struct file_operations ds90ub954_pgen_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_pgen_open,
+	.read = seq_read,
+	.write = ds90ub954_pgen_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int ds90ub953_pgen_show(struct seq_file *s, void *data)
+{
+	struct ds90ub953_priv *priv = s->private;
+	struct ds90ub953_pgen_result res;
+	struct ds90ub954_pgen cfg;
+	int enable;
+
+	mutex_lock(&priv->lock);
+	cfg = priv->pgen;
+	res = priv->pgen_result;
+	enable = priv->test_pattern;
+	mutex_unlock(&priv->lock);
+
+	ds90ub954_pgen_show_cfg(s, &cfg, enable,
+				ds90ub954_csi_kbps(priv->parent));
+	if(!res.valid)
+		return 0;
+	seq_printf(s, "test: %s after %d ms, %llu kbit/s\n",
+		   res.pass ? "pass" : "fail", res.duration_ms, res.kbps);
+	seq_printf(s, "line count %d (expected %d), line length %d (expected %d)\n",
+		   res.line_count, res.exp_line_count, res.line_len,
+		   res.exp_line_len);
+	seq_printf(s, "csi errors %d, CSI_RX_STS 0x%02x, RX_PORT_STS2 0x%02x\n",
+		   res.csi_errors, res.csi_rx_sts, res.port_sts2);
+	return 0;
+}
+
+static int ds90ub953_pgen_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub953_pgen_show, inode->i_private);
+}
+
+/* pattern generator keys of the deserializer, enable=0/1 and test=<ms> */
+static ssize_t ds90ub953_pgen_write(struct file *file,
+				    const char __user *ubuf, size_t count,
+				    loff_t *ppos)
+{
+	struct seq_file *s = file->private_data;
+	struct ds90ub953_priv *priv = s->private;
+	struct ds90ub954_pgen_timing t;
+	struct ds90ub954_pgen cfg;
+	char *kbuf, *cur, *tok, *val;
+	int num, enable = -1, test_ms = 0, err = 0;
+
+	kbuf = memdup_user_nul(ubuf, count);
+	if(IS_ERR(kbuf))
+		return PTR_ERR(kbuf);
+
+	mutex_lock(&priv->lock);
+	cfg = priv->pgen;
+
+	cur = kbuf;
+	while((tok = strsep(&cur, " \t\n")) != NULL) {
+		if(!*tok)
+			continue;
+		val = strchr(tok, '=');
+		if(!val) {
+			err = -EINVAL;
+			goto write_err;
+		}
+		*val++ = '\0';
+		err = kstrtoint(val, 0, &num);
 		if(err)
+			goto write_err;
+
+		if(!strcmp(tok, "enable")) {
+			enable = num;
+			continue;
+		}
+		if(!strcmp(tok, "test")) {
+			test_ms = num;
+			continue;
+		}
+		err = ds90ub954_pgen_parse(&cfg, tok, num);
+		if(err) {
+			err = -EINVAL;
+			goto write_err;
+		}
+	}
+
+	err = ds90ub954_pgen_calc(&cfg, ds90ub954_csi_kbps(priv->parent), &t);
+	if(err || test_ms < 0 || test_ms > 60000) {
+		err = err ? err : -EINVAL;
+		goto write_err;
+	}
+	priv->pgen = cfg;
+
+	if(!priv->initialized) {
+		err = -ENODEV;
+		goto write_err;
+	}
+	if(enable > 0 || (enable < 0 && priv->test_pattern == 1)) {
+		priv->test_pattern = 1;
+		err = ds90ub953_init_testpattern(priv);
+	} else if(enable == 0) {
+		priv->test_pattern = 0;
+		err = ds90ub953_disable_testpattern(priv);
+	}
+	if(!err && test_ms)
+		err = ds90ub953_pgen_test(priv, test_ms);
+
+write_err:
+	mutex_unlock(&priv->lock);
+	kfree(kbuf);
+	return err ? err : count;
+}
+
+static const struct file_operations ds90ub953_pgen_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub953_pgen_open,
+	.read = seq_read,
+	.write = ds90ub953_pgen_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+/*
+ * Register dumps read the maps with bulk reads under the device lock (and the
+ * port state lock for a serializer). Registers that are cleared on read or
+ * have side effects are not read and shown as "--".
+ */
+
+static const char * const ds90ub954_reg_names[256] = {
+	[TI954_REG_I2C_DEV_ID] = "I2C_DEV_ID",
+	[TI954_REG_RESET] = "RESET",
+	[TI954_REG_GENERAL_CFG] = "GENERAL_CFG",
+	[TI954_REG_REVISION] = "REVISION",
+	[TI954_REG_DEVICE_STS] = "DEVICE_STS",
+	[TI954_REG_PAR_ERR_THOLD_HI] = "PAR_ERR_THOLD_HI",
+	[TI954_REG_PAR_ERR_THOLD_LO] = "PAR_ERR_THOLD_LO",
+	[TI954_REG_BCC_WD_CTL] = "BCC_WD_CTL",
+	[TI954_REG_I2C_CTL1] = "I2C_CTL1",
+	[TI954_REG_I2C_CTL2] = "I2C_CTL2",
+	[TI954_REG_SCL_HIGH_TIME] = "SCL_HIGH_TIME",
+	[TI954_REG_SCL_LOW_TIME] = "SCL_LOW_TIME",
+	[TI954_REG_RX_PORT_CTL] = "RX_PORT_CTL",
+	[TI954_REG_IO_CTL] = "IO_CTL",
+	[TI954_REG_GPIO_PIN_STS] = "GPIO_PIN_STS",
+	[TI954_REG_GPIO_INPUT_CTL] = "GPIO_INPUT_CTL",
+	[TI954_REG_GPIO0_PIN_CTL] = "GPIO0_PIN_CTL",
+	[TI954_REG_GPIO1_PIN_CTL] = "GPIO1_PIN_CTL",
+	[TI954_REG_GPIO2_PIN_CTL] = "GPIO2_PIN_CTL",
+	[TI954_REG_GPIO3_PIN_CTL] = "GPIO3_PIN_CTL",
+	[TI954_REG_GPIO4_PIN_CTL] = "GPIO4_PIN_CTL",
+	[TI954_REG_GPIO5_PIN_CTL] = "GPIO5_PIN_CTL",
+	[TI954_REG_GPIO6_PIN_CTL] = "GPIO6_PIN_CTL",
+	[TI954_REG_FS_CTL] = "FS_CTL",
+	[TI954_REG_FS_HIGH_TIME_1] = "FS_HIGH_TIME_1",
+	[TI954_REG_FS_HIGH_TIME_0] = "FS_HIGH_TIME_0",
+	[TI954_REG_FS_LOW_TIME_1] = "FS_LOW_TIME_1",
+	[TI954_REG_FS_LOW_TIME_0] = "FS_LOW_TIME_0",
+	[TI954_REG_MAX_FRM_HI] = "MAX_FRM_HI",
+	[TI954_REG_MAX_FRM_LO] = "MAX_FRM_LO",
+	[TI954_REG_CSI_PLL_CTL] = "CSI_PLL_CTL",
+	[TI954_REG_FWD_CTL1] = "FWD_CTL1",
+	[TI954_REG_FWD_STS] = "FWD_STS",
+	[TI954_REG_INTERRUPT_CTL] = "INTERRUPT_CTL",
+	[TI954_REG_INTERRUPT_STS] = "INTERRUPT_STS",
+	[TI954_REG_TS_CONFIG] = "TS_CONFIG",
+	[TI954_REG_TS_CONTROL] = "TS_CONTROL",
+	[TI954_REG_TS_LINE_LO] = "TS_LINE_LO",
+	[TI954_REG_TS_STATUS] = "TS_STATUS",
+	[TI954_REG_TIMESTAMP_P1_LO] = "TIMESTAMP_P1_LO",
+	[TI954_REG_CSI_CTL] = "CSI_CTL",
+	[TI954_REG_CSI_CTL2] = "CSI_CTL2",
+	[TI954_REG_CSI_STS] = "CSI_STS",
+	[TI954_REG_CSI_TX_ICR] = "CSI_TX_ICR",
+	[TI954_REG_CSI_TX_ISR] = "CSI_TX_ISR",
+	[TI954_REG_CSI_TEST_CTL] = "CSI_TEST_CTL",
+	[TI954_REG_CSI_TEST_PATT_HI] = "CSI_TEST_PATT_HI",
+	[TI954_REG_CSI_TEST_PATT_LO] = "CSI_TEST_PATT_LO",
+	[TI954_REG_SFILTER_CFG] = "SFILTER_CFG",
+	[TI954_REG_AEQ_CTL1] = "AEQ_CTL1",
+	[TI954_REG_AEQ_ERR_THOLD] = "AEQ_ERR_THOLD",
+	[TI954_REG_BCC_STATUS] = "BCC_STATUS",
+	[TI954_REG_FPD3_CAP] = "FPD3_CAP",
+	[TI954_REG_RAQ_EMBED_DTYPE] = "RAQ_EMBED_DTYPE",
+	[TI954_REG_FPD3_PORT_SEL] = "FPD3_PORT_SEL",
+	[TI954_REG_RX_PORT_STS1] = "RX_PORT_STS1",
+	[TI954_REG_RX_PORT_STS2] = "RX_PORT_STS2",
+	[TI954_REG_RX_FREQ_HIGH] = "RX_FREQ_HIGH",
+	[TI954_REG_RX_FERQ_LOQ] = "RX_FERQ_LOQ",
+	[TI954_REG_SENSOR_STS_0] = "SENSOR_STS_0",
+	[TI954_REG_SENSOR_STS_1] = "SENSOR_STS_1",
+	[TI954_REG_SENSOR_STS_2] = "SENSOR_STS_2",
+	[TI954_REG_SENSOR_ST_3] = "SENSOR_ST_3",
+	[TI954_REG_RX_PAR_ERR_HI] = "RX_PAR_ERR_HI",
+	[TI954_REG_RX_PAR_ERR_LO] = "RX_PAR_ERR_LO",
+	[TI954_REG_BIST_ERR_COUNT] = "BIST_ERR_COUNT",
+	[TI954_REG_BCC_CONFIG] = "BCC_CONFIG",
+	[TI954_REG_DATAPATH_CTL1] = "DATAPATH_CTL1",
+	[TI954_REG_SER_ID] = "SER_ID",
+	[TI954_REG_SER_ALIAS_ID] = "SER_ALIAS_ID",
+	[TI954_REG_SLAVE_ID0] = "SLAVE_ID0",
+	[TI954_REG_SLAVE_ID1] = "SLAVE_ID1",
+	[TI954_REG_SLAVE_ID2] = "SLAVE_ID2",
+	[TI954_REG_SLAVE_ID3] = "SLAVE_ID3",
+	[TI954_REG_SLAVE_ID4] = "SLAVE_ID4",
+	[TI954_REG_SLAVE_ID5] = "SLAVE_ID5",
+	[TI954_REG_SLAVE_ID6] = "SLAVE_ID6",
+	[TI954_REG_SLAVE_ID7] = "SLAVE_ID7",
+	[TI954_REG_ALIAS_ID0] = "ALIAS_ID0",
+	[TI954_REG_ALIAS_ID1] = "ALIAS_ID1",
+	[TI954_REG_ALIAS_ID2] = "ALIAS_ID2",
+	[TI954_REG_ALIAS_ID3] = "ALIAS_ID3",
+	[TI954_REG_ALIAS_ID4] = "ALIAS_ID4",
+	[TI954_REG_ALIAS_ID5] = "ALIAS_ID5",
+	[TI954_REG_ALIAS_ID6] = "ALIAS_ID6",
+	[TI954_REG_ALIAS_ID7] = "ALIAS_ID7",
+	[TI954_REG_PORT_CONFIG] = "PORT_CONFIG",
+	[TI954_REG_BC_GPIO_CTL0] = "BC_GPIO_CTL0",
+	[TI954_REG_BC_GPIO_CTL1] = "BC_GPIO_CTL1",
+	[TI954_REG_RAW10_ID] = "RAW10_ID",
+	[TI954_REG_RAW12_ID] = "RAW12_ID",
+	[TI954_REG_CSI_VC_MAP] = "CSI_VC_MAP",
+	[TI954_REG_LINE_COUNT_HI] = "LINE_COUNT_HI",
+	[TI954_REG_LINE_COUNT_LO] = "LINE_COUNT_LO",
+	[TI954_REG_LINE_LEN_1] = "LINE_LEN_1",
+	[TI954_REG_LINE_LEN_0] = "LINE_LEN_0",
+	[TI954_REG_FREQ_DET_CTL] = "FREQ_DET_CTL",
+	[TI954_REG_MAILBOX_1] = "MAILBOX_1",
+	[TI954_REG_MAILBOX_2] = "MAILBOX_2",
+	[TI954_REG_CSI_RX_STS] = "CSI_RX_STS",
+	[TI954_REG_CSI_ERR_COUNTER] = "CSI_ERR_COUNTER",
+	[TI954_REG_PORT_CONFIG2] = "PORT_CONFIG2",
+	[TI954_REG_PORT_PASS_CTL] = "PORT_PASS_CTL",
+	[TI954_REG_SEN_INT_RISE_CTL] = "SEN_INT_RISE_CTL",
+	[TI954_REG_SEN_INT_FALL_CTL] = "SEN_INT_FALL_CTL",
+	[TI954_REG_REFCLK_FREQ] = "REFCLK_FREQ",
+	[TI954_REG_IND_ACC_CTL] = "IND_ACC_CTL",
+	[TI954_REG_IND_ACC_ADDR] = "IND_ACC_ADDR",
+	[TI954_REG_IND_ACC_DATA] = "IND_ACC_DATA",
+	[TI954_REG_BIST_CONTROL] = "BIST_CONTROL",
+	[TI954_REG_MODE_IDX_STS] = "MODE_IDX_STS",
+	[TI954_REG_LINK_ERROR_COUNT] = "LINK_ERROR_COUNT",
+	[TI954_REG_FPD3_ENC_CTL] = "FPD3_ENC_CTL",
+	[TI954_REG_FV_MIN_TIME] = "FV_MIN_TIME",
+	[TI954_REG_GPIO_PD_CTL] = "GPIO_PD_CTL",
+	[TI954_REG_PORT_DEBUG] = "PORT_DEBUG",
+	[TI954_REG_AEQ_CTL2] = "AEQ_CTL2",
+	[TI954_REG_AEQ_STATUS] = "AEQ_STATUS",
+	[TI954_REG_ADAPTIVE_EQ_BYPASS] = "ADAPTIVE_EQ_BYPASS",
+	[TI954_REG_AEQ_MIN_MAX] = "AEQ_MIN_MAX",
+	[TI954_REG_PRT_ICR_HI] = "PRT_ICR_HI",
+	[TI954_REG_PORT_ICR_LO] = "PORT_ICR_LO",
+	[TI954_REG_PORT_ISR_HI] = "PORT_ISR_HI",
+	[TI954_REG_PORT_ISR_LO] = "PORT_ISR_LO",
+	[TI954_REG_FC_GPIO_STS] = "FC_GPIO_STS",
+	[TI954_REG_FC_GPIO_ICR] = "FC_GPIO_ICR",
+	[TI954_REG_SEN_INT_RISE_STS] = "SEN_INT_RISE_STS",
+	[TI954_REG_SEN_INT_FALL_STS] = "SEN_INT_FALL_STS",
+	[TI954_REG_FPD3_RX_ID0] = "FPD3_RX_ID0",
+	[TI954_REG_FPD3_RX_ID1] = "FPD3_RX_ID1",
+	[TI954_REG_FPD3_RX_ID2] = "FPD3_RX_ID2",
+	[TI954_REG_FPD3_RX_ID3] = "FPD3_RX_ID3",
+	[TI954_REG_FPD3_RX_ID4] = "FPD3_RX_ID4",
+	[TI954_REG_FPD3_RX_ID5] = "FPD3_RX_ID5",
+	[TI954_REG_I2C_RX0_ID] = "I2C_RX0_ID",
+	[TI954_REG_I2C_RX1_ID] = "I2C_RX1_ID",
+};
+
+static const char * const ds90ub954_ia_pgen_names[256] = {
+	[TI954_REG_IA_PGEN_CTL] = "PGEN_CTL",
+	[TI954_REG_IA_PGEB_CFG] = "PGEB_CFG",
+	[TI954_REG_IA_PGEN_CSI_DI] = "PGEN_CSI_DI",
+	[TI954_REG_IA_PGEN_LINE_SIZE1] = "PGEN_LINE_SIZE1",
+	[TI954_REG_IA_PGEN_LINE_SIZE0] = "PGEN_LINE_SIZE0",
+	[TI954_REG_IA_PGEN_BAR_SIZE1] = "PGEN_BAR_SIZE1",
+	[TI954_REG_IA_PGEN_BAR_SIZE0] = "PGEN_BAR_SIZE0",
+	[TI954_REG_IA_PGEN_ACT_LPF1] = "PGEN_ACT_LPF1",
+	[TI954_REG_IA_PGEN_ACT_LPF0] = "PGEN_ACT_LPF0",
+	[TI954_REG_IA_PGEN_TOT_LPF1] = "PGEN_TOT_LPF1",
+	[TI954_REG_IA_PGEN_TOT_LPF0] = "PGEN_TOT_LPF0",
+	[TI954_REG_IA_PGEN_LINE_PD1] = "PGEN_LINE_PD1",
+	[TI954_REG_IA_PGEN_LINE_PD0] = "PGEN_LINE_PD0",
+	[TI954_REG_IA_PGEN_VBP] = "PGEN_VBP",
+	[TI954_REG_IA_PGEN_VFP] = "PGEN_VFP",
+	[TI954_REG_IA_PGEN_COLOR0] = "PGEN_COLOR0",
+	[TI954_REG_IA_PGEN_COLOR1] = "PGEN_COLOR1",
+	[TI954_REG_IA_PGEN_COLOR2] = "PGEN_COLOR2",
+	[TI954_REG_IA_PGEN_COLOR3] = "PGEN_COLOR3",
+	[TI954_REG_IA_PGEN_COLOR4] = "PGEN_COLOR4",
+	[TI954_REG_IA_PGEN_COLOR5] = "PGEN_COLOR5",
+	[TI954_REG_IA_PGEN_COLOR6] = "PGEN_COLOR6",
+	[TI954_REG_IA_PGEN_COLOR7] = "PGEN_COLOR7",
+	[TI954_REG_IA_PGEN_COLOR8] = "PGEN_COLOR8",
+	[TI954_REG_IA_PGEN_COLOR9] = "PGEN_COLOR9",
+	[TI954_REG_IA_PGEN_COLOR10] = "PGEN_COLOR10",
+	[TI954_REG_IA_PGEN_COLOR11] = "PGEN_COLOR11",
+	[TI954_REG_IA_PGEN_COLOR12] = "PGEN_COLOR12",
+	[TI954_REG_IA_PGEN_COLOR13] = "PGEN_COLOR13",
+	[TI954_REG_IA_PGEN_COLOR14] = "PGEN_COLOR14",
+	[TI954_REG_IA_CSI0_TCK_PREP] = "CSI0_TCK_PREP",
+	[TI954_REG_IA_CSI0_TCK_ZERO] = "CSI0_TCK_ZERO",
+	[TI954_REG_IA_CSI0_TCK_TRAIL] = "CSI0_TCK_TRAIL",
+	[TI954_REG_IA_CSI0_TCK_POST] = "CSI0_TCK_POST",
+	[TI954_REG_IA_CSI0_THS_PREP] = "CSI0_THS_PREP",
+	[TI954_REG_IA_CSI0_THS_ZERO] = "CSI0_THS_ZERO",
+	[TI954_REG_IA_CSI0_THS_TRAIL] = "CSI0_THS_TRAIL",
+	[TI954_REG_IA_CSI0_THS_EXIT] = "CSI0_THS_EXIT",
+	[TI954_REG_IA_CSI0_TPLX] = "CSI0_TPLX",
+};
+
+static const char * const ds90ub953_reg_names[256] = {
+	[TI953_REG_I2C_DEV_ID] = "I2C_DEV_ID",
+	[TI953_REG_RESET] = "RESET",
+	[TI953_REG_GENERAL_CFG] = "GENERAL_CFG",
+	[TI953_REG_MODE_SEL] = "MODE_SEL",
+	[TI953_REG_BC_MODE_SELECT] = "BC_MODE_SELECT",
+	[TI953_REG_PLLCLK_CTL] = "PLLCLK_CTL",
+	[TI953_REG_CLKOUT_CTRL0] = "CLKOUT_CTRL0",
+	[TI953_REG_CLKOUT_CTRL1] = "CLKOUT_CTRL1",
+	[TI953_REG_BBC_WATCHDOG] = "BBC_WATCHDOG",
+	[TI953_REG_I2C_CONTROL1] = "I2C_CONTROL1",
+	[TI953_REG_I2C_CONTROL2] = "I2C_CONTROL2",
+	[TI953_REG_SCL_HIGH_TIME] = "SCL_HIGH_TIME",
+	[TI953_REG_SCL_LOW_TIME] = "SCL_LOW_TIME",
+	[TI953_REG_LOCAL_GPIO_DATA] = "LOCAL_GPIO_DATA",
+	[TI953_REG_GPIO_CTRL] = "GPIO_CTRL",
+	[TI953_REG_DVP_CFG] = "DVP_CFG",
+	[TI953_REG_DVP_DT] = "DVP_DT",
+	[TI953_REG_FORCE_BIST_EN] = "FORCE_BIST_EN",
+	[TI953_REG_REMOTE_BIST_CTRL] = "REMOTE_BIST_CTRL",
+	[TI953_REG_SENSOR_VGAIN] = "SENSOR_VGAIN",
+	[TI953_REG_SENSOR_CTRL0] = "SENSOR_CTRL0",
+	[TI953_REG_SENSOR_CTRL1] = "SENSOR_CTRL1",
+	[TI953_REG_SENSOR_V0_THRESH] = "SENSOR_V0_THRESH",
+	[TI953_REG_SENSOR_V1_THRESH] = "SENSOR_V1_THRESH",
+	[TI953_REG_SENSOR_T_THRESH] = "SENSOR_T_THRESH",
+	[TI953_REG_ALARM_CSI_EN] = "ALARM_CSI_EN",
+	[TI953_REG_SENSE_EN] = "SENSE_EN",
+	[TI953_REG_ALARM_BC_EN] = "ALARM_BC_EN",
+	[TI953_REG_CSI_POL_SEL] = "CSI_POL_SEL",
+	[TI953_REG_CSI_LP_POLARITY] = "CSI_LP_POLARITY",
+	[TI953_REG_CSI_EN_RXTERM] = "CSI_EN_RXTERM",
+	[TI953_REG_CSI_PKT_HDR_TINT_CTRL] = "CSI_PKT_HDR_TINT_CTRL",
+	[TI953_REG_BCC_CONFIG] = "BCC_CONFIG",
+	[TI953_REG_DATAPATH_CTL1] = "DATAPATH_CTL1",
+	[TI953_REG_DES_PAR_CAP1] = "DES_PAR_CAP1",
+	[TI953_REG_DES_ID] = "DES_ID",
+	[TI953_REG_SLAVE_ID_0] = "SLAVE_ID_0",
+	[TI953_REG_SLAVE_ID_1] = "SLAVE_ID_1",
+	[TI953_REG_SLAVE_ID_2] = "SLAVE_ID_2",
+	[TI953_REG_SLAVE_ID_3] = "SLAVE_ID_3",
+	[TI953_REG_SLAVE_ID_4] = "SLAVE_ID_4",
+	[TI953_REG_SLAVE_ID_5] = "SLAVE_ID_5",
+	[TI953_REG_SLAVE_ID_6] = "SLAVE_ID_6",
+	[TI953_REG_SLAVE_ID_7] = "SLAVE_ID_7",
+	[TI953_REG_SLAVE_ID_ALIAS_0] = "SLAVE_ID_ALIAS_0",
+	[TI953_REG_SLAVE_ID_ALIAS_1] = "SLAVE_ID_ALIAS_1",
+	[TI953_REG_SLAVE_ID_ALIAS_2] = "SLAVE_ID_ALIAS_2",
+	[TI953_REG_SLAVE_ID_ALIAS_3] = "SLAVE_ID_ALIAS_3",
+	[TI953_REG_SLAVE_ID_ALIAS_4] = "SLAVE_ID_ALIAS_4",
+	[TI953_REG_SLAVE_ID_ALIAS_5] = "SLAVE_ID_ALIAS_5",
+	[TI953_REG_SLAVE_ID_ALIAS_6] = "SLAVE_ID_ALIAS_6",
+	[TI953_REG_SLAVE_ID_ALIAS_7] = "SLAVE_ID_ALIAS_7",
+	[TI953_REG_CB_CTRL] = "CB_CTRL",
+	[TI953_REG_REV_MASK_ID] = "REV_MASK_ID",
+	[TI953_REG_DEVICE_STS] = "DEVICE_STS",
+	[TI953_REG_GENERAL_STATUS] = "GENERAL_STATUS",
+	[TI953_REG_GPIO_PIN_STS] = "GPIO_PIN_STS",
+	[TI953_REG_BIST_ERR_CNT] = "BIST_ERR_CNT",
+	[TI953_REG_CRC_ERR_CNT1] = "CRC_ERR_CNT1",
+	[TI953_REG_CRC_ERR_CNT2] = "CRC_ERR_CNT2",
+	[TI953_REG_SENSOR_STATUS] = "SENSOR_STATUS",
+	[TI953_REG_SENSOR_V0] = "SENSOR_V0",
+	[TI953_REG_SENSOR_V1] = "SENSOR_V1",
+	[TI953_REG_SENSOR_T] = "SENSOR_T",
+	[TI953_REG_CSI_ERR_CNT] = "CSI_ERR_CNT",
+	[TI953_REG_CSI_ERR_STATUS] = "CSI_ERR_STATUS",
+	[TI953_REG_CSI_ERR_DLANE01] = "CSI_ERR_DLANE01",
+	[TI953_REG_CSI_ERR_DLANE23] = "CSI_ERR_DLANE23",
+	[TI953_REG_CSI_ERR_CLK_LANE] = "CSI_ERR_CLK_LANE",
+	[TI953_REG_CSI_PKT_HDR_VC_ID] = "CSI_PKT_HDR_VC_ID",
+	[TI953_REG_PKT_HDR_WC_LSB] = "PKT_HDR_WC_LSB",
+	[TI953_REG_PKT_HDR_WC_MSB] = "PKT_HDR_WC_MSB",
+	[TI953_REG_CSI_ECC] = "CSI_ECC",
+	[TI953_REG_IND_ACC_CTL] = "IND_ACC_CTL",
+	[TI953_REG_IND_ACC_ADDR] = "IND_ACC_ADDR",
+	[TI953_REG_IND_ACC_DATA] = "IND_ACC_DATA",
+	[TI953_REG_FPD3_RX_ID0] = "FPD3_RX_ID0",
+	[TI953_REG_FPD3_RX_ID1] = "FPD3_RX_ID1",
+	[TI953_REG_FPD3_RX_ID2] = "FPD3_RX_ID2",
+	[TI953_REG_FPD3_RX_ID3] = "FPD3_RX_ID3",
+	[TI953_REG_FPD3_RX_ID4] = "FPD3_RX_ID4",
+	[TI953_REG_FPD3_RX_ID5] = "FPD3_RX_ID5",
+};
+
+static const u8 ds90ub954_dump_skip[] = {
+	TI954_REG_CSI_TX_ISR, TI954_REG_BCC_STATUS, TI954_REG_RX_PORT_STS1,
+	TI954_REG_RX_PORT_STS2, TI954_REG_RX_PAR_ERR_HI,
+	TI954_REG_RX_PAR_ERR_LO, TI954_REG_CSI_RX_STS,
+	TI954_REG_CSI_ERR_COUNTER, TI954_REG_IND_ACC_DATA,
+	TI954_REG_PORT_ISR_HI, TI954_REG_PORT_ISR_LO,
+	TI954_REG_SEN_INT_RISE_STS, TI954_REG_SEN_INT_FALL_STS,
+};
+
+static const u8 ds90ub953_dump_skip[] = {
+	TI953_REG_CSI_ERR_CNT, TI953_REG_CSI_ERR_STATUS,
+	TI953_REG_CSI_ERR_DLANE01, TI953_REG_CSI_ERR_DLANE23,
+	TI953_REG_CSI_ERR_CLK_LANE, TI953_REG_IND_ACC_DATA,
+};
+
+/* indirect access banks: pattern generator, rx ports, shared */
+#define DUMP_IA_SHARED_BANK 5
+
+/* one bulk read per run of readable registers from first to last */
+static int ds90ub954_dump_bulk(struct ds90ub954_priv *priv, struct regmap *map,
+			       unsigned int first, unsigned int last,
+			       const u8 *skip, int num_skip, u8 *vals,
+			       unsigned long *valid)
+{
+	unsigned int reg = first, start;
+	int err;
+
+	while(reg <= last) {
+		if(ds90ub954_reg_listed(skip, num_skip, reg)) {
+			reg++;
 			continue;
-		val |= (1<<(TI954_FWD_PORT0_DIS+rx_port));
-		err = ds90ub954_write(priv, TI954_REG_FWD_CTL1, val);
+		}
+		start = reg;
+		while(reg <= last &&
+		      !ds90ub954_reg_listed(skip, num_skip, reg))
+			reg++;
+
+		err = ds90ub954_read_bulk(priv, map, start, &vals[start],
+					  reg - start);
 		if(err)
+			return err;
+		bitmap_set(valid, start, reg - start);
+	}
+	return 0;
+}
+
+static int ds90ub954_dump_read(struct ds90ub954_dump *d, u8 *vals,
+			       unsigned long *valid)
+{
+	struct ds90ub954_priv *priv = d->priv;
+	struct ds90ub953_priv *ser;
+	int i, reg, val, err = 0;
+
+	switch(d->type) {
+	case DUMP_MAIN:
+		mutex_lock(&priv->reg_lock);
+		err = ds90ub954_dump_bulk(priv, priv->regmap, 0, 0xff,
+					  ds90ub954_dump_skip,
+					  ARRAY_SIZE(ds90ub954_dump_skip),
+					  vals, valid);
+		mutex_unlock(&priv->reg_lock);
+		break;
+	case DUMP_RX_PORT:
+		mutex_lock(&priv->reg_lock);
+		err = ds90ub954_select_rx_port_locked(priv, d->index);
+		for(i = 0; !err && i < ARRAY_SIZE(ds90ub954_paged); i++)
+			err = ds90ub954_dump_bulk(priv, priv->regmap,
+						  ds90ub954_paged[i][0],
+						  ds90ub954_paged[i][1],
+						  ds90ub954_dump_skip,
+						  ARRAY_SIZE(ds90ub954_dump_skip),
+						  vals, valid);
+		mutex_unlock(&priv->reg_lock);
+		break;
+	case DUMP_IA:
+		/* IND_ACC_DATA can't be burst read, auto increment saves the
+		 * address writes */
+		mutex_lock(&priv->reg_lock);
+		err = ds90ub954_select_ia_locked(priv, (d->index<<TI954_IA_SEL) |
+						 (1<<TI954_IA_AUTO_INC) |
+						 (1<<TI954_IA_READ));
+		if(!err)
+			err = ds90ub954_write(priv, TI954_REG_IND_ACC_ADDR, 0);
+		for(reg = 0; !err && reg <= 0xff; reg++) {
+			err = ds90ub954_read(priv, TI954_REG_IND_ACC_DATA, &val);
+			vals[reg] = val;
+			__set_bit(reg, valid);
+		}
+		mutex_unlock(&priv->reg_lock);
+		break;
+	case DUMP_SER:
+		ser = priv->ser[d->index];
+		mutex_lock(&ser->lock);
+		if(ser->initialized)
+			err = ds90ub954_dump_bulk(priv, ser->regmap, 0, 0xff,
+						  ds90ub953_dump_skip,
+						  ARRAY_SIZE(ds90ub953_dump_skip),
+						  vals, valid);
+		else
+			err = -ENODEV;
+		mutex_unlock(&ser->lock);
+		break;
+	default:
+		err = -EINVAL;
+	}
+	return err;
+}
+
+static void ds90ub954_dump_print(struct seq_file *s, const u8 *vals,
+				 const unsigned long *valid,
+				 const char * const *names, int decode)
+{
+	int reg, row, col;
+
+	if(decode) {
+		for_each_set_bit(reg, valid, 256)
+			seq_printf(s, "0x%02x 0x%02x %s\n", reg, vals[reg],
+				   names && names[reg] ? names[reg] : "");
+		return;
+	}
+
+	for(row = 0; row < 256; row += 16) {
+		if(find_next_bit(valid, row + 16, row) >= row + 16)
 			continue;
-		continue;
+		seq_printf(s, "%02x:", row);
+		for(col = row; col < row + 16; col++) {
+			if(test_bit(col, valid))
+				seq_printf(s, " %02x", vals[col]);
+			else
+				seq_puts(s, " --");
+		}
+		seq_puts(s, "\n");
+	}
+}
+
+static const char * const *ds90ub954_dump_names(struct ds90ub954_dump *d)
+{
+	switch(d->type) {
+	case DUMP_MAIN:
+	case DUMP_RX_PORT:
+		return ds90ub954_reg_names;
+	case DUMP_IA:
+		return d->index ? NULL : ds90ub954_ia_pgen_names;
+	case DUMP_SER:
+		return ds90ub953_reg_names;
+	default:
+		return NULL;
+	}
+}
+
+static int ds90ub954_dump_one(struct seq_file *s, struct ds90ub954_dump *d)
+{
+	DECLARE_BITMAP(valid, 256);
+	u8 vals[256];
+	int err;
+
+	bitmap_zero(valid, 256);
+	err = ds90ub954_dump_read(d, vals, valid);
+	if(err) {
+		seq_printf(s, "read failed (%d)\n", err);
+		return err;
+	}
+	ds90ub954_dump_print(s, vals, valid, ds90ub954_dump_names(d),
+			     READ_ONCE(d->priv->dump_decode));
+	return 0;
+}
+
+static int ds90ub954_dump_show(struct seq_file *s, void *data)
+{
+	struct ds90ub954_dump *d = s->private;
+	struct ds90ub954_priv *priv = d->priv;
+	int i;
+
+	if(d->type != DUMP_ALL)
+		return ds90ub954_dump_one(s, d);
+
+	/* snapshot of all maps, in the order of the dump files */
+	for(i = 0; i < DUMP_MAX_FILES && priv->dump[i].priv; i++) {
+		d = &priv->dump[i];
+		switch(d->type) {
+		case DUMP_MAIN:
+			seq_puts(s, "# main\n");
+			break;
+		case DUMP_RX_PORT:
+			seq_printf(s, "# rx%d\n", d->index);
+			break;
+		case DUMP_IA:
+			seq_printf(s, "# ia%d\n", d->index);
+			break;
+		case DUMP_SER:
+			seq_printf(s, "# ser_rx%d\n",
+				   priv->ser[d->index]->rx_channel);
+			break;
+		default:
+			continue;
+		}
+		ds90ub954_dump_one(s, d);
+	}
+	return 0;
+}
+
+static int ds90ub954_dump_open(struct inode *inode, struct file *file)
+{
+	/* the ia banks alone are 1024 lines when decoded */
+	return single_open_size(file, ds90ub954_dump_show, inode->i_private,
+				64 * PAGE_SIZE);
+}
+
+static const struct file_operations ds90ub954_dump_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_dump_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static void ds90ub954_dump_add(struct ds90ub954_priv *priv, struct dentry *dir,
+			       int *n, enum ds90ub954_dump_type type,
+			       int index, const char *name)
+{
+	struct ds90ub954_dump *d;
+
+	if(*n >= DUMP_MAX_FILES)
+		return;
+	d = &priv->dump[(*n)++];
+	d->priv = priv;
+	d->type = type;
+	d->index = index;
+	debugfs_create_file(name, 0400, dir, d, &ds90ub954_dump_fops);
+}
+
+static void ds90ub954_dump_init(struct ds90ub954_priv *priv)
+{
+	struct dentry *dir;
+	char name[16];
+	int i, n = 0;
+
+	dir = debugfs_create_dir("regs", priv->debugfs);
+	debugfs_create_bool("decode", 0600, dir, &priv->dump_decode);
+
+	ds90ub954_dump_add(priv, dir, &n, DUMP_MAIN, 0, "main");
+	for(i = 0; i < priv->chip->num_rx_ports; i++) {
+		snprintf(name, sizeof(name), "rx%d", i);
+		ds90ub954_dump_add(priv, dir, &n, DUMP_RX_PORT, i, name);
+	}
+	/* bank 0: pattern generator and csi timing, then one per rx port */
+	for(i = 0; i <= priv->chip->num_rx_ports; i++) {
+		snprintf(name, sizeof(name), "ia%d", i);
+		ds90ub954_dump_add(priv, dir, &n, DUMP_IA, i, name);
+	}
+	snprintf(name, sizeof(name), "ia%d", DUMP_IA_SHARED_BANK);
+	ds90ub954_dump_add(priv, dir, &n, DUMP_IA, DUMP_IA_SHARED_BANK, name);
+	for(i = 0; i < priv->num_ser; i++) {
+		if(!priv->ser[i])
+			continue;
+		snprintf(name, sizeof(name), "ser_rx%d",
+			 priv->ser[i]->rx_channel);
+		ds90ub954_dump_add(priv, dir, &n, DUMP_SER, i, name);
+	}
+
+	/* not part of the snapshot itself */
+	if(n < DUMP_MAX_FILES) {
+		priv->dump[DUMP_MAX_FILES - 1].priv = priv;
+		priv->dump[DUMP_MAX_FILES - 1].type = DUMP_ALL;
+		debugfs_create_file("all", 0400, dir,
+				    &priv->dump[DUMP_MAX_FILES - 1],
+				    &ds90ub954_dump_fops);
 	}
+}
 
-	/* setup gpio forwarding, default all input */
-	err = ds90ub954_write(priv, TI954_REG_GPIO_INPUT_CTL,
-			      (1<<TI954_GPIO6_INPUT_EN)|
-			      (1<<TI954_GPIO5_INPUT_EN)|
-			      (1<<TI954_GPIO4_INPUT_EN)|
-			      (1<<TI954_GPIO3_INPUT_EN)|
-			      (1<<TI954_GPIO2_INPUT_EN)|
-			      (1<<TI954_GPIO1_INPUT_EN)|
-			      (1<<TI954_GPIO0_INPUT_EN));
-	if(err)
-		goto init_err;
+/*
+ * The snapshot is collected on open with burst reads: two for the global
+ * state, four per rx port and one per serializer. The deserializer ports are
+ * read under the device lock, each serializer under its port state lock.
+ */
+static void ds90ub954_snapshot_port(struct ds90ub954_priv *priv, int port,
+				    struct ds90ub954_snapshot_port *sp)
+{
+	struct ds90ub954_port_counters *cnt = &priv->counters[port];
+	struct ds90ub953_priv *ser = NULL;
+	u8 sts[TI954_REG_RX_PAR_ERR_LO - TI954_REG_RX_PORT_STS1 + 1];
+	u8 csi[TI954_REG_CSI_ERR_COUNTER - TI954_REG_LINE_COUNT_HI + 1];
+	u8 ser_sts[TI953_REG_CSI_ERR_STATUS - TI953_REG_DEVICE_STS + 1];
+	int i, val, err;
+
+	sp->port = port;
+	for(i = 0; i < priv->num_ser; i++) {
+		if(priv->ser[i] && priv->ser[i]->rx_channel == port)
+			ser = priv->ser[i];
+	}
 
-	err = ds90ub954_write(priv, TI954_REG_GPIO0_PIN_CTL, 0);
-	if(err)
-		goto init_err;
+	if(ser) {
+		sp->flags |= BIT(SNAPSHOT_SER_PRESENT);
+		mutex_lock(&ser->lock);
+	}
 
-	err = ds90ub954_write(priv, TI954_REG_GPIO1_PIN_CTL, 0);
-	if(err)
-		goto init_err;
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_select_rx_port_locked(priv, port);
+	if(!err)
+		err = ds90ub954_read_bulk(priv, priv->regmap,
+					  TI954_REG_RX_PORT_STS1, sts,
+					  sizeof(sts));
+	if(!err)
+		err = ds90ub954_read_bulk(priv, priv->regmap,
+					  TI954_REG_LINE_COUNT_HI, csi,
+					  sizeof(csi));
+	if(!err) {
+		err = ds90ub954_read(priv, TI954_REG_BCC_STATUS, &val);
+		sp->bcc_status = val;
+	}
+	if(!err) {
+		err = ds90ub954_read(priv, TI954_REG_AEQ_STATUS, &val);
+		sp->aeq_status = val;
+	}
+	if(!err) {
+		sp->flags |= BIT(SNAPSHOT_PORT_VALID);
+		sp->rx_port_sts1 = sts[0];
+		sp->rx_port_sts2 = sts[TI954_REG_RX_PORT_STS2 -
+				      TI954_REG_RX_PORT_STS1];
+		sp->rx_freq_high = sts[TI954_REG_RX_FREQ_HIGH -
+				      TI954_REG_RX_PORT_STS1];
+		sp->rx_freq_low = sts[TI954_REG_RX_FREQ_HIGH + 1 -
+				     TI954_REG_RX_PORT_STS1];
+		memcpy(sp->sensor_sts, &sts[TI954_REG_SENSOR_STS_0 -
+					    TI954_REG_RX_PORT_STS1], 4);
+		val = (sts[TI954_REG_RX_PAR_ERR_HI - TI954_REG_RX_PORT_STS1]<<8) |
+		      sts[TI954_REG_RX_PAR_ERR_LO - TI954_REG_RX_PORT_STS1];
+		sp->par_err = cpu_to_le16(val);
+		cnt->par_err += val;
+		cnt->par_read = ktime_get();
+		sp->line_count = cpu_to_le16((csi[0]<<8) | csi[1]);
+		sp->line_len = cpu_to_le16((csi[2]<<8) | csi[3]);
+		sp->csi_rx_sts = csi[TI954_REG_CSI_RX_STS -
+				     TI954_REG_LINE_COUNT_HI];
+		sp->csi_err_counter = csi[TI954_REG_CSI_ERR_COUNTER -
+					  TI954_REG_LINE_COUNT_HI];
+		cnt->csi_err += sp->csi_err_counter;
+	}
+	sp->par_err_total = cpu_to_le32(cnt->par_err);
+	sp->csi_err_total = cpu_to_le32(cnt->csi_err);
+	mutex_unlock(&priv->reg_lock);
+
+	if(!ser)
+		return;
+
+	if(ser->initialized &&
+	   !ds90ub954_read_bulk(priv, ser->regmap, TI953_REG_DEVICE_STS,
+				ser_sts, sizeof(ser_sts))) {
+		sp->flags |= BIT(SNAPSHOT_SER_VALID);
+		sp->ser_device_sts = ser_sts[0];
+#define SER_STS(reg) ser_sts[(reg) - TI953_REG_DEVICE_STS]
+		sp->ser_general_status = SER_STS(TI953_REG_GENERAL_STATUS);
+		sp->ser_gpio_pin_sts = SER_STS(TI953_REG_GPIO_PIN_STS);
+		sp->ser_bist_err_cnt = SER_STS(TI953_REG_BIST_ERR_CNT);
+		sp->ser_crc_err_cnt1 = SER_STS(TI953_REG_CRC_ERR_CNT1);
+		sp->ser_crc_err_cnt2 = SER_STS(TI953_REG_CRC_ERR_CNT2);
+		sp->ser_sensor_status = SER_STS(TI953_REG_SENSOR_STATUS);
+		sp->ser_sensor_v0 = SER_STS(TI953_REG_SENSOR_V0);
+		sp->ser_sensor_v1 = SER_STS(TI953_REG_SENSOR_V1);
+		sp->ser_sensor_t = SER_STS(TI953_REG_SENSOR_T);
+		sp->ser_csi_err_cnt = SER_STS(TI953_REG_CSI_ERR_CNT);
+		sp->ser_csi_err_status = SER_STS(TI953_REG_CSI_ERR_STATUS);
+#undef SER_STS
+		mutex_lock(&priv->reg_lock);
+		cnt->ser_csi_err += sp->ser_csi_err_cnt;
+		mutex_unlock(&priv->reg_lock);
+	}
+	sp->ser_csi_err_total = cpu_to_le32(cnt->ser_csi_err);
+	mutex_unlock(&ser->lock);
+}
 
-	err = ds90ub954_write(priv, TI954_REG_GPIO2_PIN_CTL, 0);
-	if(err)
-		goto init_err;
+static size_t ds90ub954_snapshot_size(struct ds90ub954_priv *priv)
+{
+	return sizeof(struct ds90ub954_snapshot_hdr) +
+	       priv->chip->num_rx_ports * sizeof(struct ds90ub954_snapshot_port);
+}
 
-	err = ds90ub954_write(priv, TI954_REG_GPIO3_PIN_CTL, 0);
-	if(err)
-		goto init_err;
+static void ds90ub954_snapshot_collect(struct ds90ub954_priv *priv, void *buf)
+{
+	struct ds90ub954_snapshot_hdr *hdr = buf;
+	struct ds90ub954_snapshot_port *ports = buf + sizeof(*hdr);
+	struct ds90ub954_link *link = &priv->link;
+	ktime_t start = ktime_get();
+	u8 sts[TI954_REG_INTERRUPT_STS - TI954_REG_FWD_STS + 1];
+	int port, val;
+
+	hdr->magic = cpu_to_le32(SNAPSHOT_MAGIC);
+	hdr->version = cpu_to_le16(SNAPSHOT_VERSION);
+	hdr->size = cpu_to_le16(ds90ub954_snapshot_size(priv));
+	hdr->port_size = cpu_to_le16(sizeof(*ports));
+	hdr->num_ports = priv->chip->num_rx_ports;
+	hdr->timestamp_ns = cpu_to_le64(ktime_to_ns(start));
+
+	mutex_lock(&link->lock);
+	hdr->link_state = link->state;
+	hdr->lock_events = cpu_to_le32(link->lock_events);
+	hdr->loss_events = cpu_to_le32(link->loss_events);
+	hdr->pass_loss_events = cpu_to_le32(link->pass_loss_events);
+	hdr->last_lock_ns = cpu_to_le64(ktime_to_ns(link->last_lock));
+	hdr->last_loss_ns = cpu_to_le64(ktime_to_ns(link->last_loss));
+	mutex_unlock(&link->lock);
+
+	if(!ds90ub954_read(priv, TI954_REG_DEVICE_STS, &val))
+		hdr->device_sts = val;
+	if(!ds90ub954_read_bulk(priv, priv->regmap, TI954_REG_FWD_STS, sts,
+				sizeof(sts))) {
+		hdr->fwd_sts = sts[0];
+		hdr->interrupt_sts = sts[TI954_REG_INTERRUPT_STS -
+					 TI954_REG_FWD_STS];
+	}
 
-	err = ds90ub954_write(priv, TI954_REG_GPIO4_PIN_CTL, 0);
-	if(err)
-		goto init_err;
+	for(port = 0; port < priv->chip->num_rx_ports; port++)
+		ds90ub954_snapshot_port(priv, port, &ports[port]);
 
-	err = ds90ub954_write(priv, TI954_REG_GPIO5_PIN_CTL, 0);
-	if(err)
-		goto init_err;
+	hdr->collect_us = cpu_to_le32(ktime_us_delta(ktime_get(), start));
+}
 
-	err = ds90ub954_write(priv, TI954_REG_GPIO6_PIN_CTL, 0);
-	if(err)
-		goto init_err;
+static int ds90ub954_snapshot_open(struct inode *inode, struct file *file)
+{
+	struct ds90ub954_priv *priv = inode->i_private;
+	void *buf;
 
-init_err:
-	return err;
+	buf = kzalloc(ds90ub954_snapshot_size(priv), GFP_KERNEL);
+	if(!buf)
+		return -ENOMEM;
+	ds90ub954_snapshot_collect(priv, buf);
+	file->private_data = buf;
+	return 0;
 }
 
-static int ds90ub954_init_gpio(const struct ds90ub954_priv *priv)
+static ssize_t ds90ub954_snapshot_read(struct file *file, char __user *ubuf,
+				       size_t count, loff_t *ppos)
 {
-	struct device *dev = &priv->client->dev;
-	int err = 0;
+	struct ds90ub954_snapshot_hdr *hdr = file->private_data;
 
-	if(gpio_is_valid(priv->pass_gpio)) {
-		err = gpio_request(priv->pass_gpio, "ds90ub954_pass_gpio");
-		if(unlikely(err < 0)) {
-			dev_err(dev, "unable to request pass_gpio (%d)\n", err);
-			goto done;
-		}
-		err = gpio_direction_input(priv->pass_gpio);
-		if(unlikely(err < 0)) {
-			dev_err(dev, "unable to configure pass_gpio as input (%d)\n", err);
-			goto done;
-		}
-	}
+	return simple_read_from_buffer(ubuf, count, ppos, hdr,
+				       le16_to_cpu(hdr->size));
+}
 
-	if(gpio_is_valid(priv->lock_gpio)) {
-		err = gpio_request(priv->lock_gpio, "ds90ub954_lock_gpio");
-		if(unlikely(err < 0)) {
-			dev_err(dev, "unable to request lock_gpio (%d)\n", err);
-			goto done;
-		}
-		err = gpio_direction_input(priv->lock_gpio);
-		if(unlikely(err < 0)) {
-			dev_err(dev, "unable to configure lock_gpio as input (%d)\n", err);
-			goto done;
+static int ds90ub954_snapshot_release(struct inode *inode, struct file *file)
+{
+	kfree(file->private_data);
+	return 0;
+}
+
+static const struct file_operations ds90ub954_snapshot_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_snapshot_open,
+	.read = ds90ub954_snapshot_read,
+	.llseek = default_llseek,
+	.release = ds90ub954_snapshot_release,
+};
+
+static int ds90ub954_ports_show(struct seq_file *s, void *data)
+{
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_port_sm sm;
+	unsigned long flags;
+	ktime_t now = ktime_get();
+	int port, st;
+
+	seq_printf(s, "%-4s %-9s %8s %11s %6s", "port", "state", "for ms",
+		   "transitions", "faults");
+	for(st = PORT_LOCKED; st <= PORT_STREAMING; st++)
+		seq_printf(s, " %9s", ds90ub954_port_state_names[st]);
+	seq_puts(s, "\n");
+
+	for(port = 0; port < priv->chip->num_rx_ports; port++) {
+		spin_lock_irqsave(&priv->ports.lock, flags);
+		sm = priv->ports.sm[port];
+		spin_unlock_irqrestore(&priv->ports.lock, flags);
+
+		seq_printf(s, "%-4d %-9s %8lld %11u %6u", port,
+			   ds90ub954_port_state_names[sm.state],
+			   ktime_ms_delta(now, sm.changed), sm.transitions,
+			   sm.faults);
+		/* ms from enable to each phase of the last bring-up */
+		for(st = PORT_LOCKED; st <= PORT_STREAMING; st++) {
+			if(ktime_before(sm.entered[st], sm.enabled))
+				seq_printf(s, " %9s", "-");
+			else
+				seq_printf(s, " %9lld",
+					   ktime_ms_delta(sm.entered[st],
+							  sm.enabled));
 		}
+		seq_puts(s, "\n");
 	}
+	return 0;
+}
 
-	if(gpio_is_valid(priv->pdb_gpio)) {
-		err = gpio_request(priv->pdb_gpio, "ds90ub954_pdb_gpio");
-		if(unlikely(err < 0)) {
-			dev_err(dev, "unable to request pdb_gpio (%d)\n", err);
-			goto done;
-		}
-		err = gpio_direction_output(priv->pdb_gpio, 0);
-		if(unlikely(err < 0)) {
-			dev_err(dev, "unable to configure pdb_gpio as output (%d)\n", err);
-			goto done;
-		}
+static int ds90ub954_ports_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub954_ports_show, inode->i_private);
+}
+
+static const struct file_operations ds90ub954_ports_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_ports_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int ds90ub954_bcc_show(struct seq_file *s, void *data)
+{
+	struct ds90ub954_priv *priv = s->private;
+	struct ds90ub954_port_counters *cnt;
+	int port;
+
+	seq_puts(s, "watchdog: ");
+	if(priv->bcc.wd_ms < 0)
+		seq_puts(s, "reset value\n");
+	else if(!priv->bcc.wd_ms)
+		seq_puts(s, "disabled\n");
+	else
+		seq_printf(s, "%i ms\n", priv->bcc.wd_ms);
+	seq_printf(s, "intb: %s\n", priv->bcc.irq >= 0 ? "irq" : "polled");
+
+	seq_printf(s, "%-4s %8s %8s %8s %8s\n", "port", "crc_err", "seq_err",
+		   "reinit", "failed");
+	for(port = 0; port < priv->chip->num_rx_ports; port++) {
+		cnt = &priv->counters[port];
+		seq_printf(s, "%-4d %8u %8u %8u %8u\n", port, cnt->bcc_crc_err,
+			   cnt->bcc_seq_err, cnt->bcc_reinit,
+			   cnt->bcc_reinit_failed);
 	}
+	return 0;
+}
 
-done:
-	return err;
+static int ds90ub954_bcc_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub954_bcc_show, inode->i_private);
 }
 
-static void ds90ub954_free_gpio(const struct ds90ub954_priv *priv)
+static const struct file_operations ds90ub954_bcc_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub954_bcc_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static void ds90ub954_debugfs_init(struct ds90ub954_priv *priv)
 {
+	struct device *dev = &priv->client->dev;
+	char name[32];
+	int i;
 
-	if(priv->pass_gpio >= 0) {
-		gpio_free(priv->pass_gpio);
-	}
-	if(priv->lock_gpio >= 0) {
-		gpio_free(priv->lock_gpio);
-	}
-	if(priv->pdb_gpio >= 0) {
-		gpio_free(priv->pdb_gpio);
+	mutex_init(&priv->bench.lock);
+	priv->bench.count = 1000;
+	priv->bench.burst = 1;
+	/* read-only id register, writes are ignored by the serializer */
+	priv->bench.reg = TI953_REG_FPD3_RX_ID0;
+
+	snprintf(name, sizeof(name), "ds90ub954-%s", dev_name(dev));
+	priv->debugfs = debugfs_create_dir(name, NULL);
+	debugfs_create_file("bench", 0600, priv->debugfs, priv,
+			    &ds90ub954_bench_fops);
+	debugfs_create_file("reg_hist", 0600, priv->debugfs, &priv->hist,
+			    &ds90ub954_reg_hist_fops);
+	debugfs_create_file("retry", 0600, priv->debugfs, priv,
+			    &ds90ub954_retry_fops);
+	debugfs_create_file("pgen", 0600, priv->debugfs, priv,
+			    &ds90ub954_pgen_fops);
+	ds90ub954_dump_init(priv);
+	debugfs_create_file("snapshot", 0400, priv->debugfs, priv,
+			    &ds90ub954_snapshot_fops);
+	debugfs_create_file("ports", 0400, priv->debugfs, priv,
+			    &ds90ub954_ports_fops);
+	debugfs_create_file("bcc", 0400, priv->debugfs, priv,
+			    &ds90ub954_bcc_fops);
+#ifdef CONFIG_VIDEO_DS90UB954_FAULT_INJECTION
+	debugfs_create_file("fault", 0600, priv->debugfs, priv,
+			    &ds90ub954_fault_fops);
+#endif
+	for(i = 0; i < priv->num_ser; i++) {
+		if(!priv->ser[i])
+			continue;
+		snprintf(name, sizeof(name), "reg_hist_rx%d",
+			 priv->ser[i]->rx_channel);
+		debugfs_create_file(name, 0600, priv->debugfs,
+				    &priv->ser[i]->hist,
+				    &ds90ub954_reg_hist_fops);
+		snprintf(name, sizeof(name), "pgen_rx%d",
+			 priv->ser[i]->rx_channel);
+		debugfs_create_file(name, 0600, priv->debugfs, priv->ser[i],
+				    &ds90ub953_pgen_fops);
 	}
 }
 
-static void ds90ub954_pwr_enable(const struct ds90ub954_priv *priv)
+static void ds90ub954_debugfs_remove(struct ds90ub954_priv *priv)
 {
-	if(priv->pdb_gpio >= 0) {
-		gpio_set_value_cansleep(priv->pdb_gpio, 1);
-	}
+	debugfs_remove_recursive(priv->debugfs);
+	priv->debugfs = NULL;
 }
 
-static void ds90ub954_pwr_disable(const struct ds90ub954_priv *priv)
+/*------------------------------------------------------------------------------
+ * POWER MANAGEMENT
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Runtime suspend asserts PDB and switches the register accesses to the cache.
+ * Runtime resume releases PDB, replays the cache of the deserializer, waits
+ * for the lock of every rx port and replays the cache of its serializer. The
+ * driver holds a runtime pm reference after probe, it is dropped and taken
+ * again with the link_power attribute. System sleep uses the same callbacks.
+ */
+
+/* bulk write of every run of cached registers */
+static int ds90ub954_regcache_sync_one(struct ds90ub954_priv *priv,
+				       struct regmap *map, spinlock_t *lock,
+				       struct ds90ub954_regcache *c)
 {
-	if(priv->pdb_gpio >= 0) {
-		gpio_set_value_cansleep(priv->pdb_gpio, 0);
+	DECLARE_BITMAP(valid, REGCACHE_NUM_REGS);
+	u8 vals[REGCACHE_NUM_REGS];
+	unsigned int reg, end;
+	unsigned long flags;
+	int err;
+
+	spin_lock_irqsave(lock, flags);
+	memcpy(vals, c->val, sizeof(vals));
+	bitmap_copy(valid, c->valid, REGCACHE_NUM_REGS);
+	spin_unlock_irqrestore(lock, flags);
+
+	reg = find_first_bit(valid, REGCACHE_NUM_REGS);
+	while(reg < REGCACHE_NUM_REGS) {
+		end = find_next_zero_bit(valid, REGCACHE_NUM_REGS, reg);
+		err = ds90ub954_write_bulk(priv, map, reg, &vals[reg],
+					   end - reg);
+		if(unlikely(err))
+			return err;
+		priv->pm.sync_writes++;
+		reg = find_next_bit(valid, REGCACHE_NUM_REGS, end);
 	}
+	return 0;
 }
 
-static int ds90ub954_parse_dt(struct ds90ub954_priv *priv)
+/* main map first, then the pages of all rx ports */
+static int ds90ub954_regcache_sync_locked(struct ds90ub954_priv *priv)
 {
-	struct device *dev = &priv->client->dev;
-	struct device_node *np = dev->of_node;
-	const struct of_device_id *match;
-	int gpio;
-	int err = 0;
-	int val = 0;
+	int port, err;
 
-	if(!np)
-		return -ENODEV;
+	lockdep_assert_held(&priv->reg_lock);
 
-	dev_info(dev, "%s: deserializer:\n", __func__);
-	match = of_match_device(ds90ub954_of_match, dev);
-	if(!match) {
-		dev_err(dev, "Failed to find matching dt id\n");
-		return -ENODEV;
-	}
+	err = ds90ub954_regcache_sync_one(priv, priv->regmap,
+					  &priv->cache_lock, &priv->cache[0]);
+	if(unlikely(err))
+		return err;
 
-	gpio = of_get_named_gpio(np, "pass-gpio", 0);
-	if(gpio < 0) {
-		if(gpio == -EPROBE_DEFER) {
-			err = gpio;
-			dev_err(dev, "pass-gpio read failed: (%d)\n", err);
+	for(port = 0; port < priv->chip->num_rx_ports; port++) {
+		if(bitmap_empty(priv->cache[1 + port].valid, REGCACHE_NUM_REGS))
+			continue;
+		err = ds90ub954_select_rx_port_locked(priv, port);
+		if(unlikely(err))
+			return err;
+		err = ds90ub954_regcache_sync_one(priv, priv->regmap,
+						  &priv->cache_lock,
+						  &priv->cache[1 + port]);
+		if(unlikely(err))
 			return err;
-		}
-		dev_info(dev, "pass-gpio not found, ignoring\n");
 	}
-	priv->pass_gpio = gpio;
+	return 0;
+}
+
+static int ds90ub954_pm_wait_lock(struct ds90ub954_priv *priv, int rx_port)
+{
+	int i, val, err;
 
-	gpio = of_get_named_gpio(np, "lock-gpio", 0);
-	if(gpio < 0) {
-		if(gpio == -EPROBE_DEFER) {
-			err = gpio;
-			dev_err(dev, "lock-gpio read failed: (%d)\n", err);
+	for(i = 0; i < PM_LOCK_TIMEOUT_MS; i += PM_LOCK_POLL_MS) {
+		err = ds90ub954_read_rx_port(priv, rx_port,
+					     TI954_REG_RX_PORT_STS1, &val);
+		if(unlikely(err))
 			return err;
-		}
-		dev_info(dev, "lock-gpio not found, ignoring\n");
+		if(val & (1<<TI954_LOCK_STS))
+			return 0;
+		ds90ub954_msleep(priv, PM_LOCK_POLL_MS);
 	}
-	priv->lock_gpio = gpio;
+	return -ETIMEDOUT;
+}
 
-	gpio = of_get_named_gpio(np, "pdb-gpio", 0);
-	if(gpio < 0) {
-		if(gpio == -EPROBE_DEFER) {
-			err = gpio;
-			dev_err(dev, "pdb-gpio read failed: (%d)\n", err);
-			return err;
+/*
+ * Bring-up of an enabled rx port, shared by runtime resume and port power on:
+ * wait for lock and back channel. The serializer is powered down with the
+ * deserializer, if the port was not up since the last suspend its cache and
+ * test pattern are replayed. Otherwise it kept its configuration.
+ */
+static int ds90ub954_port_bring_up(struct ds90ub954_priv *priv,
+				   struct ds90ub953_priv *ser)
+{
+	int rx_port = ser->rx_channel;
+	int val, err;
+
+	err = ds90ub954_pm_wait_lock(priv, rx_port);
+	if(unlikely(err))
+		return err;
+	ds90ub954_port_set_state(priv, rx_port, PORT_LOCKED);
+
+	mutex_lock(&ser->lock);
+	/* the first remote access is retried until the back channel is up */
+	err = ds90ub953_read(ser, TI953_REG_DEVICE_STS, &val);
+	if(unlikely(err))
+		goto bring_up_err;
+	ds90ub954_port_set_state(priv, rx_port, PORT_BC_READY);
+
+	if(test_bit(rx_port, &priv->pm.ser_lost)) {
+		err = ds90ub954_regcache_sync_one(priv, ser->regmap,
+						  &ser->cache_lock, &ser->cache);
+		if(unlikely(err))
+			goto bring_up_err;
+		if(ser->test_pattern == 1) {
+			err = ds90ub953_init_testpattern(ser);
+			if(unlikely(err))
+				goto bring_up_err;
 		}
-		dev_info(dev, "pdb-gpio not found, ignoring\n");
+		clear_bit(rx_port, &priv->pm.ser_lost);
 	}
-	priv->pdb_gpio = gpio;
+	ds90ub954_port_set_state(priv, rx_port, PORT_ALIASED);
+bring_up_err:
+	mutex_unlock(&ser->lock);
+	return err;
+}
 
-	err = of_property_read_u32(np, "csi-lane-count", &val);
-	if(err) {
-		dev_info(dev, "%s: - csi-lane-count property not found\n", __func__);
+/* initialized and not power gated, port_users is stable during resume */
+static bool ds90ub954_port_powered(struct ds90ub954_priv *priv,
+				   struct ds90ub953_priv *ser)
+{
+	return ser && ser->initialized &&
+	       READ_ONCE(priv->pm.port_users[ser->rx_channel]) > 0;
+}
 
-		/* default value: 4 */
-		priv->csi_lane_count = 4;
-		dev_info(dev, "%s: - csi-lane-count set to default val: 4\n", __func__);
-	} else {
-		/* set csi-lane-count*/
-		priv->csi_lane_count = val;
-		dev_info(dev, "%s: - csi-lane-count %i\n", __func__, val);
-	}
+static void ds90ub954_pm_link_irqs(struct ds90ub954_priv *priv, bool enable)
+{
+	struct ds90ub954_link *link = &priv->link;
+
+	if(link->lock_irq >= 0)
+		enable ? enable_irq(link->lock_irq) :
+			 disable_irq(link->lock_irq);
+	if(link->pass_irq >= 0)
+		enable ? enable_irq(link->pass_irq) :
+			 disable_irq(link->pass_irq);
+	if(priv->bcc.irq >= 0)
+		enable ? enable_irq(priv->bcc.irq) :
+			 disable_irq(priv->bcc.irq);
+}
 
-	err = of_property_read_u32(np, "csi-lane-speed", &val);
-	if(err) {
-		dev_info(dev, "%s: - csi-lane-speed property not found\n", __func__);
+/* frame start flushes of the remote write queues */
+static void ds90ub954_pm_frame_irqs(struct ds90ub954_priv *priv, bool enable)
+{
+	struct ds90ub953_batch *batch;
+	int i;
 
-		/* default value: 4 */
-		priv->csi_lane_speed = 1600;
-		dev_info(dev, "%s: - csi-lane-speed set to default val: 4\n", __func__);
-	} else {
-		/* set csi-lane-speed*/
-		priv->csi_lane_speed = val;
-		dev_info(dev, "%s: - csi-lane-speed %i\n", __func__, val);
+	for(i = 0; i < priv->num_ser; i++) {
+		if(!priv->ser[i])
+			continue;
+		batch = &priv->ser[i]->batch;
+		if(batch->frame_start_irq >= 0)
+			enable ? enable_irq(batch->frame_start_irq) :
+				 disable_irq(batch->frame_start_irq);
 	}
+}
 
-	if(of_property_read_bool(np, "test-pattern")) {
-		dev_info(dev, "%s: - test-pattern enabled\n", __func__);
-		priv->test_pattern = 1;
-	} else {
-		/* default value: 0 */
-		priv->test_pattern = 0;
-		dev_info(dev, "%s: - test-pattern disabled\n", __func__);
+/*
+ * Reference for interrupts and works that only run while the device is
+ * powered. Returns 1 with a runtime pm reference, 0 if the device is powered
+ * but runtime pm is disabled (CONFIG_PM=n, or during system sleep), then the
+ * cache_only state tells, and -EAGAIN while suspended.
+ */
+static int ds90ub954_pm_get_active(struct ds90ub954_priv *priv)
+{
+	int ret = pm_runtime_get_if_active(&priv->client->dev, true);
+
+	if(ret > 0)
+		return 1;
+	if(ret == -EINVAL && !ds90ub954_cache_only(priv))
+		return 0;
+	return -EAGAIN;
+}
+
+static void ds90ub954_pm_put_active(struct ds90ub954_priv *priv, int ref)
+{
+	if(ref > 0)
+		pm_runtime_put(&priv->client->dev);
+}
+
+static int __maybe_unused ds90ub954_runtime_suspend(struct device *dev)
+{
+	struct ds90ub954_priv *priv = dev_get_drvdata(dev);
+	struct ds90ub953_priv *ser;
+	int i;
+
+	/* queued remote writes are sent before the link goes down, neither a
+	 * frame start nor the deadline may flush them after that and nothing
+	 * is queued until resume */
+	ds90ub954_pm_frame_irqs(priv, false);
+	for(i = 0; i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(!ser)
+			continue;
+		mutex_lock(&ser->batch.lock);
+		ser->batch.suspended = true;
+		if(ser->initialized)
+			ds90ub953_batch_flush_locked(ser);
+		mutex_unlock(&ser->batch.lock);
+		cancel_delayed_work_sync(&ser->batch.deadline_work);
 	}
 
-	if(of_property_read_bool(np, "continuous-clock")) {
-		dev_info(dev, "%s: - continuous clock enabled\n", __func__);
-		priv->conts_clk = 1;
-	} else {
-		/* default value: 0 */
-		priv->conts_clk = 0;
-		dev_info(dev, "%s: - discontinuous clock used\n", __func__);
+	ds90ub954_pm_link_irqs(priv, false);
+
+	mutex_lock(&priv->reg_lock);
+	WRITE_ONCE(priv->pm.cache_only, true);
+	priv->sel_rx_port = -1;
+	priv->sel_ia_config = -1;
+	mutex_unlock(&priv->reg_lock);
+
+	for(i = 0; i < priv->chip->num_rx_ports; i++) {
+		ds90ub954_port_set_state(priv, i, PORT_DISABLED);
+		set_bit(i, &priv->pm.ser_lost);
 	}
 
+	ds90ub954_pwr_disable(priv);
+	priv->pm.suspends++;
+	dev_dbg(dev, "%s: powered down\n", __func__);
 	return 0;
-
 }
 
-#ifdef ENABLE_SYSFS_TP
-static ssize_t test_pattern_show_des(struct device *dev,
-				     struct device_attribute *attr,
-				     char *buf)
+static int __maybe_unused ds90ub954_runtime_resume(struct device *dev)
 {
-	struct ds90ub954_priv *priv;
-	priv = dev_get_drvdata(dev);
-	return snprintf(buf, PAGE_SIZE,
-			"Test Pattern is set to: %i\n", priv->test_pattern);
-}
+	struct ds90ub954_priv *priv = dev_get_drvdata(dev);
+	struct ds90ub954_port_sm *sm;
+	struct ds90ub953_priv *ser;
+	ktime_t start = ktime_get();
+	int i, err, failed = 0;
 
-static ssize_t test_pattern_set_des(struct device *dev,
-				    struct device_attribute *attr,
-				    const char *buf, size_t count)
-{
-	struct ds90ub954_priv *priv;
-	int testpat;
+	ds90ub954_pwr_enable(priv);
+	ds90ub954_msleep(priv, PM_PDB_DELAY_MS);
 
-	priv = dev_get_drvdata(dev);
-	sscanf(buf, "%d", &testpat);
-	if(testpat > 1 || testpat < 0) {
-		dev_info(dev,
-			 "Invalid value: %i for test pattern (0/1)\n", testpat);
-		return PAGE_SIZE;
+	mutex_lock(&priv->reg_lock);
+	WRITE_ONCE(priv->pm.cache_only, false);
+	priv->sel_rx_port = -1;
+	priv->sel_ia_config = -1;
+	priv->pm.sync_writes = 0;
+	err = ds90ub954_regcache_sync_locked(priv);
+	mutex_unlock(&priv->reg_lock);
+	priv->pm.sync_us = ktime_us_delta(ktime_get(), start);
+	if(unlikely(err)) {
+		dev_err(dev, "%s: register replay failed (%d)\n", __func__,
+			err);
+		goto resume_err;
 	}
-	if(testpat == 1) {
-		dev_info(dev, "enabling testpattern for deserializer\n");
-		priv->test_pattern = 1;
+
+	/* all ports train in parallel, the waits only cover the slowest */
+	for(i = 0; i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(ds90ub954_port_powered(priv, ser))
+			ds90ub954_port_set_state(priv, ser->rx_channel,
+						 PORT_TRAINING);
+	}
+	for(i = 0; i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(!ds90ub954_port_powered(priv, ser))
+			continue;
+		err = ds90ub954_port_bring_up(priv, ser);
+		if(unlikely(err)) {
+			dev_warn(dev, "%s: rx_port %i: resume failed (%d)\n",
+				 __func__, ser->rx_channel, err);
+			ds90ub954_port_set_state(priv, ser->rx_channel,
+						 PORT_FAULT);
+			failed++;
+			continue;
+		}
+		sm = &priv->ports.sm[ser->rx_channel];
+		priv->pm.lock_us = ktime_us_delta(sm->entered[PORT_LOCKED],
+						  start);
+		ds90ub954_port_set_state(priv, ser->rx_channel, PORT_STREAMING);
+	}
+
+	if(priv->test_pattern == 1)
 		ds90ub954_init_testpattern(priv);
-	} else {
-		dev_info(dev, "disabling testpattern for deserializer\n");
-		ds90ub954_disable_testpattern(priv);
+
+	for(i = 0; i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(!ser)
+			continue;
+		mutex_lock(&ser->batch.lock);
+		ser->batch.suspended = false;
+		mutex_unlock(&ser->batch.lock);
+	}
+	ds90ub954_pm_link_irqs(priv, true);
+	ds90ub954_pm_frame_irqs(priv, true);
+	mutex_lock(&priv->link.lock);
+	ds90ub954_link_update_locked(priv);
+	mutex_unlock(&priv->link.lock);
+
+	priv->pm.resume_us = ktime_us_delta(ktime_get(), start);
+	priv->pm.resumes++;
+	if(failed)
+		priv->pm.resume_failed++;
+	dev_dbg(dev, "%s: replay %u us (%u writes), lock %u us, resume %u us\n",
+		__func__, priv->pm.sync_us, priv->pm.sync_writes,
+		priv->pm.lock_us, priv->pm.resume_us);
+	return 0;
+
+resume_err:
+	priv->pm.resume_failed++;
+	WRITE_ONCE(priv->pm.cache_only, true);
+	ds90ub954_pwr_disable(priv);
+	return err;
+}
+
+static const struct dev_pm_ops ds90ub954_pm_ops = {
+	SET_SYSTEM_SLEEP_PM_OPS(pm_runtime_force_suspend,
+				pm_runtime_force_resume)
+	SET_RUNTIME_PM_OPS(ds90ub954_runtime_suspend,
+			   ds90ub954_runtime_resume, NULL)
+};
+
+static ssize_t link_power_show(struct device *dev,
+			       struct device_attribute *attr, char *buf)
+{
+	struct ds90ub954_priv *priv = dev_get_drvdata(dev);
+	struct ds90ub954_pm *pm = &priv->pm;
+	int len;
+
+	mutex_lock(&pm->lock);
+	len = scnprintf(buf, PAGE_SIZE,
+			"runtime: %s\nhold: %s\nsuspends: %u\nresumes: %u\n"
+			"resume failed: %u\nreplay: %u us (%u writes)\n"
+			"lock: %u us\nresume: %u us\nports active: %d\n"
+			"port gates: %u\n",
+			pm_runtime_suspended(dev) ? "suspended" : "active",
+			pm->hold ? "yes" : "no", pm->suspends, pm->resumes,
+			pm->resume_failed, pm->sync_us, pm->sync_writes,
+			pm->lock_us, pm->resume_us, pm->ports_active,
+			pm->port_gates);
+	mutex_unlock(&pm->lock);
+	return len;
+}
+
+/* 0: drop the reference of the driver, the device may suspend; 1: resume */
+static ssize_t link_power_store(struct device *dev,
+				struct device_attribute *attr,
+				const char *buf, size_t count)
+{
+	struct ds90ub954_priv *priv = dev_get_drvdata(dev);
+	struct ds90ub954_pm *pm = &priv->pm;
+	bool on;
+	int err;
+
+	err = kstrtobool(buf, &on);
+	if(err)
+		return err;
+
+	mutex_lock(&pm->lock);
+	if(on && !pm->hold) {
+		err = pm_runtime_resume_and_get(dev);
+		if(!err)
+			pm->hold = true;
+	} else if(!on && pm->hold) {
+		pm->hold = false;
+		pm_runtime_put(dev);
 	}
-	return PAGE_SIZE;
+	mutex_unlock(&pm->lock);
+	return err ? err : count;
 }
-static DEVICE_ATTR(test_pattern_des, 0664,test_pattern_show_des,
-		   test_pattern_set_des);
-#endif
+
+static DEVICE_ATTR_RW(link_power);
 
 /*------------------------------------------------------------------------------
- * DS90UB953 FUNCTIONS
+ * PORT POWER
  *----------------------------------------------------------------------------*/
 
-static int ds90ub953_read(struct ds90ub953_priv *priv, unsigned int reg,
-			  unsigned int *val)
+/*
+ * An rx port is powered while it has consumers. The first consumer enables
+ * the receiver and csi forwarding and waits for lock and back channel, the
+ * last one disables both again. Over a port gate the serializer keeps its
+ * configuration; it is replayed if the deserializer was suspended while the
+ * port was gated. The csi tx goes to its sleep state when no port is
+ * powered. Every powered port holds a runtime pm reference.
+ */
+
+/* csi tx outputs follow OUTPUT_ENABLE, in the sleep state while cleared. The
+ * other bits, e.g. RX_PARITY_CHECKER_ENABLE, are kept */
+static int ds90ub954_csi_tx_power(struct ds90ub954_priv *priv, bool on)
 {
-	int err;
-	err = regmap_read(priv->regmap, reg, val);
-	if(err) {
-		dev_err(&priv->client->dev,
-			"Cannot read subdev 0x%02x register 0x%02x (%d)!\n",
-			priv->client->addr, reg, err);
-	}
-	return err;
+	return ds90ub954_update_bits(priv, TI954_REG_GENERAL_CFG,
+				     (1<<TI954_OUTPUT_SLEEP_STATE_SELECT)|
+				     (1<<TI954_OUTPUT_ENABLE)|
+				     (1<<TI954_OUTPUT_EN_MODE),
+				     (1<<TI954_OUTPUT_SLEEP_STATE_SELECT)|
+				     (on<<TI954_OUTPUT_ENABLE)|
+				     (1<<TI954_OUTPUT_EN_MODE));
 }
 
-static int ds90ub953_write(const struct ds90ub953_priv *priv, unsigned int reg,
-			   unsigned int val)
+static int ds90ub954_port_power_on(struct ds90ub954_priv *priv,
+				   struct ds90ub953_priv *ser)
 {
+	int rx_port = ser->rx_channel;
 	int err;
-	err = regmap_write(priv->regmap, reg, val);
-	if(err) {
-		dev_err(&priv->parent->client->dev,
-			"Cannot write subdev 0x%02x register 0x%02x (%d)!\n",
-			priv->client->addr, reg, err);
-	}
-	return err;
+
+	err = ds90ub954_update_bits(priv, TI954_REG_RX_PORT_CTL,
+				    (1<<(TI954_PORT0_EN+rx_port)),
+				    (1<<(TI954_PORT0_EN+rx_port)));
+	if(unlikely(err))
+		return err;
+	ds90ub954_port_set_state(priv, rx_port, PORT_TRAINING);
+
+	err = ds90ub954_port_bring_up(priv, ser);
+	if(unlikely(err))
+		return err;
+
+	err = ds90ub954_update_bits(priv, TI954_REG_FWD_CTL1,
+				    (1<<(TI954_FWD_PORT0_DIS+rx_port)), 0);
+	if(unlikely(err))
+		return err;
+	ds90ub954_port_set_state(priv, rx_port, PORT_STREAMING);
+	return 0;
 }
 
-static int ds90ub953_disable_testpattern(struct ds90ub953_priv *priv)
+static int ds90ub954_port_power_off(struct ds90ub954_priv *priv,
+				    struct ds90ub953_priv *ser)
 {
-	struct device *dev = &priv->client->dev;
-	int err = 0;
-	/* Indirect Pattern Gen Registers */
-	err = ds90ub953_write(priv, 0xB0, 0x00);
-	if(err)
-		goto init_err;
-	err = ds90ub953_write(priv, 0xB1, TI954_REG_IA_PGEN_CTL);
-	if(err)
-		goto init_err;
-	err = ds90ub953_write(priv, 0xB2, (0<<TI954_PGEB_ENABLE));
-	if(err)
-		goto init_err;
-init_err:
-	dev_info(dev, "%s: disable test pattern failed\n", __func__);
-	return err;
+	int rx_port = ser->rx_channel;
+	int err;
+
+	err = ds90ub954_update_bits(priv, TI954_REG_FWD_CTL1,
+				    (1<<(TI954_FWD_PORT0_DIS+rx_port)),
+				    (1<<(TI954_FWD_PORT0_DIS+rx_port)));
+	if(unlikely(err))
+		return err;
+	err = ds90ub954_update_bits(priv, TI954_REG_RX_PORT_CTL,
+				    (1<<(TI954_PORT0_EN+rx_port)), 0);
+	if(unlikely(err))
+		return err;
+	ds90ub954_port_set_state(priv, rx_port, PORT_DISABLED);
+	priv->pm.port_gates++;
+	return 0;
 }
 
-static int ds90ub953_init_testpattern(struct ds90ub953_priv *priv)
+/* take a consumer reference of the rx port of a serializer */
+static int ds90ub954_port_power_get(struct ds90ub954_priv *priv,
+				    struct ds90ub953_priv *ser)
 {
 	struct device *dev = &priv->client->dev;
+	struct ds90ub954_pm *pm = &priv->pm;
+	int rx_port = ser->rx_channel;
 	int err = 0;
-	int i;
-	for(i = 0; i < ARRAY_SIZE(ds90ub95x_tp_reg_val); i += 2) {
 
-		err = ds90ub953_write(priv, ds90ub95x_tp_reg_val[i],
-					    ds90ub95x_tp_reg_val[i+1]);
-		if(unlikely(err)) {
-			dev_info(dev, "%s: enable test pattern failed\n", __func__);
-			return err;
-		}
+	mutex_lock(&pm->lock);
+	if(pm->port_users[rx_port]) {
+		pm->port_users[rx_port]++;
+		goto get_unlock;
+	}
+
+	/* the port has no users yet, so a resume leaves it gated */
+	err = pm_runtime_resume_and_get(dev);
+	if(unlikely(err))
+		goto get_unlock;
+
+	if(pm->ports_active++ == 0) {
+		err = ds90ub954_csi_tx_power(priv, true);
+		if(unlikely(err))
+			goto get_tx_err;
+	}
+
+	err = ds90ub954_port_power_on(priv, ser);
+	if(unlikely(err)) {
+		dev_warn(dev, "%s: rx_port %i: power on failed (%d)\n",
+			 __func__, rx_port, err);
+		ds90ub954_port_set_state(priv, rx_port, PORT_FAULT);
+		ds90ub954_port_power_off(priv, ser);
+		goto get_tx_err;
 	}
-	dev_info(dev, "%s: enable test pattern successful\n", __func__);
+	pm->port_users[rx_port] = 1;
+	goto get_unlock;
+
+get_tx_err:
+	if(--pm->ports_active == 0)
+		ds90ub954_csi_tx_power(priv, false);
+	pm_runtime_put(dev);
+get_unlock:
+	mutex_unlock(&pm->lock);
 	return err;
 }
 
-#ifdef ENABLE_SYSFS_TP
-static ssize_t test_pattern_show_ser(struct device *dev,
-				     struct device_attribute *attr, char *buf)
+static void ds90ub954_port_power_put(struct ds90ub954_priv *priv,
+				     struct ds90ub953_priv *ser)
 {
-	struct ds90ub953_priv *priv;
-	priv = dev_get_drvdata(dev);
-	return snprintf(buf, PAGE_SIZE,
-			"Test Pattern is set to: %i\n", priv->test_pattern);
+	struct ds90ub954_pm *pm = &priv->pm;
+	int rx_port = ser->rx_channel;
+
+	mutex_lock(&pm->lock);
+	if(WARN_ON(pm->port_users[rx_port] == 0) ||
+	   --pm->port_users[rx_port])
+		goto put_unlock;
+
+	ds90ub954_port_power_off(priv, ser);
+	if(--pm->ports_active == 0)
+		ds90ub954_csi_tx_power(priv, false);
+	pm_runtime_put(&priv->client->dev);
+put_unlock:
+	mutex_unlock(&pm->lock);
 }
 
-static ssize_t test_pattern_set_ser(struct device *dev,
-				    struct device_attribute *attr,
-				    const char *buf, size_t count)
+/*
+ * Ports initialized by probe are powered with one reference of the driver.
+ * With hot-plug, so are the configured ports without a camera.
+ */
+static void ds90ub954_port_power_init(struct ds90ub954_priv *priv)
 {
-	struct ds90ub953_priv *priv;
-	int testpat;
-
-	priv = dev_get_drvdata(dev);
+	struct ds90ub953_priv *ser;
+	int i;
 
-	sscanf(buf, "%d", &testpat);
-	if(testpat > 1 || testpat < 0) {
-		dev_info(dev,
-			 "Invalid value: %i for test pattern (0/1)\n", testpat);
-		return PAGE_SIZE;
-	}
-	if(testpat == 1) {
-		dev_info(dev, "enabling testpattern for deserializer\n");
-		priv->test_pattern = 1;
-		ds90ub953_init_testpattern(priv);
-	} else {
-		dev_info(dev, "disabling testpattern for deserializer\n");
-		ds90ub953_disable_testpattern(priv);
+	for(i = 0; i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(!ser || (ser->initialized == 0 &&
+			    !(ser->configured && priv->hotplug.poll_ms)))
+			continue;
+		ser->power_hold = true;
+		priv->pm.port_users[ser->rx_channel] = 1;
+		priv->pm.ports_active++;
+		pm_runtime_get_noresume(&priv->client->dev);
 	}
-	return PAGE_SIZE;
 }
-static DEVICE_ATTR(test_pattern_ser, 0664, test_pattern_show_ser,
-		   test_pattern_set_ser);
 
-#endif
+static ssize_t port_power_show(struct device *dev,
+			       struct device_attribute *attr, char *buf)
+{
+	struct ds90ub953_priv *ser = dev_get_drvdata(dev);
+	struct ds90ub954_priv *priv = ser->parent;
+	int len;
+
+	mutex_lock(&priv->pm.lock);
+	len = scnprintf(buf, PAGE_SIZE, "hold: %s\nusers: %d\nstate: %s\n",
+			ser->power_hold ? "yes" : "no",
+			priv->pm.port_users[ser->rx_channel],
+			ds90ub954_port_state_names[
+				ds90ub954_port_get_state(priv,
+							 ser->rx_channel)]);
+	mutex_unlock(&priv->pm.lock);
+	return len;
+}
 
-static int ds90ub953_init(struct ds90ub953_priv *priv)
+/* 0: drop the reference of the driver, the port may be gated; 1: power up */
+static ssize_t port_power_store(struct device *dev,
+				struct device_attribute *attr,
+				const char *buf, size_t count)
 {
-	struct device *dev = &priv->client->dev;
-	int val, dev_id, i;
-	int err = 0;
-	char id_code[TI953_RX_ID_LENGTH + 1];
+	struct ds90ub953_priv *ser = dev_get_drvdata(dev);
+	bool on, hold;
+	int err;
 
-	dev_info(dev, "%s: start\n", __func__);
+	err = kstrtobool(buf, &on);
+	if(err)
+		return err;
 
-	err = ds90ub953_read(priv, TI953_REG_I2C_DEV_ID, &val);
-	if(unlikely(err))
-		goto init_err;
+	/* the attribute is one consumer, xchg keeps its reference single */
+	hold = xchg(&ser->power_hold, on);
+	if(on && !hold) {
+		err = ds90ub954_port_power_get(ser->parent, ser);
+		if(err)
+			WRITE_ONCE(ser->power_hold, false);
+	} else if(!on && hold) {
+		ds90ub954_port_power_put(ser->parent, ser);
+	}
+	return err ? err : count;
+}
 
-	dev_id = (unsigned char)val;
+static DEVICE_ATTR_RW(port_power);
 
-	memset(id_code, 0, sizeof(id_code));
-	for(i = 0; i < TI953_RX_ID_LENGTH; i++) {
-		err = ds90ub953_read(priv, TI953_REG_FPD3_RX_ID0 + i, &val);
-		if(unlikely(err))
-			goto init_err;
-		id_code[i] = (char)val;
-	}
-	dev_info(dev, "%s: device ID: 0x%x, code:%s\n", __func__, dev_id, id_code);
+/*------------------------------------------------------------------------------
+ * PARITY ALARMS
+ *----------------------------------------------------------------------------*/
 
-	 /* set to csi lanes */
-	switch(priv->csi_lane_count) {
-	case 1:
-		val = TI953_CSI_LANE_SEL1;
-		break;
-	case 2:
-		val = TI953_CSI_LANE_SEL2;
-		break;
-	default:
-		val = TI953_CSI_LANE_SEL4;
-		break;
+/*
+ * The deserializer counts forward channel parity errors per rx port in
+ * RX_PAR_ERR and raises INTB when the count passes PAR_ERR_THOLD. The count
+ * is read, which clears it, and divided by the time since the last read.
+ * A change uevent with the port, the count and the rate is sent at most
+ * every PAR_EVENT_MIN_MS per port, so a failing cable is reported before
+ * frames are dropped without polling the counters.
+ */
+
+/* called from the INTB handling when RX_PAR_ERR passed the threshold */
+static void ds90ub954_par_alarm(struct ds90ub954_priv *priv, int rx_port)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub954_port_counters *cnt = &priv->counters[rx_port];
+	char port_env[16], count_env[24], rate_env[32];
+	char *envp[] = { "EVENT=parity", port_env, count_env, rate_env, NULL };
+	unsigned int rate;
+	int hi, lo, count, err;
+	bool event;
+	ktime_t now;
+	s64 ms;
+
+	/* RX_PAR_ERR clears on read, reg_lock keeps the snapshot from
+	 * reading it in between, like there */
+	mutex_lock(&priv->reg_lock);
+	err = ds90ub954_select_rx_port_locked(priv, rx_port);
+	if(!err)
+		err = ds90ub954_read(priv, TI954_REG_RX_PAR_ERR_HI, &hi);
+	if(!err)
+		err = ds90ub954_read(priv, TI954_REG_RX_PAR_ERR_LO, &lo);
+	if(unlikely(err)) {
+		mutex_unlock(&priv->reg_lock);
+		return;
 	}
-	err = ds90ub953_write(priv, TI953_REG_GENERAL_CFG,
-			      (1<<TI953_I2C_STRAP_MODE) |
-			      (1<<TI953_CRC_TX_GEN_ENABLE) |
-			      (val<<TI953_CSI_LANE_SEL) |
-			      (priv->conts_clk<<TI953_CONTS_CLK));
-	if(unlikely(err))
-		goto init_err;
 
-	//Set GPIO0 as output
-	err = ds90ub953_write(priv, TI953_REG_GPIO_CTRL, 0x1E);
+	now = ktime_get();
+	count = (hi<<8) | lo;
+	ms = max_t(s64, ktime_ms_delta(now, cnt->par_read), 1);
+	cnt->par_err += count;
+	cnt->par_rate = div64_u64((u64)count * 1000, ms);
+	cnt->par_read = now;
+	cnt->par_alarms++;
+	rate = cnt->par_rate;
+	event = ktime_ms_delta(now, cnt->par_event) >= PAR_EVENT_MIN_MS;
+	if(event)
+		cnt->par_event = now;
+	mutex_unlock(&priv->reg_lock);
+
+	if(!event)
+		return;
+
+	dev_warn(dev, "%s: rx_port %i: %i parity errors in %lld ms (%u/s)\n",
+		 __func__, rx_port, count, ms, rate);
+	snprintf(port_env, sizeof(port_env), "RX_PORT=%d", rx_port);
+	snprintf(count_env, sizeof(count_env), "PAR_ERR=%d", count);
+	snprintf(rate_env, sizeof(rate_env), "PAR_ERR_RATE=%u", rate);
+	kobject_uevent_env(&dev->kobj, KOBJ_CHANGE, envp);
+}
 
-	/* set clock output frequency */
-	err = ds90ub953_write(priv, TI953_REG_CLKOUT_CTRL0,
-			      (priv->hs_clk_div<<TI953_HS_CLK_DIV) |
-			      (priv->div_m_val<<TI953_DIV_M_VAL));
-	if(unlikely(err))
-		goto init_err;
+static ssize_t parity_show(struct device *dev, struct device_attribute *attr,
+			   char *buf)
+{
+	struct ds90ub953_priv *ser = dev_get_drvdata(dev);
+	struct ds90ub954_port_counters *cnt =
+		&ser->parent->counters[ser->rx_channel];
+
+	return scnprintf(buf, PAGE_SIZE,
+			 "threshold: %u\nalarms: %u\nrate: %u/s\nerrors: %u\n",
+			 ser->par_err_thold, cnt->par_alarms, cnt->par_rate,
+			 cnt->par_err);
+}
 
-	err = ds90ub953_write(priv, TI953_REG_CLKOUT_CTRL1,
-			      priv->div_n_val<<TI953_DIV_N_VAL);
-	if(unlikely(err))
-		goto init_err;
+/* new threshold, 0 disables the alarm, applied now if the port is up */
+static ssize_t parity_store(struct device *dev, struct device_attribute *attr,
+			    const char *buf, size_t count)
+{
+	struct ds90ub953_priv *ser = dev_get_drvdata(dev);
+	struct ds90ub954_priv *priv = ser->parent;
+	u16 thold;
+	int err;
 
-	/* setup GPIOs to input/output */
-	val = 0;
-	if(priv->gpio0_oe)
-		val |= 0b00010000;
-	else
-		val |= 0b00000001;
+	err = kstrtou16(buf, 0, &thold);
+	if(err)
+		return err;
 
-	if(priv->gpio1_oe)
-		val |= 0b00100000;
-	else
-		val |= 0b00000010;
+	/* pm.lock keeps hot-plug from bringing the port up meanwhile */
+	mutex_lock(&priv->pm.lock);
+	ser->par_err_thold = thold;
+	if(ser->initialized)
+		err = ds90ub954_init_par_err(priv, ser);
+	mutex_unlock(&priv->pm.lock);
+	return err ? err : count;
+}
 
-	if(priv->gpio2_oe)
-		val |= 0b01000000;
-	else
-		val |= 0b00000100;
+static DEVICE_ATTR_RW(parity);
 
-	if(priv->gpio3_oe)
-		val |= 0b10000000;
-	else
-		val |= 0b00001000;
+/*------------------------------------------------------------------------------
+ * BACK CHANNEL
+ *----------------------------------------------------------------------------*/
 
-	err = ds90ub953_write(priv, TI953_REG_GPIO_CTRL, val);
-	if(unlikely(err))
-		goto init_err;
+/*
+ * The BCC watchdogs of the deserializer and the serializers are set from
+ * bcc-watchdog-ms. CRC and sequence errors of the back channel are reported
+ * per rx port on INTB. Only the back channel of the failing port is
+ * re-initialized, in a work: the receiver of the port is disabled and enabled
+ * again, the serializer alias is rewritten and the serializer side restored.
+ * The other ports keep streaming. Without an INTB interrupt the status is
+ * read with the hot-plug poll, which then runs even with hot-plug disabled.
+ */
 
-	err = ds90ub953_write(priv, TI953_REG_LOCAL_GPIO_DATA,
-			      (0xf<<TI953_GPIO_RMTEN));
-	if(unlikely(err))
-		goto init_err;
+/*
+ * Read and clear the port interrupts, returns true if INTB was asserted.
+ * Back channel errors are handled here, parity alarms in ds90ub954_par_alarm.
+ */
+static bool ds90ub954_intb_handle(struct ds90ub954_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub954_port_counters *cnt;
+	int rx_port, sts, val, err;
+	bool pending = false;
 
-	err = ds90ub953_write(priv, TI953_REG_BCC_CONFIG,
-			      (0x1<<TI953_I2C_PASS_THROUGH_ALL) |
-			      (0x1<<TI953_RX_PARITY_CHECKER_ENABLE));
-	if(unlikely(err))
-		goto init_err;
+	err = ds90ub954_read(priv, TI954_REG_INTERRUPT_STS, &sts);
+	if(unlikely(err) || !(sts & (1<<TI954_INTERRUPT_STS)))
+		return false;
 
-	/* check if test pattern should be turned on*/
-	if(priv->test_pattern == 1) {
-		dev_info(dev,"%s: serializer rx_port %i init testpattern\n",
-			 __func__, priv->rx_channel);
-		err = ds90ub953_init_testpattern(priv);
+	for(rx_port = 0; rx_port < priv->chip->num_rx_ports; rx_port++) {
+		if(!(sts & (1<<(TI954_IS_RX0+rx_port))))
+			continue;
+		err = ds90ub954_read_rx_port(priv, rx_port,
+					     TI954_REG_PORT_ISR_LO, &val);
+		if(!err && (val & (1<<TI954_IS_PFD3_PAR_ERR)))
+			ds90ub954_par_alarm(priv, rx_port);
+		err = ds90ub954_read_rx_port(priv, rx_port,
+					     TI954_REG_PORT_ISR_HI, &val);
 		if(unlikely(err))
-			dev_info(dev,
-				 "%s: serializer rx_port %i init testpattern failed\n",
-				 __func__, priv->rx_channel);
+			continue;
+		cnt = &priv->counters[rx_port];
+		if(val & (1<<TI954_IS_BCC_CRC_ERR))
+			cnt->bcc_crc_err++;
+		if(val & (1<<TI954_IS_BCC_CEQ_ERR))
+			cnt->bcc_seq_err++;
+		if(!(val & ((1<<TI954_IS_BCC_CRC_ERR)|
+			    (1<<TI954_IS_BCC_CEQ_ERR))))
+			continue;
+		dev_dbg(dev, "%s: rx_port %i: back channel error 0x%02x\n",
+			__func__, rx_port, val);
+		set_bit(rx_port, &priv->bcc.pending);
+		pending = true;
 	}
-
-#ifdef ENABLE_SYSFS_TP
-	/* device attribute on sysfs */
-	dev_set_drvdata(dev, priv);
-	err = device_create_file(dev, &dev_attr_test_pattern_ser);
-	if(unlikely(err < 0))
-		dev_err(dev, "serializer %i cant create device attribute %s\n",
-			priv->rx_channel, dev_attr_test_pattern_ser.attr.name);
-#endif
-	dev_info(dev, "%s: successful\n", __func__);
-
-init_err:
-	return err;
+	if(pending)
+		schedule_work(&priv->bcc.work);
+	return true;
 }
 
-static void ds90ub953_free(struct ds90ub954_priv *priv)
+static irqreturn_t ds90ub954_intb_irq(int irq, void *dev_id)
 {
-	int i;
-	for(i = 0; i < priv->num_ser; i++) {
-		if(priv->ser[i])
-			i2c_unregister_device(priv->ser[i]->client);
-	}
+	struct ds90ub954_priv *priv = dev_id;
+	bool handled;
+	int ref;
+
+	/* a level interrupt has to be acknowledged whenever the device is
+	 * powered, also without runtime pm. Powered down INTB is released. */
+	ref = ds90ub954_pm_get_active(priv);
+	if(ref < 0)
+		return IRQ_HANDLED;
+	handled = ds90ub954_intb_handle(priv);
+	ds90ub954_pm_put_active(priv, ref);
+	return handled ? IRQ_HANDLED : IRQ_NONE;
 }
 
-static int ds90ub953_regmap_init(struct ds90ub954_priv *priv, int ser_nr)
+/* restart the back channel of one port, called with pm.lock held */
+static void ds90ub954_bcc_reinit(struct ds90ub954_priv *priv,
+				 struct ds90ub953_priv *ser)
 {
-	struct regmap *new_regmap = NULL;
 	struct device *dev = &priv->client->dev;
-	int err = 0;
+	struct ds90ub954_port_counters *cnt;
+	enum ds90ub954_port_state state;
+	int rx_port = ser->rx_channel;
+	int err;
 
-	/* setup now regmap */
-	new_regmap = devm_regmap_init_i2c(priv->ser[ser_nr]->client,
-					  &ds90ub953_regmap_config);
-	if(IS_ERR_VALUE(priv->regmap)) {
-		err = PTR_ERR(priv->regmap);
-		dev_err(dev, "regmap init of subdevice failed (%d)\n", err);
-		return err;
-	}
-	dev_info(dev, "%s init regmap done\n", __func__);
+	cnt = &priv->counters[rx_port];
+	state = ds90ub954_port_get_state(priv, rx_port);
 
-	priv->ser[ser_nr]->regmap = new_regmap;
-	return err;
-}
+	/* BC_ALWAYS_ON only selects whether the back channel runs without
+	 * lock, it doesn't restart it. A disabled receiver is powered down
+	 * with its back channel, the serializer keeps its configuration. */
+	err = ds90ub954_port_power_off(priv, ser);
+	if(unlikely(err))
+		goto reinit_err;
+	ds90ub954_msleep(priv, PM_LOCK_POLL_MS);
+	/* returns once the serializer answers over the new back channel */
+	err = ds90ub954_port_power_on(priv, ser);
+	if(unlikely(err))
+		goto reinit_err;
+	err = ds90ub954_write_rx_port(priv, rx_port, TI954_REG_SER_ALIAS_ID,
+				      (ser->i2c_address<<TI954_SER_ALIAS_ID));
+	if(unlikely(err))
+		goto reinit_err;
 
-static int ds90ub953_alloc(struct ds90ub954_priv *priv, int ser_nr)
-{
-	struct ds90ub953_priv *priv_ser;
-	struct device *dev = &priv->client->dev;
+	mutex_lock(&ser->lock);
+	err = ds90ub953_init_bcc(ser);
+	mutex_unlock(&ser->lock);
+	if(unlikely(err))
+		goto reinit_err;
+
+	cnt->bcc_reinit++;
+	ds90ub954_port_set_state(priv, rx_port, state);
+	dev_dbg(dev, "%s: rx_port %i: back channel restarted\n", __func__,
+		rx_port);
+	return;
+
+reinit_err:
+	cnt->bcc_reinit_failed++;
+	ds90ub954_port_set_state(priv, rx_port, PORT_FAULT);
+	dev_warn(dev, "%s: rx_port %i: back channel restart failed (%d)\n",
+		 __func__, rx_port, err);
+}
 
-	priv_ser = devm_kzalloc(dev, sizeof(struct ds90ub953_priv), GFP_KERNEL);
-	if(!priv)
-		return -ENOMEM;
+static void ds90ub954_bcc_work(struct work_struct *work)
+{
+	struct ds90ub954_bcc *bcc = container_of(work, struct ds90ub954_bcc,
+						 work);
+	struct ds90ub954_priv *priv = container_of(bcc, struct ds90ub954_priv,
+						   bcc);
+	struct ds90ub953_priv *ser;
+	int i, rx_port, ref;
+
+	/* the ports are brought up again on resume anyway */
+	ref = ds90ub954_pm_get_active(priv);
+	if(ref < 0) {
+		xchg(&bcc->pending, 0);
+		return;
+	}
 
-	priv->ser[ser_nr] = priv_ser;
-	priv->ser[ser_nr]->initialized = 0;
-	return 0;
+	for(i = 0; i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(!ser)
+			continue;
+		rx_port = ser->rx_channel;
+		if(!test_and_clear_bit(rx_port, &bcc->pending))
+			continue;
+		/* ports without a serializer are left to hot-plug */
+		mutex_lock(&priv->pm.lock);
+		if(priv->pm.port_users[rx_port] && ser->initialized)
+			ds90ub954_bcc_reinit(priv, ser);
+		mutex_unlock(&priv->pm.lock);
+	}
+	ds90ub954_pm_put_active(priv, ref);
 }
 
-static int ds90ub953_i2c_client(struct ds90ub954_priv *priv, int ser_nr,
-				int addr)
+/* INTB interrupt, the hot-plug poll reads the status if there is none */
+static void ds90ub954_bcc_init(struct ds90ub954_priv *priv)
 {
-	struct i2c_client *new_client = NULL;
 	struct device *dev = &priv->client->dev;
+	int irq, err;
 
-	struct i2c_board_info *ser_board_info;
-	ser_board_info = devm_kzalloc(dev, sizeof(struct i2c_board_info), GFP_KERNEL);
-	ser_board_info->addr = addr;
+	if(!priv->intb_gpio)
+		return;
 
-	new_client = i2c_new_client_device(priv->client->adapter, ser_board_info);
-	if(!new_client) {
-		dev_warn(dev, "failed to add i2c client\n");
-		return -1;
+	irq = gpiod_to_irq(priv->intb_gpio);
+	if(irq < 0) {
+		dev_dbg(dev, "%s: intb-gpio has no irq, polling\n", __func__);
+		return;
 	}
 
-	priv->ser[ser_nr]->client = new_client;
-	dev_info(dev, "%s init client done\n", __func__);
-	return 0;
+	err = devm_request_threaded_irq(dev, irq, NULL, ds90ub954_intb_irq,
+					IRQF_TRIGGER_LOW | IRQF_ONESHOT,
+					"ds90ub954_intb", priv);
+	if(unlikely(err)) {
+		dev_err(dev, "%s: unable to request intb irq (%d)\n", __func__,
+			err);
+		return;
+	}
+	priv->bcc.irq = irq;
 }
 
-static int ds90ub953_parse_dt(struct i2c_client *client,
-			      struct ds90ub954_priv *priv)
-{
-	struct device *dev = &client->dev;
-	struct device_node *des = dev->of_node;
-	struct device_node *ser;
-	struct device_node *sers;
-	struct of_phandle_args i2c_addresses;
-	struct ds90ub953_priv *ds90ub953;
-	int i = 0;
+/*------------------------------------------------------------------------------
+ * HOT-PLUG
+ *----------------------------------------------------------------------------*/
 
-	u32 val = 0;
-	int err = 0;
-	int counter = 0;
-	priv->num_ser = 0;
+/*
+ * The lock of every powered rx port with a configured serializer is polled.
+ * A port that locks is brought up like in probe with the serializer config
+ * from the device tree, then the remote devices of the serializer are
+ * instantiated. When a port loses its lock in two polls in a row, the remote
+ * devices are removed. The other ports are not touched. The remote device
+ * clients are only changed by probe, remove and the hot-plug work.
+ */
 
-	/* get serializers device_node from dt */
-	sers = of_get_child_by_name(des, "serializers");
-	if(!sers) {
-		dev_info(dev, "%s: no serializers found in device tree\n",
-			 __func__);
-		return 0;
-	}
+/* register the serializer gpiochip, CLK_OUT and attributes once */
+static void ds90ub953_register(struct ds90ub953_priv *priv)
+{
+	struct device *dev = &priv->client->dev;
+	int err;
 
-	dev_info(dev, "%s: parsing serializers device tree:\n", __func__);
+	if(priv->registered)
+		return;
+	priv->registered = true;
 
-	/* go through all serializers in list */
-	for_each_child_of_node(sers, ser) {
+	ds90ub953_gpiochip_init(priv);
+	ds90ub953_clkout_register(priv);
 
-		if(counter >= NUM_SERIALIZER) {
-			dev_info(dev, "%s: too many serializers found in device tree\n",
-				 __func__);
+#ifdef ENABLE_SYSFS_TP
+	err = device_create_file(dev, &dev_attr_test_pattern_ser);
+	if(unlikely(err < 0))
+		dev_err(dev, "serializer %i cant create device attribute %s\n",
+			priv->rx_channel, dev_attr_test_pattern_ser.attr.name);
+#endif
+	err = device_create_file(dev, &dev_attr_i2c_alias);
+	if(unlikely(err < 0))
+		dev_err(dev, "serializer %i cant create device attribute %s\n",
+			priv->rx_channel, dev_attr_i2c_alias.attr.name);
+	err = device_create_file(dev, &dev_attr_reg_batch);
+	if(unlikely(err < 0))
+		dev_err(dev, "serializer %i cant create device attribute %s\n",
+			priv->rx_channel, dev_attr_reg_batch.attr.name);
+	err = device_create_file(dev, &dev_attr_port_power);
+	if(unlikely(err < 0))
+		dev_err(dev, "serializer %i cant create device attribute %s\n",
+			priv->rx_channel, dev_attr_port_power.attr.name);
+	err = device_create_file(dev, &dev_attr_parity);
+	if(unlikely(err < 0))
+		dev_err(dev, "serializer %i cant create device attribute %s\n",
+			priv->rx_channel, dev_attr_parity.attr.name);
+}
+
+/*
+ * Instantiate the children of the remote-devices node at their host alias.
+ * Not called with ser->lock held, a sensor probe may set the CLK_OUT rate.
+ */
+static void ds90ub954_remote_add(struct ds90ub954_priv *priv,
+				 struct ds90ub953_priv *ser)
+{
+	struct device *dev = &priv->client->dev;
+	struct device_node *remotes, *child;
+	struct i2c_board_info info;
+	struct i2c_client *client;
+	int alias;
+	u32 reg;
+
+	remotes = of_get_child_by_name(ser->np, "remote-devices");
+	if(!remotes)
+		return;
+
+	for_each_available_child_of_node(remotes, child) {
+		if(ser->remote_num >= NUM_REMOTE) {
+			dev_warn(dev, "%s: rx_port %i: more than %d remote devices\n",
+				 __func__, ser->rx_channel, NUM_REMOTE);
+			of_node_put(child);
 			break;
 		}
-
-		/* allocate memory for serializer */
-		err = ds90ub953_alloc(priv, counter);
-		if(err) {
-			dev_info(dev, "%s: - allocating ds90ub953 failed\n",
-				 __func__);
-			goto next;
+		if(of_property_read_u32(child, "reg", &reg)) {
+			dev_warn(dev, "%s: %pOF: no reg property\n", __func__,
+				 child);
+			continue;
 		}
-		ds90ub953 = priv->ser[counter];
-
-		/* get rx-channel */
-		err = of_property_read_u32(ser, "rx-channel", &val);
-		if(err) {
-			dev_info(dev, "%s: - rx-channel property not found\n",
-				 __func__);
-			/* default value: 0 */
-			ds90ub953->rx_channel = 0;
-			dev_info(dev, "%s: rx-channel set to default val: 0\n",
-				 __func__);
-		} else {
-			/* set rx-channel*/
-			ds90ub953->rx_channel = val;
-			dev_info(dev,"%s: - serializer rx-channel: %i\n",
-				 __func__, val);
+		memset(&info, 0, sizeof(info));
+		if(of_modalias_node(child, info.type, sizeof(info.type)) < 0) {
+			dev_warn(dev, "%s: %pOF: no compatible\n", __func__,
+				 child);
+			continue;
 		}
 
-		if(of_property_read_bool(ser, "test-pattern")) {
-			dev_info(dev, "%s: - test-pattern enabled\n", __func__);
-			ds90ub953->test_pattern = 1;
-		} else {
-			/* default value: 0 */
-			ds90ub953->test_pattern = 0;
-			dev_info(dev,"%s: -test-pattern disabled\n", __func__);
+		/* the client's slot is pinned until ds90ub954_remote_remove */
+		alias = ds90ub954_alias_pin(priv, ser, reg, ALIAS_PIN_REMOTE);
+		if(alias < 0) {
+			dev_warn(dev, "%s: %pOF: no alias for 0x%02x (%d)\n",
+				 __func__, child, reg, alias);
+			continue;
 		}
-
-		err = of_property_read_u32(ser, "csi-lane-count", &val);
-		if(err) {
-			dev_info(dev, "%s: - csi-lane-count property not found\n",
-				 __func__);
-			/* default value: 4 */
-			ds90ub953->csi_lane_count = 4;
-			dev_info(dev, "%s: csi-lane-count set to default val: 4\n",
-				 __func__);
-		} else {
-			/* set csi-lane-count*/
-			ds90ub953->csi_lane_count = val;
-			dev_info(dev, "%s: - csi-lane-count %i\n", __func__, val);
+		info.addr = alias;
+		info.of_node = child;
+
+		client = i2c_new_client_device(priv->client->adapter, &info);
+		if(IS_ERR(client)) {
+			dev_warn(dev, "%s: %pOF: adding client failed (%ld)\n",
+				 __func__, child, PTR_ERR(client));
+			ds90ub954_alias_unpin(priv, ser, alias,
+					      ALIAS_PIN_REMOTE);
+			continue;
 		}
+		ser->remote[ser->remote_num++] = client;
+		dev_dbg(dev, "%s: rx_port %i: %s 0x%02x at alias 0x%02x\n",
+			__func__, ser->rx_channel, info.type, reg, alias);
+	}
+	of_node_put(remotes);
+}
 
-		/* GPIO output enable */
-		err = of_property_read_u32(ser, "gpio0-output-enable", &val);
-		if(err) {
-			dev_info(dev, "%s: - gpio0-output-enable property not found\n",
-				 __func__);
-			/* default value: 0 */
-			ds90ub953->gpio0_oe = 0;
-			dev_info(dev, "%s: gpio0-output-enable to default val: 0\n",
-				 __func__);
-		} else {
-			/* set gpio0-output-enable*/
-			ds90ub953->gpio0_oe = val;
-			dev_info(dev, "%s: - gpio0-output-enable %i\n",
-				 __func__, val);
-		}
+static void ds90ub954_remote_remove(struct ds90ub953_priv *ser)
+{
+	struct i2c_client *client;
+
+	while(ser->remote_num > 0) {
+		ser->remote_num--;
+		client = ser->remote[ser->remote_num];
+		ds90ub954_alias_unpin(ser->parent, ser, client->addr,
+				      ALIAS_PIN_REMOTE);
+		i2c_unregister_device(client);
+		ser->remote[ser->remote_num] = NULL;
+	}
+}
 
-		err = of_property_read_u32(ser, "gpio1-output-enable", &val);
-		if(err) {
-			dev_info(dev, "%s: - gpio1-output-enable property not found\n",
-				 __func__);
+/* absent ports are retried at doubling intervals from poll_ms up to 8 s */
+static void ds90ub954_hotplug_backoff(struct ds90ub954_hotplug *hp, int rx_port)
+{
+	hp->backoff_ms[rx_port] = clamp(hp->backoff_ms[rx_port] * 2,
+					hp->poll_ms, HOTPLUG_BACKOFF_MAX_MS);
+	hp->next_poll[rx_port] = jiffies +
+				 msecs_to_jiffies(hp->backoff_ms[rx_port]);
+}
 
-			/* default value: 0 */
-			ds90ub953->gpio1_oe = 0;
-			dev_info(dev, "%s: gpio1-output-enable to default val: 0\n",
-				 __func__);
-		} else {
-			/* set gpio1-output-enable*/
-			ds90ub953->gpio1_oe = val;
-			dev_info(dev, "%s: - gpio1-output-enable %i\n",
-				 __func__, val);
-		}
+static void ds90ub954_hotplug_connect(struct ds90ub954_priv *priv,
+				      struct ds90ub953_priv *ser)
+{
+	struct device *dev = &priv->client->dev;
+	int rx_port = ser->rx_channel;
+	int err;
 
-		err = of_property_read_u32(ser, "gpio2-output-enable", &val);
-		if(err) {
-			dev_info(dev, "%s: - gpio2-output-enable property not found\n",
-				 __func__);
-			/* default value: 0 */
-			ds90ub953->gpio2_oe = 0;
-			dev_info(dev, "%s: gpio2-output-enable to default val: 0\n",
-				 __func__);
-		} else {
-			/* set gpio2-output-enable*/
-			ds90ub953->gpio2_oe = val;
-			dev_info(dev,"%s: - gpio2-output-enable %i\n", __func__,
-				 val);
-		}
+	err = ds90ub954_init_rx_port(priv, ser);
+	if(unlikely(err))
+		goto connect_err;
 
-		err = of_property_read_u32(ser, "gpio3-output-enable", &val);
-		if(err) {
-			dev_info(dev, "%s: - gpio3-output-enable property not found\n",
-				 __func__);
-			/* default value: 0 */
-			ds90ub953->gpio3_oe = 0;
-			dev_info(dev, "%s: gpio3-output-enable to default val: 0\n",
-				 __func__);
-		} else {
-			/* set gpio3-output-enable*/
-			ds90ub953->gpio3_oe = val;
-			dev_info(dev, "%s: - gpio3-output-enable %i\n",
-				 __func__, val);
-		}
+	mutex_lock(&ser->lock);
+	err = ds90ub953_init(ser);
+	if(!err)
+		ser->initialized = 1;
+	mutex_unlock(&ser->lock);
+	if(unlikely(err))
+		goto connect_err;
+
+	ds90ub953_register(ser);
+	ds90ub954_remote_add(priv, ser);
+	set_bit(rx_port, &priv->hotplug.present);
+	priv->hotplug.backoff_ms[rx_port] = 0;
+	priv->hotplug.connects++;
+	dev_info(dev, "%s: rx_port %i: serializer connected\n", __func__,
+		 rx_port);
+	return;
+
+connect_err:
+	ds90ub954_hotplug_backoff(&priv->hotplug, rx_port);
+	ds90ub954_port_set_state(priv, rx_port, PORT_FAULT);
+	dev_warn(dev, "%s: rx_port %i: bring-up failed (%d), retry in %u ms\n",
+		 __func__, rx_port, err, priv->hotplug.backoff_ms[rx_port]);
+}
 
-		/* GPIO output control */
-		err = of_property_read_u32(ser, "gpio0-control", &val);
-		if(err) {
-			dev_info(dev, "%s: - gpio0-control property not found\n",
-				 __func__);
-			/* default value: 0b1000 */
-			ds90ub953->gpio0_oc = 0b1000;
-			dev_info(dev, "%s: gpio0-control to default val: 0b1000\n",
-				 __func__);
-		} else {
-			/* set gpio0-control*/
-			ds90ub953->gpio0_oc = val;
-			dev_info(dev,"%s: - gpio0-control %i\n",
-				 __func__, val);
-		}
+static void ds90ub954_hotplug_disconnect(struct ds90ub954_priv *priv,
+					 struct ds90ub953_priv *ser)
+{
+	int rx_port = ser->rx_channel;
+
+	mutex_lock(&ser->lock);
+	ser->initialized = 0;
+	mutex_unlock(&ser->lock);
+
+	ds90ub954_remote_remove(ser);
+	clear_bit(rx_port, &priv->hotplug.present);
+	priv->hotplug.backoff_ms[rx_port] = 0;
+	priv->hotplug.next_poll[rx_port] = jiffies;
+	priv->hotplug.disconnects++;
+	/* the receiver stays on and waits for the next serializer */
+	ds90ub954_port_set_state(priv, rx_port, PORT_TRAINING);
+	dev_info(&priv->client->dev, "%s: rx_port %i: serializer disconnected\n",
+		 __func__, rx_port);
+}
 
-		err = of_property_read_u32(ser, "gpio1-control", &val);
-		if(err) {
-			dev_info(dev, "%s: - gpio1-control property not found\n",
-				 __func__);
+static void ds90ub954_hotplug_poll(struct ds90ub954_priv *priv,
+				   struct ds90ub953_priv *ser)
+{
+	struct ds90ub954_hotplug *hp = &priv->hotplug;
+	int rx_port = ser->rx_channel;
+	int present = test_bit(rx_port, &hp->present);
+	int val, locked, err;
 
-			/* default value: 0b1000 */
-			ds90ub953->gpio1_oc = 0b1000;
-			dev_info(dev, "%s: gpio1-control to default val: 0b1000\n",
-				 __func__);
-		} else {
-			/* set gpio1-control*/
-			ds90ub953->gpio1_oc = val;
-			dev_info(dev, "%s: - gpio1-control %i\n",
-				 __func__, val);
-		}
+	if(!present && time_before(jiffies, hp->next_poll[rx_port]))
+		return;
 
-		err = of_property_read_u32(ser, "gpio2-control", &val);
-		if(err) {
-			dev_info(dev, "%s: - gpio2-control property not found\n",
-				 __func__);
-			/* default value: 0b1000 */
-			ds90ub953->gpio2_oc = 0b1000;
-			dev_info(dev, "%s: gpio2-control to default val: 0b1000\n",
-				 __func__);
-		} else {
-			/* set gpio2-control*/
-			ds90ub953->gpio2_oc = val;
-			dev_info(dev, "%s: - gpio2-control %i\n",
-				 __func__, val);
-		}
+	err = ds90ub954_read_rx_port(priv, rx_port, TI954_REG_RX_PORT_STS1,
+				     &val);
+	if(unlikely(err))
+		return;
+	locked = val & (1<<TI954_LOCK_STS);
+
+	if(present) {
+		if(locked)
+			clear_bit(rx_port, &hp->lost);
+		else if(test_and_set_bit(rx_port, &hp->lost))
+			ds90ub954_hotplug_disconnect(priv, ser);
+	} else if(locked) {
+		clear_bit(rx_port, &hp->lost);
+		ds90ub954_hotplug_connect(priv, ser);
+	} else {
+		ds90ub954_hotplug_backoff(hp, rx_port);
+	}
+}
 
-		err = of_property_read_u32(ser, "gpio3-control", &val);
-		if(err) {
-			dev_info(dev, "%s: - gpio3-control property not found\n",
-				 __func__);
-			/* default value: 0b1000 */
-			ds90ub953->gpio3_oc = 0b1000;
-			dev_info(dev, "%s: gpio3-control to default val: 0b1000\n",
-				 __func__);
-		} else {
-			/* set gpio3-control*/
-			ds90ub953->gpio3_oc = val;
-			dev_info(dev, "%s: - gpio3-control %i\n",
-				 __func__, val);
-		}
+/* INTB is polled at the default interval when hot-plug is disabled */
+static unsigned int ds90ub954_hotplug_period_ms(struct ds90ub954_priv *priv)
+{
+	if(priv->hotplug.poll_ms)
+		return priv->hotplug.poll_ms;
+	return priv->bcc.irq < 0 ? HOTPLUG_POLL_DEFAULT_MS : 0;
+}
 
-		err = of_property_read_u32(ser, "hs-clk-div", &val);
-		if(err) {
-			dev_info(dev, "%s: - hs-clk-div property not found\n",
-				 __func__);
+static void ds90ub954_hotplug_work(struct work_struct *work)
+{
+	struct ds90ub954_hotplug *hp =
+		container_of(to_delayed_work(work), struct ds90ub954_hotplug,
+			     work);
+	struct ds90ub954_priv *priv =
+		container_of(hp, struct ds90ub954_priv, hotplug);
+	struct ds90ub953_priv *ser;
+	int i, ref;
+
+	/* nothing to detect while the device is powered down */
+	ref = ds90ub954_pm_get_active(priv);
+	if(ref < 0)
+		goto resched;
+
+	if(priv->bcc.irq < 0)
+		ds90ub954_intb_handle(priv);
+
+	for(i = 0; hp->poll_ms && i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(!ser || !ser->configured)
+			continue;
+		mutex_lock(&priv->pm.lock);
+		if(priv->pm.port_users[ser->rx_channel])
+			ds90ub954_hotplug_poll(priv, ser);
+		mutex_unlock(&priv->pm.lock);
+	}
+	ds90ub954_pm_put_active(priv, ref);
+resched:
+	schedule_delayed_work(&hp->work,
+			      msecs_to_jiffies(ds90ub954_hotplug_period_ms(priv)));
+}
 
-			/* default value: 0x2 */
-			ds90ub953->hs_clk_div = 0x2;
-			dev_info(dev, "%s: - hs-clk-div set to default val: 0x2 (div by 4)\n",
-				 __func__);
-		} else {
-			switch(val) {
-			case 1:
-				ds90ub953->hs_clk_div = 0b000;
-				break;
-			case 2:
-				ds90ub953->hs_clk_div = 0b001;
-				break;
-			case 4:
-				ds90ub953->hs_clk_div = 0b010;
-				break;
-			case 8:
-				ds90ub953->hs_clk_div = 0b011;
-				break;
-			case 16:
-				ds90ub953->hs_clk_div = 0b100;
-				break;
-			default:
-				ds90ub953->hs_clk_div = 0b010;
-				dev_info(dev, "%s: - %i no valid value for hs-clk-div\n",
-					 __func__, val);
-				break;
-			}
-			dev_info(dev,"%s: - hs-clk-div set to val: %i (div by %i)\n",
-				 __func__, ds90ub953->hs_clk_div, val);
-		}
+/* remote devices of the serializers up after probe, then start polling */
+static void ds90ub954_hotplug_init(struct ds90ub954_priv *priv)
+{
+	struct ds90ub953_priv *ser;
+	unsigned int period_ms;
+	int i;
 
-		err = of_property_read_u32(ser, "div-m-val", &val);
-		if(err) {
-			dev_info(dev, "%s: - div-m-val property not found\n",
-				 __func__);
-			/* default value: 1 */
-			ds90ub953->div_m_val = 1;
-			dev_info(dev, "%s: - div-m-val set to default val: 1\n",
-				 __func__);
-		} else {
-			/* set div-m-val*/
-			ds90ub953->div_m_val = val;
-			dev_info(dev, "%s: - div-m-val %i\n", __func__, val);
-		}
+	for(i = 0; i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(!ser)
+			continue;
+		priv->hotplug.next_poll[ser->rx_channel] = jiffies;
+		if(ser->initialized == 0)
+			continue;
+		ds90ub954_remote_add(priv, ser);
+		set_bit(ser->rx_channel, &priv->hotplug.present);
+	}
 
-		err = of_property_read_u32(ser, "div-n-val", &val);
-		if(err) {
-			dev_info(dev, "%s: - div-n-val property not found\n",
-				 __func__);
-			/* default value: 0x28 */
-			ds90ub953->div_n_val = 0x28;
-			dev_info(dev, "%s: - div-n-val set to default val: 0x28\n",
-				 __func__);
-		} else {
-			/* set div-n-val*/
-			ds90ub953->div_n_val = val;
-			dev_info(dev, "%s: - div-n-val %i\n", __func__, val);
-		}
+	period_ms = ds90ub954_hotplug_period_ms(priv);
+	if(period_ms)
+		schedule_delayed_work(&priv->hotplug.work,
+				      msecs_to_jiffies(period_ms));
+}
 
-		/* get i2c address */
-		err = of_property_read_u32(ser, "i2c-address", &val);
-		if(err) {
-			dev_info(dev, "%s: - i2c-address not found\n", __func__);
-			ds90ub953->i2c_address = 0x18;
-			dev_info(dev, "%s: - i2c-address set to default val: 0x18\n",
-				 __func__);
-		} else {
-			dev_info(dev, "%s: - i2c-address: 0x%X \n", __func__, val);
-			ds90ub953->i2c_address=val;
-		}
+/*------------------------------------------------------------------------------
+ * BRING-UP REPORT
+ *----------------------------------------------------------------------------*/
 
-		err = ds90ub953_i2c_client(priv, counter, val);
-		if(err) {
-			dev_info(dev, "%s: - ds90ub953_i2c_client failed\n",
-				 __func__);
-			goto next;
-		}
+/*
+ * The bring-up steps only log with dev_dbg (dynamic debug) and trace events.
+ * After probe, the configuration and the outcome of each rx port are
+ * summarized in one line for the device and one line per serializer.
+ */
 
-		err = ds90ub953_regmap_init(priv, counter);
-		if(err) {
-			dev_info(dev, "%s: - ds90ub953_regmap_init failed\n",
-				 __func__);
-			goto next;
-		}
+static const char *ds90ub954_bc_rate_name(int bc_freq_select)
+{
+	switch(bc_freq_select) {
+	case TI954_BC_FREQ_2M5:
+		return "2.5Mbps";
+	case TI954_BC_FREQ_10M:
+		return "10Mbps";
+	case TI954_BC_FREQ_25M:
+		return "25Mbps";
+	case TI954_BC_FREQ_50M:
+		return "50Mbps";
+	case TI954_BC_FREQ_250:
+		return "250kbps";
+	default:
+		return "?";
+	}
+}
 
-		/* get i2c-slave addresses*/
-		err = of_parse_phandle_with_args(ser, "i2c-slave", "list-cells",
-						 0, &i2c_addresses);
-		if(err) {
-			dev_info(dev, "%s: - reading i2c-slave addresses failed\n",
-				 __func__);
-			ds90ub953->i2c_alias_num = 0;
-		} else {
-			ds90ub953->i2c_alias_num = i2c_addresses.args_count;
-			/* writting i2c slave addresses into array*/
-			for(i = 0; (i < i2c_addresses.args_count) &&
-							(i<NUM_ALIAS) ; i++) {
-				ds90ub953->i2c_slave[i] = i2c_addresses.args[i];
-			}
-		}
+/* ms from the start of the last training to entering state, -1: not reached */
+static long ds90ub954_port_ms(struct ds90ub954_port_sm *sm,
+			      enum ds90ub954_port_state state)
+{
+	if(ktime_before(sm->entered[state], sm->enabled))
+		return -1;
+	return (long)ktime_ms_delta(sm->entered[state], sm->enabled);
+}
 
-		/* get slave-aliases */
-		err = of_parse_phandle_with_args(ser, "slave-alias",
-						 "list-cells", 0, &i2c_addresses);
-		if(err) {
-			dev_info(dev, "%s: - reading i2c slave-alias addresses failed\n",
-				 __func__);
-			ds90ub953->i2c_alias_num = 0;
-		} else {
-			dev_info(dev, "%s: - num of slave alias pairs: %i\n",
-				 __func__, i2c_addresses.args_count);
-			/* writting i2c alias addresses into array*/
-			for(i=0; (i<i2c_addresses.args_count) && (i<NUM_ALIAS);
-			    i++) {
-				ds90ub953->i2c_alias[i] = i2c_addresses.args[i];
-				dev_info(dev, "%s: - slave addr: 0x%X, alias addr: 0x%X\n",
-					 __func__, ds90ub953->i2c_slave[i],
-					 ds90ub953->i2c_alias[i]);
-			}
-		}
+static void ds90ub954_report(struct ds90ub954_priv *priv, s64 probe_ms)
+{
+	struct device *dev = &priv->client->dev;
+	struct ds90ub954_retry_stats rs[TARGET_NUM];
+	struct ds90ub954_port_sm sm;
+	struct ds90ub953_priv *ser;
+	unsigned long flags;
+	int i;
 
-		if(of_property_read_bool(ser, "continuous-clock")) {
-			dev_info(dev, "%s: - continuous clock enabled\n",
-				 __func__);
-			ds90ub953->conts_clk = 1;
-		} else {
-			/* default value: 0 */
-			ds90ub953->conts_clk = 0;
-			dev_info(dev, "%s: - discontinuous clock used\n",
-				 __func__);
-		}
+	spin_lock_irqsave(&priv->retry.lock, flags);
+	memcpy(rs, priv->retry.stats, sizeof(rs));
+	spin_unlock_irqrestore(&priv->retry.lock, flags);
 
-		if(of_property_read_bool(ser, "i2c-pass-through-all")) {
-			dev_info(dev, "%s: - i2c-pass-through-all enabled\n",
-				 __func__);
-			ds90ub953->i2c_pt = 1;
-		} else {
-			/* default value: 0 */
-			ds90ub953->i2c_pt = 0;
-			dev_info(dev, "%s: - i2c-pass-through-all disabled\n",
-				 __func__);
-		}
+	dev_info(dev, "%s id 0x%02x '%s' rev 0x%02x, csi %dx%dMbps %s, refclk %dkHz, bc %s, probe %lldms (%u/%u retries)\n",
+		 priv->chip->name, priv->dev_id, priv->id_code, priv->revision,
+		 priv->csi_lane_count, priv->csi_lane_speed,
+		 priv->conts_clk ? "cont" : "non-cont",
+		 priv->refclk_freq / 1000,
+		 ds90ub954_bc_rate_name(priv->bc_freq_select), probe_ms,
+		 rs[TARGET_LOCAL].retries,
+		 rs[TARGET_REMOTE].retries);
 
-		err = of_property_read_u32(ser, "virtual-channel-map", &val);
-		if(err) {
-			dev_info(dev, "%s: - virtual-channel-map property not found\n",
-				 __func__);
-			ds90ub953->vc_map = 0xE4;
-			dev_info(dev, "%s: - virtual-channel-map set to default val: 0xE4\n",
-				 __func__);
-		} else {
-			/* set vc_map*/
-			ds90ub953->vc_map = val;
-			dev_info(dev, "%s: - virtual-channel-map 0x%x\n", __func__, val);
-		}
+	for(i = 0; i < priv->num_ser; i++) {
+		ser = priv->ser[i];
+		if(!ser)
+			continue;
 
-		/* all initialization of this serializer complete */
-		ds90ub953->initialized = 1;
-		priv->num_ser += 1;
-		dev_info(dev, "%s: serializer %i successfully parsed\n", __func__,
-			 counter);
-next:
-		counter +=1;
+		spin_lock_irqsave(&priv->ports.lock, flags);
+		sm = priv->ports.sm[ser->rx_channel];
+		spin_unlock_irqrestore(&priv->ports.lock, flags);
+
+		/* a port that failed its bring-up is never initialized */
+		if(sm.state == PORT_FAULT)
+			dev_warn(dev, "rx%d: %s, ser 0x%02x, lock %ldms, bc %ldms, %d aliases, tp %d, faults %u\n",
+				 ser->rx_channel,
+				 ds90ub954_port_state_names[sm.state],
+				 ser->i2c_address,
+				 ds90ub954_port_ms(&sm, PORT_LOCKED),
+				 ds90ub954_port_ms(&sm, PORT_BC_READY),
+				 ser->i2c_alias_num, ser->test_pattern,
+				 sm.faults);
+		else if(ser->initialized == 0 && ser->configured)
+			dev_info(dev, "rx%d: %s, ser 0x%02x not connected%s\n",
+				 ser->rx_channel,
+				 ds90ub954_port_state_names[sm.state],
+				 ser->i2c_address,
+				 priv->hotplug.poll_ms ?
+				 ", waiting for hot-plug" : "");
+		else if(ser->initialized)
+			dev_info(dev, "rx%d: %s, ser 0x%02x, lock %ldms, streaming %ldms, %d aliases, tp %d\n",
+				 ser->rx_channel,
+				 ds90ub954_port_state_names[sm.state],
+				 ser->i2c_address,
+				 ds90ub954_port_ms(&sm, PORT_LOCKED),
+				 ds90ub954_port_ms(&sm, PORT_STREAMING),
+				 ser->i2c_alias_num, ser->test_pattern);
 	}
-	dev_info(dev, "%s: done\n", __func__);
-	return 0;
-
 }
 
 /*------------------------------------------------------------------------------
@@ -1611,10 +7122,11 @@ static int ds90ub954_probe(struct i2c_client *client,
 {
 	struct ds90ub954_priv *priv;
 	struct device *dev = &client->dev;
+	ktime_t start = ktime_get();
 	int err;
 	int i = 0;
 
-	dev_info(dev, "%s: start\n", __func__);
+	dev_dbg(dev, "%s: start\n", __func__);
 
 	priv = devm_kzalloc(dev, sizeof(struct ds90ub954_priv), GFP_KERNEL);
 	if(!priv)
@@ -1629,6 +7141,20 @@ static int ds90ub954_probe(struct i2c_client *client,
 	/* force to set ia config the first time */
 	priv->sel_ia_config = -1;
 
+	mutex_init(&priv->reg_lock);
+	mutex_init(&priv->alias_lock);
+	mutex_init(&priv->gpio_lock);
+	mutex_init(&priv->link.lock);
+	spin_lock_init(&priv->hist.lock);
+	spin_lock_init(&priv->cache_lock);
+	mutex_init(&priv->pm.lock);
+	INIT_DELAYED_WORK(&priv->hotplug.work, ds90ub954_hotplug_work);
+	INIT_WORK(&priv->bcc.work, ds90ub954_bcc_work);
+	priv->bcc.irq = -ENOENT;
+	ds90ub954_retry_init(priv);
+	ds90ub954_pgen_default(&priv->pgen);
+	ds90ub954_port_init(priv);
+
 	err = ds90ub954_parse_dt(priv);
 	if(unlikely(err < 0)) {
 		dev_err(dev, "%s: error parsing device tree\n", __func__);
@@ -1648,12 +7174,19 @@ static int ds90ub954_probe(struct i2c_client *client,
 		goto err_regmap;
 	}
 
+	priv->ser = devm_kcalloc(dev, priv->chip->num_rx_ports,
+				 sizeof(*priv->ser), GFP_KERNEL);
+	if(!priv->ser) {
+		err = -ENOMEM;
+		goto err_regmap;
+	}
+
 	ds90ub953_parse_dt(client, priv);
 
 	/* turn on deserializer */
 	ds90ub954_pwr_enable(priv);
 
-	msleep(6); // wait for sensor to start
+	ds90ub954_msleep(priv, PM_PDB_DELAY_MS); // wait for sensor to start
 
 	/* init deserializer */
 	err = ds90ub954_init(priv, 0);
@@ -1661,25 +7194,31 @@ static int ds90ub954_probe(struct i2c_client *client,
 		dev_err(dev, "%s: error initializing ds90ub954\n", __func__);
 		goto err_regmap;
 	}
-	dev_info(dev, "%s: init ds90ub954_done\n", __func__);
+	dev_dbg(dev, "%s: init ds90ub954_done\n", __func__);
 
-	msleep(500);
+	ds90ub954_gpiochip_init(priv);
+	ds90ub954_link_init(priv);
+
+	ds90ub954_msleep(priv, 500);
 
 	/* init serializers */
 	for( ; i<priv->num_ser; i++) {
 		/* check if serializer is initialized */
-		if(priv->ser[i]->initialized == 0)
+		if(!priv->ser[i] || priv->ser[i]->initialized == 0)
 			continue;
 		/*init serializer*/
+		mutex_lock(&priv->ser[i]->lock);
 		err = ds90ub953_init(priv->ser[i]);
+		mutex_unlock(&priv->ser[i]->lock);
 		if(err) {
-			dev_info(dev,
+			dev_warn(dev,
 				"serializer %i init_serializer failed\n", i);
 			continue;
 		}
+		ds90ub953_register(priv->ser[i]);
 	}
 
-	msleep(500);
+	ds90ub954_msleep(priv, 500);
 
 #ifdef ENABLE_SYSFS_TP
 	/* device attribute on sysfs */
@@ -1690,12 +7229,34 @@ static int ds90ub954_probe(struct i2c_client *client,
 			dev_attr_test_pattern_des.attr.name);
 #endif
 
+	err = device_create_file(dev, &dev_attr_link_status);
+	if(unlikely(err < 0))
+		dev_err(dev, "deserializer cant create device attribute %s\n",
+			dev_attr_link_status.attr.name);
+
+	err = device_create_file(dev, &dev_attr_link_power);
+	if(unlikely(err < 0))
+		dev_err(dev, "deserializer cant create device attribute %s\n",
+			dev_attr_link_power.attr.name);
+
+	/* powered and held until link_power and every port_power is cleared */
+	pm_runtime_set_active(dev);
+	pm_runtime_get_noresume(dev);
+	priv->pm.hold = true;
+	ds90ub954_port_power_init(priv);
+	pm_runtime_enable(dev);
+
+	ds90ub954_bcc_init(priv);
+	ds90ub954_hotplug_init(priv);
+
+	ds90ub954_debugfs_init(priv);
+	ds90ub954_report(priv, ktime_ms_delta(ktime_get(), start));
+
 	return 0;
 
 err_regmap:
 	ds90ub953_free(priv);
 	ds90ub954_pwr_disable(priv);
-	ds90ub954_free_gpio(priv);
 err_init_gpio:
 err_parse_dt:
 	devm_kfree(dev, priv);
@@ -1705,16 +7266,34 @@ err_parse_dt:
 static void ds90ub954_remove(struct i2c_client *client)
 {
 	struct ds90ub954_priv *priv = dev_get_drvdata(&client->dev);
+	int i;
 
+	cancel_delayed_work_sync(&priv->hotplug.work);
+	if(priv->bcc.irq >= 0)
+		disable_irq(priv->bcc.irq);
+	cancel_work_sync(&priv->bcc.work);
+	ds90ub954_debugfs_remove(priv);
+	for(i = 0; i < priv->num_ser; i++) {
+		if(priv->ser[i])
+			ds90ub954_remote_remove(priv->ser[i]);
+	}
+	device_remove_file(&client->dev, &dev_attr_link_power);
+	pm_runtime_disable(&client->dev);
+	if(priv->pm.hold)
+		pm_runtime_put_noidle(&client->dev);
+	for(i = 0; i < priv->pm.ports_active; i++)
+		pm_runtime_put_noidle(&client->dev);
+	pm_runtime_set_suspended(&client->dev);
+	device_remove_file(&client->dev, &dev_attr_link_status);
 	ds90ub953_free(priv);
 	ds90ub954_pwr_disable(priv);
-	ds90ub954_free_gpio(priv);
 
-	dev_info(&client->dev, "ds90ub954 removed\n");
+	dev_dbg(&client->dev, "ds90ub954 removed\n");
 }
 
 static const struct i2c_device_id ds90ub954_id[] = {
 	{"ti,ds90ub954", 0},
+	{"ti,ds90ub960", 0},
 	{/* sentinel */},
 };
 
@@ -1723,6 +7302,7 @@ static struct i2c_driver ds90ub954_driver = {
 	{
 		.name = "i2c-ds90ub954",
 		.of_match_table = of_match_ptr(ds90ub954_of_match),
+		.pm = &ds90ub954_pm_ops,
 	},
 	.probe = ds90ub954_probe,
 	.remove = ds90ub954_remove,
@@ -1739,3 +7319,7 @@ MODULE_AUTHOR("Philipp Huber <hubp@zhaw.ch>");
 MODULE_AUTHOR("Simone Schwizer <sczr@zhaw.ch>");
 MODULE_DESCRIPTION("i2c ds90ub954 driver");
 MODULE_LICENSE("GPL v2");
+
+#if IS_ENABLED(CONFIG_VIDEO_DS90UB954_KUNIT_TEST)
+#include "ds90ub954_test.c"
+#endif
@@ -23,7 +23,13 @@
 #ifndef I2C_DS90UB954_H
 #define I2C_DS90UB954_H
 
+#include <linux/clk-provider.h>
+#include <linux/gpio/driver.h>
 #include <linux/i2c.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
 
 /*------------------------------------------------------------------------------
  * Deserializer registers
@@ -113,6 +119,10 @@
 #define TI954_GPIO5_INPUT_EN     5
 #define TI954_GPIO6_INPUT_EN     6
 
+#define TI954_NUM_GPIO          7
+#define TI954_GPIO_OUT_SRC_DEV  4 // GPIOx_OUT_SRC: device
+#define TI954_GPIO_OUT_SEL_VAL  0 // GPIOx_OUT_SEL: GPIOx_OUT_VAL
+
 #define TI954_REG_GPIO0_PIN_CTL 0x10
 #define TI954_GPIO0_OUT_EN      0
 #define TI954_GPIO0_OUT_VAL     1
@@ -187,7 +197,7 @@
 
 #define TI954_REG_FWD_CTL1  0x20
 #define TI954_FWD_PORT0_DIS 4
-#define TI954_FWD_PORT1_DIS 6
+#define TI954_FWD_PORT1_DIS 5
 
 #define TI_954_FWD_CTL2         0x21
 #define TI954_CSI0_RR_RWD       0
@@ -301,6 +311,8 @@
 #define TI954_REG_AEQ_ERR_THOLD 0x43
 #define TI954_AEQ_ERR_THRESHOLD 0
 
+#define TI954_REG_BCC_STATUS 0x47 // cleared on read
+
 #define TI954_REG_FPD3_CAP     0x4a
 #define TI954_FPD3_ENC_CRC_CAP 4
 
@@ -378,7 +390,7 @@
 #define TI954_I2C_PASS_THROUGH        6
 #define TI954_I2C_PASS_THROUGH_ALL    7
 #define TI954_BC_FREQ_2M5             0
-#define TI954_BC_FREQ_1M              2
+#define TI954_BC_FREQ_10M             2
 #define TI954_BC_FREQ_25M             5
 #define TI954_BC_FREQ_50M             6
 #define TI954_BC_FREQ_250             7
@@ -423,7 +435,7 @@
 #define TI954_ALIAS_ID2     1
 #define TI954_REG_ALIAS_ID3 0x68
 #define TI954_ALIAS_ID3     1
-#define TI954_REG_ALIAS_ID4 0x644
+#define TI954_REG_ALIAS_ID4 0x69
 #define TI954_ALIAS_ID4     1
 #define TI954_REG_ALIAS_ID5 0x6a
 #define TI954_ALIAS_ID5     1
@@ -448,6 +460,9 @@
 #define TI954_REG_BC_GPIO_CTL1 0x6f
 #define TI954_BC_GPIO2_SEL     0
 #define TI954_BC_GPIO3_SEL     4
+#define TI954_BC_GPIO_SEL_MASK 0xf
+#define TI954_BC_GPIO_SEL_LOW  8 // output constant value of 0
+#define TI954_BC_GPIO_SEL_HIGH 9 // output constant value of 1
 
 #define TI954_REG_RAW10_ID 0x70
 #define TI954_RAW10_DT     0
@@ -466,7 +481,7 @@
 #define TI954_REG_LINE_COUNT_LO 0x74
 #define TI954_LINE_COUNT_LO     0
 
-#define TI954_REG_LINE_LEN_1 0x750
+#define TI954_REG_LINE_LEN_1 0x75
 #define TI954_LINE_LEN_HI    0
 
 #define TI954_REG_LINE_LEN_0 0x76
@@ -516,6 +531,7 @@
 
 #define TI954_REG_REFCLK_FREQ 0xa5
 #define TI954_REFCLK_FREQ     0
+#define TI954_REFCLK_DEFAULT_MHZ 25
 
 #define TI954_REG_IND_ACC_CTL 0xb0
 #define TI954_IA_READ         0
@@ -743,6 +759,12 @@
 #define TI954_REG_IA_PGEN_COLOR14 0x1e
 #define TI954_PGEN_COLOR14        0
 
+/* pattern generator parameters */
+#define TI954_PGEN_NUM_REGS   (TI954_REG_IA_PGEN_COLOR14 + 1)
+#define TI954_PGEN_NUM_COLORS 15
+#define TI954_PGEN_CLK_HZ     100000000 // LINE_PD in 10 ns units
+#define TI954_PGEN_LINE_PD_MAX 0xffff
+
 #define TI954_REG_IA_CSI0_TCK_PREP 0x40
 #define TI954_MC_TCK_PREP          0
 #define TI954_MC_TCK_PREP_OV       7
@@ -824,10 +846,17 @@
 #define TI953_HS_CLK_DIV_4     2
 #define TI953_HS_CLK_DIV_8     3
 #define TI953_HS_CLK_DIV_16    4
+#define TI953_DIV_M_MAX        31
 
 
 #define TI953_REG_CLKOUT_CTRL1 0x07
 #define TI953_DIV_N_VAL        0
+#define TI953_DIV_N_MAX        255
+
+/* CLK_OUT limits in synchronous mode */
+#define TI953_FC_RATE_MULT 160 // forward channel rate = REFCLK * 160
+#define TI953_HS_CLK_MAX   1050000000 // fc rate / hs-clk-div
+#define TI953_CLKOUT_MAX   100000000
 
 #define TI953_REG_BBC_WATCHDOG     0x08
 #define TI953_BCC_WD_TIMER_DISABLE 0
@@ -854,6 +883,8 @@
 #define TI953_GPIO_OUT_SRC        0
 #define TI953_GPIO_RMTEN          4
 
+#define TI953_NUM_GPIO       4
+
 #define TI953_REG_GPIO_CTRL  0x0e
 #define TI953_GPIO0_INPUT_EN 0
 #define TI953_GPIO1_INPUT_EN 1
@@ -956,6 +987,7 @@
 
 #define TI953_REG_DATAPATH_CTL1 0x33
 #define TI953_FC_GPIO_EN        0
+#define TI953_FC_GPIO_EN_MASK   0x3
 #define TI953_DCA_CRC_EN        2
 
 #define TI953_REG_DES_PAR_CAP1 0x35
@@ -1104,6 +1136,15 @@
 #define TI953_REG_IND_ACC_DATA 0xb2
 #define TI953_IND_ACC_DATA     0
 
+/* Indirect Register Map Description, the pattern generator registers have
+ * the layout of TI954_REG_IA_PGEN_* */
+#define TI953_IA_PGEN_BANK     0
+
+#define TI953_REG_IA_PGEN_CTL  0x01
+#define TI953_PGEN_ENABLE      0
+
+#define TI953_REG_IA_PGEN_CFG  0x02
+
 #define TI953_REG_FPD3_RX_ID0 0xf0
 #define TI953_FPD3_RX_ID0     0
 #define TI953_REG_FPD3_RX_ID1 0xf1
@@ -1143,13 +1184,411 @@
 #define EEPROM_I2C_0            0x45
 #define EEPROM_I2C_1            0x46
 
-#define NUM_SERIALIZER 2
+/* i2c master timing, counted in cycles of the internal oscillator */
+#define TI95X_I2C_OSC_PERIOD_NS 40
+#define TI95X_I2C_OSC_TOLERANCE_PCT 10 // counts are rounded up for a fast oscillator
+#define TI95X_SDA_SETUP_DEFAULT 1
+
+#define TI954_NUM_RX_PORTS 2
+#define TI960_NUM_RX_PORTS 4
+#define TI960_NUM_GPIO 8
 #define NUM_ALIAS 8
+#define NUM_REMOTE 8 // remote devices instantiated per serializer
+#define NUM_ALIAS_POOL 32
+
+/* description of a deserializer variant */
+struct ds90ub954_chip_info {
+	const char *name;
+	int num_rx_ports; // FPD-Link III rx ports, also rx port to select all
+	int num_gpios; // local GPIOx_PIN_CTL pins
+	int rx_port_ctl; // LOCK/PASS source select bits of RX_PORT_CTL
+};
+
+/* owner of a pinned alias slot */
+#define ALIAS_PIN_NONE 0 // dynamic, reclaimed when least recently used
+#define ALIAS_PIN_DT 1 // slave/alias pair from device tree
+#define ALIAS_PIN_REMOTE 2 // client of remote-devices, until it is removed
+#define ALIAS_PIN_BATCH 3 // queued remote write, until its transfer is done
+
+struct ds90ub953_alias {
+	int slave; // remote i2c address, 0 if the slot is free
+	int alias; // host i2c address the slave is reachable at
+	int pinned; // ALIAS_PIN_*, pinned slots are never reclaimed
+	u64 last_used; // LRU stamp, see ds90ub954_alias_get()
+	unsigned int use_count; // number of lookups since slot was programmed
+};
+
+#define BENCH_MAX_OPS 100000
+#define BENCH_MAX_BURST 32
+#define BENCH_HIST_BUCKETS 16 // power of two buckets in us
+
+/* remote i2c benchmark, configured and started through debugfs */
+struct ds90ub954_bench {
+	struct mutex lock;
+	/* parameters */
+	int port; // rx port of the serializer
+	int target; // 0: serializer, else remote slave address (aliased)
+	int reg; // first register, 16 bit register address if > 0xff
+	int count; // number of transactions
+	int burst; // bytes per transaction
+	int write_pct; // percentage of write transactions
+	/* results of the last run */
+	int valid;
+	int ops;
+	int reads;
+	int writes;
+	int errors;
+	u64 total_ns;
+	u32 min_ns;
+	u32 p50_ns;
+	u32 p99_ns;
+	u32 max_ns;
+	u32 hist[BENCH_HIST_BUCKETS];
+};
+
+/* pattern generator configuration, timing registers are computed from it */
+struct ds90ub954_pgen {
+	int width; // active pixels per line
+	int height; // active lines per frame
+	int dt; // csi-2 data type
+	int vc; // csi-2 virtual channel
+	int fps; // frame rate in Hz
+	int kbps; // target average payload bandwidth in kbit/s, overrides fps
+	int line_pd; // line period in 10 ns units, overrides fps and kbps
+	int tot_lpf; // total lines per frame, 0: height + vbp + vfp
+	int vbp; // vertical back porch in lines
+	int vfp; // vertical front porch in lines
+	int num_bars; // color bars: 1, 2, 4 or 8
+	int fixed; // fixed pattern of color blocks from the color table
+	u8 color[TI954_PGEN_NUM_COLORS]; // PGEN_COLOR0..14
+};
+
+/* register values and resulting timing of a pattern generator config */
+struct ds90ub954_pgen_timing {
+	u8 regs[TI954_PGEN_NUM_REGS]; // indexed by indirect register address
+	int line_size; // bytes per line
+	int bar_size; // bytes per color bar
+	int tot_lpf; // total lines per frame
+	int line_pd; // line period in 10 ns units
+	u32 fps_milli; // resulting frame rate in mHz
+	u64 kbps; // resulting average payload bandwidth in kbit/s
+};
+
+/* end-to-end check of a serializer pattern at the deserializer rx port */
+struct ds90ub953_pgen_result {
+	int valid;
+	int pass;
+	int duration_ms; // measurement time
+	int line_count; // LINE_COUNT of the last frame
+	int line_len; // LINE_LEN of the last line
+	int exp_line_count; // height of the pattern
+	int exp_line_len; // line size of the pattern
+	int csi_errors; // CSI_ERR_COUNTER
+	int csi_rx_sts; // ECC, checksum and length errors of CSI_RX_STS
+	int port_sts2; // line count/length changes of RX_PORT_STS2
+	u64 kbps; // payload bandwidth of the pattern
+};
+
+/* debugfs register dumps */
+enum ds90ub954_dump_type {
+	DUMP_MAIN = 0, // deserializer main map
+	DUMP_RX_PORT, // paged registers of an rx port
+	DUMP_IA, // indirect access bank
+	DUMP_SER, // serializer map
+	DUMP_ALL, // all of the above
+};
+
+#define DUMP_MAX_FILES 20
+
+struct ds90ub954_dump {
+	struct ds90ub954_priv *priv;
+	enum ds90ub954_dump_type type;
+	int index; // rx port, indirect access bank or serializer index
+};
+
+/*
+ * Binary device state snapshot (debugfs snapshot), little endian. A header
+ * is followed by num_ports port entries. Fields are only appended, readers
+ * check version and use size and port_size to skip unknown fields.
+ */
+#define SNAPSHOT_MAGIC   0x34353955 // "U954"
+#define SNAPSHOT_VERSION 1
+
+#define SNAPSHOT_PORT_VALID 0 // deserializer port registers read
+#define SNAPSHOT_SER_PRESENT 1 // serializer configured on the port
+#define SNAPSHOT_SER_VALID 2 // serializer registers read
+
+struct ds90ub954_snapshot_hdr {
+	__le32 magic;
+	__le16 version;
+	__le16 size; // bytes of header and port entries
+	__le16 port_size; // bytes of a port entry
+	u8 num_ports;
+	u8 link_state; // enum ds90ub954_link_state of the LOCK/PASS pins
+	__le64 timestamp_ns; // CLOCK_MONOTONIC at the start of the collection
+	__le32 collect_us; // collection time
+	__le32 lock_events;
+	__le32 loss_events;
+	__le32 pass_loss_events;
+	__le64 last_lock_ns; // CLOCK_MONOTONIC, 0: never
+	__le64 last_loss_ns;
+	u8 device_sts;
+	u8 interrupt_sts;
+	u8 fwd_sts;
+	u8 reserved;
+} __packed;
+
+struct ds90ub954_snapshot_port {
+	u8 port;
+	u8 flags; // SNAPSHOT_*
+	/* deserializer rx port */
+	u8 rx_port_sts1;
+	u8 rx_port_sts2;
+	u8 rx_freq_high;
+	u8 rx_freq_low;
+	u8 sensor_sts[4];
+	__le16 par_err; // RX_PAR_ERR since the last read
+	__le16 line_count;
+	__le16 line_len;
+	u8 csi_rx_sts;
+	u8 csi_err_counter; // since the last read
+	u8 bcc_status;
+	u8 aeq_status;
+	__le32 par_err_total; // accumulated by the driver
+	__le32 csi_err_total;
+	/* serializer */
+	u8 ser_device_sts;
+	u8 ser_general_status;
+	u8 ser_gpio_pin_sts;
+	u8 ser_bist_err_cnt;
+	u8 ser_crc_err_cnt1;
+	u8 ser_crc_err_cnt2;
+	u8 ser_sensor_status;
+	u8 ser_sensor_v0;
+	u8 ser_sensor_v1;
+	u8 ser_sensor_t;
+	u8 ser_csi_err_cnt; // since the last read
+	u8 ser_csi_err_status;
+	__le32 ser_csi_err_total; // accumulated by the driver
+} __packed;
+
+/* error counters that are cleared on read, accumulated under reg_lock */
+struct ds90ub954_port_counters {
+	u32 par_err;
+	u32 csi_err;
+	u32 ser_csi_err;
+	u32 bcc_crc_err; // back channel CRC error interrupts
+	u32 bcc_seq_err; // back channel sequence error interrupts
+	u32 bcc_reinit; // back channel re-initializations
+	u32 bcc_reinit_failed;
+	u32 par_alarms; // parity error threshold interrupts
+	u32 par_rate; // parity errors per second at the last alarm
+	ktime_t par_read; // last read of RX_PAR_ERR, which clears it
+	ktime_t par_event; // last parity uevent
+};
+
+/* retry of transient i2c errors, local: deserializer, remote: serializers */
+enum ds90ub954_target {
+	TARGET_LOCAL = 0,
+	TARGET_REMOTE,
+	TARGET_NUM,
+};
+
+#define RETRY_LOCAL_DEFAULT 1
+#define RETRY_REMOTE_DEFAULT 3
+#define RETRY_BACKOFF_DEFAULT_US 500
+#define RETRY_MAX 10
+#define RETRY_BACKOFF_MAX_US 20000
+
+struct ds90ub954_retry_policy {
+	int retries; // retries after the first attempt
+	int backoff_us; // first backoff, doubled per retry
+};
+
+struct ds90ub954_retry_stats {
+	u32 retries; // retried attempts
+	u32 recovered; // accesses that succeeded after a retry
+	u32 failed; // accesses that failed after all retries
+	u64 recovery_ns; // cumulative time from first error to success
+	u32 max_recovery_ns;
+};
+
+/* injected faults, probabilities in percent per attempt */
+struct ds90ub954_fault {
+	int targets; // bitmask of BIT(TARGET_LOCAL) and BIT(TARGET_REMOTE)
+	int nak_pct; // fail with -ENXIO
+	int timeout_pct; // fail with -ETIMEDOUT after timeout_us
+	int timeout_us;
+	int corrupt_pct; // flip a bit of a read value
+	int times; // remaining injections, -1: unlimited
+	u32 injected;
+};
+
+struct ds90ub954_retry {
+	spinlock_t lock;
+	struct ds90ub954_retry_policy policy[TARGET_NUM];
+	struct ds90ub954_retry_stats stats[TARGET_NUM];
+	struct ds90ub954_fault fault;
+};
+
+/* register access histogram, indexed by the 8 bit register address */
+#define REG_HIST_NUM 256
+
+struct ds90ub954_reg_stat {
+	u32 reads;
+	u32 writes;
+	u32 errors;
+	u32 max_ns;
+	u64 total_ns; // cumulative access time
+};
+
+struct ds90ub954_reg_hist {
+	spinlock_t lock;
+	struct ds90ub954_reg_stat stat[REG_HIST_NUM];
+};
+
+/* bring-up state of an rx port */
+enum ds90ub954_port_state {
+	PORT_DISABLED = 0,
+	PORT_TRAINING, // rx port enabled, waiting for lock
+	PORT_LOCKED, // forward channel locked and passing
+	PORT_BC_READY, // back channel configured, serializer alias set
+	PORT_ALIASED, // remote slave aliases programmed
+	PORT_STREAMING, // serializer initialized, csi forwarding enabled
+	PORT_FAULT, // init failed or link lost
+	PORT_STATE_NUM,
+};
+
+struct ds90ub954_port_sm {
+	enum ds90ub954_port_state state;
+	ktime_t changed; // time of the last transition
+	ktime_t enabled; // start of the last training
+	ktime_t entered[PORT_STATE_NUM]; // last time a state was entered
+	unsigned int transitions;
+	unsigned int faults;
+};
+
+struct ds90ub954_ports {
+	spinlock_t lock;
+	struct ds90ub954_port_sm sm[TI960_NUM_RX_PORTS];
+};
+
+/* written configuration registers, replayed after a power down */
+#define REGCACHE_NUM_REGS 256
+#define REGCACHE_DES_PAGES (1 + TI960_NUM_RX_PORTS) // main map, rx port pages
+
+struct ds90ub954_regcache {
+	u8 val[REGCACHE_NUM_REGS];
+	DECLARE_BITMAP(valid, REGCACHE_NUM_REGS); // registers written since probe
+};
+
+#define PM_PDB_DELAY_MS 6 // PDB high to i2c ready
+#define PM_LOCK_POLL_MS 2
+#define PM_LOCK_TIMEOUT_MS 500
+
+#define BCC_WD_MAX_MS 254 // 7 bit timer in 2 ms units
+#define PAR_EVENT_MIN_MS 1000 // uevents of a port are rate limited
+
+struct ds90ub954_bcc {
+	int wd_ms; // watchdog timeout, 0: disabled, < 0: reset value
+	int irq; // INTB, < 0 if not used
+	struct work_struct work; // back channel re-initialization
+	unsigned long pending; // rx ports to re-initialize
+};
+
+#define HOTPLUG_POLL_DEFAULT_MS 500
+#define HOTPLUG_BACKOFF_MAX_MS 8000
+#define PRESENCE_TIMEOUT_MS 100 // port enable to lock or rx frequency
+#define PRESENCE_POLL_MS 5
+
+struct ds90ub954_hotplug {
+	struct delayed_work work;
+	unsigned int poll_ms; // 0: no hot-plug
+	unsigned long present; // rx ports with a serializer up
+	unsigned long lost; // present rx ports without lock at the last poll
+	unsigned int backoff_ms[TI960_NUM_RX_PORTS]; // retry interval if absent
+	unsigned long next_poll[TI960_NUM_RX_PORTS]; // jiffies of the next retry
+	unsigned int connects;
+	unsigned int disconnects;
+};
+
+struct ds90ub954_pm {
+	struct mutex lock; // protects hold, port_users and ports_active
+	bool cache_only; // registers are only written to the cache
+	bool hold; // runtime pm reference taken by the power attribute
+	int port_users[TI960_NUM_RX_PORTS]; // consumers of an rx port
+	int ports_active; // rx ports with consumers, csi tx sleeps at 0
+	unsigned long ser_lost; // rx ports not up since a suspend, see ds90ub954_port_bring_up
+	unsigned int port_gates; // rx port power downs
+	unsigned int suspends;
+	unsigned int resumes;
+	unsigned int resume_failed;
+	unsigned int sync_writes; // bulk writes of the last register replay
+	u32 sync_us; // register replay of the last resume
+	u32 lock_us; // power up to the last port locked
+	u32 resume_us; // power up to all ports streaming
+};
+
+/* link state from the LOCK and PASS pins of the deserializer */
+enum ds90ub954_link_state {
+	LINK_STATE_UNKNOWN = 0, // no lock-gpio, or not sampled yet
+	LINK_STATE_DOWN, // LOCK low
+	LINK_STATE_LOCKED, // LOCK high, PASS low
+	LINK_STATE_PASS, // LOCK and PASS high
+};
+
+struct ds90ub954_link {
+	struct mutex lock;
+	enum ds90ub954_link_state state;
+	int lock_irq; // < 0 if the pin has no interrupt
+	int pass_irq;
+	ktime_t changed; // time of the last state change
+	ktime_t last_lock; // time LOCK last went high
+	ktime_t last_loss; // time LOCK last went low
+	unsigned int lock_events; // LOCK rising edges
+	unsigned int loss_events; // LOCK falling edges
+	unsigned int pass_loss_events; // PASS falling edges while locked
+};
+
+#define BATCH_MAX_WRITES 256
+#define BATCH_MAX_BURST 32 // data bytes per coalesced remote write
+#define BATCH_MAX_MSGS 32 // i2c messages per transfer
+
+/* remote register write, queued until the next frame start or deadline */
+struct ds90ub953_reg_write {
+	u8 slave; // remote i2c address
+	u8 reg_bytes; // register address width in bytes (1 or 2)
+	u16 reg;
+	u8 val;
+};
+
+struct ds90ub953_batch {
+	struct mutex lock; // protects the queue and the statistics
+	struct ds90ub953_reg_write queue[BATCH_MAX_WRITES];
+	int num; // number of queued writes
+	struct i2c_msg msgs[BATCH_MAX_MSGS]; // flush buffers
+	u8 bufs[BATCH_MAX_MSGS][2 + BATCH_MAX_BURST];
+	struct delayed_work deadline_work;
+	int deadline_ms; // flush deadline after the first queued write
+	struct gpio_desc *frame_start_gpio; // host gpio signaling frame start
+	int frame_start_irq; // < 0 if not used
+	bool suspended; // link down, set by runtime suspend
+	/* statistics */
+	unsigned int batches; // submitted batches
+	unsigned int writes; // written registers
+	unsigned int transfers; // i2c messages on the back channel
+	unsigned int frame_flushes; // flushes triggered by frame start
+	unsigned int deadline_flushes; // flushes triggered by the deadline
+	unsigned int errors;
+	unsigned int dropped; // writes not sent after a failed flush
+};
 
 struct ds90ub953_priv {
+	struct mutex lock; // port state lock, serializes init and test pattern
 	struct i2c_client *client;
 	struct regmap *regmap;
 	struct ds90ub954_priv *parent;
+	struct device_node *np; // serializer node in the device tree
 	int rx_channel;
 	int test_pattern;
 	int i2c_address;
@@ -1157,44 +1596,106 @@ struct ds90ub953_priv {
 	int i2c_alias_num; // number of slave alias pairs
 	int i2c_slave[NUM_ALIAS]; // array with the i2c slave addresses
 	int i2c_alias[NUM_ALIAS]; // array with the i2c alias addresses
+	struct ds90ub953_alias alias[NUM_ALIAS]; // programmed SLAVE_ID/ALIAS_ID slots
 	int conts_clk; // continuous clock (0: discontinuous, 1: continuous)
 	int i2c_pt; // i2c-pass-through-all
+	int i2c_scl_freq; // remote i2c scl frequency in Hz (0: reset default)
 
 	int initialized;
+	int configured; // parsed from the device tree, hot-plug candidate
+	bool registered; // gpiochip, clkout and attributes registered
+	struct i2c_client *remote[NUM_REMOTE]; // clients of remote-devices
+	int remote_num;
 
-	int gpio0_oe; // gpio0_output_enable
-	int gpio1_oe; // gpio1_output_enable
-	int gpio2_oe; // gpio2_output_enable
-	int gpio3_oe; // gpio3_output_enable
-
-	int gpio0_oc; // gpio0_output_control
-	int gpio1_oc; // gpio1_output_control
-	int gpio2_oc; // gpio2_output_control
-	int gpio3_oc; // gpio3_output_control
+	int gpio_oe[TI953_NUM_GPIO]; // gpioN_output_enable
+	int gpio_oc[TI953_NUM_GPIO]; // gpioN_output_control (BC_GPIO_CTL select)
+	struct gpio_chip gpio_chip; // remote gpios, outputs over the back channel
+	struct mutex gpio_lock; // protects gpio_oe/gpio_oc and fc_gpio_en
+	int fc_gpio_en; // gpios forwarded over the forward channel
 
 	/* reference output clock control parameters */
 	int hs_clk_div;
 	int div_m_val;
 	int div_n_val;
+	unsigned long clkout_rate; // requested CLK_OUT in Hz, 0: use dividers
+	struct clk_hw clkout; // CLK_OUT clock provider
 
 	int vc_map; // virtual channel mapping
+
+	struct ds90ub953_batch batch; // frame aligned remote write queue
+	struct ds90ub954_reg_hist hist; // register access histogram
+
+	struct ds90ub954_pgen pgen; // serializer pattern generator
+	struct ds90ub953_pgen_result pgen_result; // last end-to-end check
+	bool pgen_testing; // end-to-end check running, lock dropped
+
+	spinlock_t cache_lock;
+	struct ds90ub954_regcache cache; // replayed on resume
+	bool power_hold; // port reference taken by the port_power attribute
+	u16 par_err_thold; // parity errors that raise an alarm, 0: disabled
 };
 
+struct ds90ub954_mock;
 
+/*
+ * Locking: reg_lock is the device lock. It is only held for a port or
+ * indirect access bank selection and the accesses depending on it, or for a
+ * read-modify-write of a global register. Longer sequences on one rx port
+ * hold the port state lock of its serializer, so they don't block the other
+ * ports. Lock order: pm.lock, then ser->lock, then batch.lock, then
+ * alias_lock or gpio_lock, then reg_lock.
+ */
 struct ds90ub954_priv {
 	struct i2c_client *client;
 	struct regmap *regmap;
-	struct ds90ub953_priv *ser[NUM_SERIALIZER]; //serializers
-	int pass_gpio;
-	int lock_gpio;
-	int pdb_gpio;
+	struct mutex reg_lock; // protects sel_rx_port and sel_ia_config
+	const struct ds90ub954_chip_info *chip;
+	struct ds90ub953_priv **ser; // serializers, num_rx_ports entries
+	struct gpio_desc *pass_gpio;
+	struct gpio_desc *lock_gpio;
+	struct gpio_desc *pdb_gpio;
+	struct ds90ub954_link link; // link state from lock/pass pins
 	int sel_rx_port; // selected rx port
 	int sel_ia_config; // selected ia configuration
 	int csi_lane_count;
 	int csi_lane_speed;
 	int test_pattern;
-	int num_ser; // number of serializers connected
+	int num_ser; // number of serializer entries used in ser[]
 	int conts_clk; // continuous clock (0: discontinuous, 1: continuous)
+	struct gpio_chip gpio_chip; // local GPIO0..6
+	struct mutex gpio_lock; // protects local gpio read-modify-write
+	int bc_freq_select; // back channel rate (TI954_BC_FREQ_*)
+	int i2c_scl_freq; // i2c master scl frequency in Hz (0: reset default)
+	int refclk_freq; // REFCLK in Hz (0: measured at init)
+	int dev_id; // I2C_DEV_ID read at init
+	int revision; // REVISION read at init
+	char id_code[TI954_RX_ID_LENGTH + 1]; // FPD3_RX_ID0..5 read at init
+
+	/* dynamic i2c alias allocation */
+	struct mutex alias_lock; // protects alias_seq and all serializer slots
+	int alias_pool[NUM_ALIAS_POOL]; // free host addresses from device tree
+	int alias_pool_num;
+	u64 alias_seq; // LRU clock, incremented on every alias lookup
+
+	struct dentry *debugfs;
+	struct ds90ub954_bench bench;
+	struct ds90ub954_reg_hist hist; // register access histogram
+	struct ds90ub954_retry retry; // retry policy and fault injection
+	struct ds90ub954_pgen pgen; // pattern generator of test_pattern_des
+	struct ds90ub954_dump dump[DUMP_MAX_FILES]; // debugfs regs/ files
+	bool dump_decode; // register names in the dumps
+	struct ds90ub954_port_counters counters[TI960_NUM_RX_PORTS];
+	struct ds90ub954_ports ports; // rx port state machines
+
+	spinlock_t cache_lock;
+	struct ds90ub954_regcache cache[REGCACHE_DES_PAGES]; // replayed on resume
+	struct ds90ub954_pm pm; // runtime and system sleep
+	struct ds90ub954_hotplug hotplug; // serializer connect/disconnect
+	struct ds90ub954_bcc bcc; // back channel watchdog and error recovery
+	struct gpio_desc *intb_gpio;
+#if IS_ENABLED(CONFIG_VIDEO_DS90UB954_KUNIT_TEST)
+	struct ds90ub954_mock *mock; // register mock of the KUnit tests
+#endif
 };
 
 #endif /* I2C_DS90UB954_H */
@@ -0,0 +1,833 @@
+/*
+ * ds90ub954_test.c - KUnit tests of the DS90UB954 bring-up against a
+ * register mock
+ *
+ * Included at the end of ds90ub954.c, the tests call the static bring-up
+ * functions directly. The deserializer and serializer regmaps are backed by
+ * register files instead of i2c:
+ * - FPD3_PORT_SEL paging of the rx port registers
+ * - IND_ACC indirect access banks of deserializer and serializers
+ * - a connected rx port locks as soon as it is enabled in RX_PORT_CTL, a
+ *   serializer behind a port without lock NAKs
+ *
+ * Every register access is counted and ds90ub954_msleep() only accounts the
+ * time, so the tests check register state and the transaction and sleep
+ * budgets of the bring-up paths without waiting for them.
+ *
+ * Copyright (c) 2020, Institut of Embedded Systems ZHAW
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ */
+
+#include <kunit/test.h>
+#include <linux/completion.h>
+#include <linux/kthread.h>
+
+#define MOCK_NUM_IA_BANKS 8
+#define MOCK_DES_ADDR 0x3d
+#define MOCK_SER_ADDR 0x18
+
+/* budgets of the bring-up paths, one connected rx port */
+#define TEST_INIT_XFERS 48 /* ds90ub954_init, up to two alias pairs */
+#define TEST_INIT_SLEEP_MS (500 + 400 + 500 + 10) /* csi, link, fwd, bcc */
+#define TEST_ABSENT_XFERS (3 * (PRESENCE_TIMEOUT_MS / PRESENCE_POLL_MS + 1) + 8)
+#define TEST_ABSENT_SLEEP_MS (PRESENCE_TIMEOUT_MS + PRESENCE_POLL_MS)
+#define TEST_SER_INIT_XFERS 16 /* ds90ub953_init */
+#define TEST_PGEN_XFERS (TI954_PGEN_NUM_REGS + 4) /* one pattern generator */
+
+/* concurrent register and alias accesses, lockdep checks the lock order */
+#define TEST_STRESS_THREADS 4
+#define TEST_STRESS_LOOPS 500
+
+/* register file with indirect access banks */
+struct ds90ub954_mock_regs {
+	u8 reg[256];
+	u8 ia[MOCK_NUM_IA_BANKS][256];
+};
+
+/* regmap context, port < 0 for the deserializer */
+struct ds90ub954_mock_map {
+	struct ds90ub954_mock *mock;
+	int port;
+};
+
+struct ds90ub954_mock {
+	struct mutex lock;
+	int num_rx_ports;
+	u32 connected; /* bitmask of rx ports with a serializer */
+	struct ds90ub954_mock_regs des;
+	u8 page[TI960_NUM_RX_PORTS][256]; /* rx port pages */
+	struct ds90ub954_mock_regs ser[TI960_NUM_RX_PORTS];
+	struct ds90ub954_mock_map map[1 + TI960_NUM_RX_PORTS];
+	unsigned int xfers; /* register reads and writes */
+	unsigned int sleep_ms; /* time of ds90ub954_msleep */
+};
+
+struct ds90ub954_test_stress {
+	struct ds90ub954_test *t;
+	int id;
+	int errors; /* failed accesses and read back mismatches */
+	struct completion done;
+};
+
+struct ds90ub954_test {
+	struct ds90ub954_mock mock;
+	struct i2c_adapter adap;
+	struct i2c_client client;
+	struct i2c_client ser_client[TI954_NUM_RX_PORTS];
+	struct ds90ub953_priv ser[TI954_NUM_RX_PORTS];
+	struct ds90ub953_priv *sers[TI954_NUM_RX_PORTS];
+	struct ds90ub954_priv priv;
+};
+
+/*------------------------------------------------------------------------------
+ * REGISTER MOCK
+ *----------------------------------------------------------------------------*/
+
+static void ds90ub954_mock_sleep(struct ds90ub954_mock *mock, unsigned int ms)
+{
+	mutex_lock(&mock->lock);
+	mock->sleep_ms += ms;
+	mutex_unlock(&mock->lock);
+}
+
+static int ds90ub954_mock_locked(struct ds90ub954_mock *mock, int port)
+{
+	return (mock->connected & (1<<port)) &&
+	       (mock->des.reg[TI954_REG_RX_PORT_CTL] & (1<<(TI954_PORT0_EN+port)));
+}
+
+/* IND_ACC_CTL/ADDR/DATA are at the same addresses on 954 and 953 */
+static u8 *ds90ub954_mock_ia(struct ds90ub954_mock_regs *r)
+{
+	int bank = (r->reg[TI954_REG_IND_ACC_CTL]>>TI954_IA_SEL) & 0x7;
+	u8 *val = &r->ia[bank][r->reg[TI954_REG_IND_ACC_ADDR]];
+
+	if(r->reg[TI954_REG_IND_ACC_CTL] & (1<<TI954_IA_AUTO_INC))
+		r->reg[TI954_REG_IND_ACC_ADDR]++;
+	return val;
+}
+
+static unsigned int ds90ub954_mock_des_read(struct ds90ub954_mock *mock,
+					    unsigned int reg)
+{
+	unsigned int val;
+	int port, i;
+
+	if(reg == TI954_REG_IND_ACC_DATA)
+		return *ds90ub954_mock_ia(&mock->des);
+
+	if(reg == TI954_REG_DEVICE_STS) {
+		/* bits 0/1 read as 1, 0xdf with lock and pass */
+		val = (1<<TI954_CFG_CKSUM_STS) | (1<<TI954_CFG_INIT_DONE) |
+		      (1<<TI954_REFCLK_VALID) | 0x3;
+		for(i = 0; i < mock->num_rx_ports; i++) {
+			if(ds90ub954_mock_locked(mock, i))
+				val |= (1<<TI954_LOCK) | (1<<TI954_PASS);
+		}
+		return val;
+	}
+
+	if(!ds90ub954_reg_paged(reg))
+		return mock->des.reg[reg];
+
+	port = (mock->des.reg[TI954_REG_FPD3_PORT_SEL]>>TI954_RX_READ_PORT) & 0x3;
+	if(port >= mock->num_rx_ports)
+		return 0;
+	if(reg == TI954_REG_RX_PORT_STS1) {
+		val = (port<<TI954_RX_PORT_NUM);
+		if(ds90ub954_mock_locked(mock, port))
+			val |= (1<<TI954_LOCK_STS) | (1<<TI954_PORT_PASS);
+		return val;
+	}
+	return mock->page[port][reg];
+}
+
+static void ds90ub954_mock_des_write(struct ds90ub954_mock *mock,
+				     unsigned int reg, unsigned int val)
+{
+	int i;
+
+	if(reg == TI954_REG_IND_ACC_DATA) {
+		*ds90ub954_mock_ia(&mock->des) = val;
+		return;
+	}
+	if(reg == TI954_REG_DEVICE_STS)
+		return;
+
+	if(ds90ub954_reg_paged(reg)) {
+		/* written to all rx ports selected by RX_WRITE_PORT_x */
+		for(i = 0; i < mock->num_rx_ports; i++) {
+			if(mock->des.reg[TI954_REG_FPD3_PORT_SEL] &
+			   (1<<(TI954_RX_WRITE_PORT_0+i)))
+				mock->page[i][reg] = val;
+		}
+		return;
+	}
+	mock->des.reg[reg] = val;
+}
+
+static int ds90ub954_mock_reg_read(void *context, unsigned int reg,
+				   unsigned int *val)
+{
+	struct ds90ub954_mock_map *map = context;
+	struct ds90ub954_mock *mock = map->mock;
+	struct ds90ub954_mock_regs *r;
+	int err = 0;
+
+	mutex_lock(&mock->lock);
+	mock->xfers++;
+	if(map->port < 0) {
+		*val = ds90ub954_mock_des_read(mock, reg);
+	} else if(!ds90ub954_mock_locked(mock, map->port)) {
+		err = -ENXIO;
+	} else {
+		r = &mock->ser[map->port];
+		if(reg == TI953_REG_IND_ACC_DATA)
+			*val = *ds90ub954_mock_ia(r);
+		else
+			*val = r->reg[reg];
+	}
+	mutex_unlock(&mock->lock);
+	return err;
+}
+
+static int ds90ub954_mock_reg_write(void *context, unsigned int reg,
+				    unsigned int val)
+{
+	struct ds90ub954_mock_map *map = context;
+	struct ds90ub954_mock *mock = map->mock;
+	struct ds90ub954_mock_regs *r;
+	int err = 0;
+
+	mutex_lock(&mock->lock);
+	mock->xfers++;
+	if(map->port < 0) {
+		ds90ub954_mock_des_write(mock, reg, val);
+	} else if(!ds90ub954_mock_locked(mock, map->port)) {
+		err = -ENXIO;
+	} else {
+		r = &mock->ser[map->port];
+		if(reg == TI953_REG_IND_ACC_DATA)
+			*ds90ub954_mock_ia(r) = val;
+		else if(reg != TI953_REG_DEVICE_STS)
+			r->reg[reg] = val;
+	}
+	mutex_unlock(&mock->lock);
+	return err;
+}
+
+static const struct regmap_config ds90ub954_mock_regmap_config = {
+	.reg_bits = 8,
+	.val_bits = 8,
+	.max_register = 0xff,
+	.reg_read = ds90ub954_mock_reg_read,
+	.reg_write = ds90ub954_mock_reg_write,
+};
+
+static void ds90ub954_mock_reset(struct ds90ub954_mock *mock, int num_rx_ports)
+{
+	int i;
+
+	mutex_init(&mock->lock);
+	mock->num_rx_ports = num_rx_ports;
+	mock->des.reg[TI954_REG_I2C_DEV_ID] = MOCK_DES_ADDR<<1;
+	mock->des.reg[TI954_REG_REVISION] = 0x20;
+	mock->des.reg[TI954_REG_REFCLK_FREQ] = TI954_REFCLK_DEFAULT_MHZ;
+	mock->des.reg[TI954_REG_FPD3_PORT_SEL] = (1<<TI954_RX_WRITE_PORT_0);
+	memcpy(&mock->des.reg[TI954_REG_FPD3_RX_ID0], "_UB954",
+	       TI954_RX_ID_LENGTH);
+
+	for(i = 0; i < num_rx_ports; i++) {
+		mock->ser[i].reg[TI953_REG_I2C_DEV_ID] = MOCK_SER_ADDR<<1;
+		memcpy(&mock->ser[i].reg[TI953_REG_FPD3_RX_ID0], "_UB953",
+		       TI953_RX_ID_LENGTH);
+	}
+}
+
+static unsigned int ds90ub954_mock_xfers(struct ds90ub954_mock *mock)
+{
+	unsigned int xfers;
+
+	mutex_lock(&mock->lock);
+	xfers = mock->xfers;
+	mock->xfers = 0;
+	mock->sleep_ms = 0;
+	mutex_unlock(&mock->lock);
+	return xfers;
+}
+
+/*------------------------------------------------------------------------------
+ * TEST SETUP
+ *----------------------------------------------------------------------------*/
+
+static struct regmap *ds90ub954_test_regmap(struct kunit *test,
+					    struct ds90ub954_mock *mock,
+					    int port)
+{
+	struct ds90ub954_mock_map *map = &mock->map[1 + port];
+	struct regmap *regmap;
+
+	map->mock = mock;
+	map->port = port;
+	regmap = regmap_init(NULL, NULL, map, &ds90ub954_mock_regmap_config);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, regmap);
+	return regmap;
+}
+
+/* deserializer with one serializer per rx port, set up like probe and
+ * parse_dt without a device tree */
+static int ds90ub954_test_init(struct kunit *test)
+{
+	struct ds90ub954_test *t;
+	struct ds90ub954_priv *priv;
+	struct ds90ub953_priv *ser;
+	int i;
+
+	t = kunit_kzalloc(test, sizeof(*t), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, t);
+	test->priv = t;
+
+	ds90ub954_mock_reset(&t->mock, TI954_NUM_RX_PORTS);
+	t->mock.connected = (1<<0);
+
+	t->client.dev.init_name = "ds90ub954-test";
+	t->client.adapter = &t->adap;
+	t->client.addr = MOCK_DES_ADDR;
+
+	priv = &t->priv;
+	priv->client = &t->client;
+	priv->mock = &t->mock;
+	priv->chip = &ds90ub954_chip;
+	priv->sel_rx_port = -1;
+	priv->sel_ia_config = -1;
+	mutex_init(&priv->reg_lock);
+	mutex_init(&priv->alias_lock);
+	mutex_init(&priv->gpio_lock);
+	spin_lock_init(&priv->hist.lock);
+	spin_lock_init(&priv->cache_lock);
+	mutex_init(&priv->pm.lock);
+	ds90ub954_retry_init(priv);
+	ds90ub954_pgen_default(&priv->pgen);
+	ds90ub954_port_init(priv);
+	priv->csi_lane_count = 4;
+	priv->csi_lane_speed = 1600;
+	priv->bc_freq_select = TI954_BC_FREQ_50M;
+	priv->bcc.wd_ms = -1;
+	priv->bcc.irq = -ENOENT;
+	priv->regmap = ds90ub954_test_regmap(test, &t->mock, -1);
+
+	priv->ser = t->sers;
+	priv->num_ser = TI954_NUM_RX_PORTS;
+	for(i = 0; i < TI954_NUM_RX_PORTS; i++) {
+		ser = &t->ser[i];
+		t->sers[i] = ser;
+		t->ser_client[i].dev.init_name = "ds90ub953-test";
+		t->ser_client[i].adapter = &t->adap;
+		t->ser_client[i].addr = MOCK_SER_ADDR;
+
+		ser->client = &t->ser_client[i];
+		ser->parent = priv;
+		ser->rx_channel = i;
+		ser->initialized = (i == 0);
+		ser->configured = 1;
+		ser->csi_lane_count = 4;
+		ser->i2c_address = MOCK_SER_ADDR;
+		ser->gpio_oc[0] = ser->gpio_oc[1] = 0b1000;
+		ser->gpio_oc[2] = ser->gpio_oc[3] = 0b1000;
+		ser->hs_clk_div = 0x2;
+		ser->div_m_val = 1;
+		ser->div_n_val = 0x28;
+		ser->vc_map = 0xe4;
+		mutex_init(&ser->lock);
+		mutex_init(&ser->gpio_lock);
+		spin_lock_init(&ser->hist.lock);
+		spin_lock_init(&ser->cache_lock);
+		ds90ub954_pgen_default(&ser->pgen);
+		mutex_init(&ser->batch.lock);
+		ser->regmap = ds90ub954_test_regmap(test, &t->mock, i);
+	}
+	return 0;
+}
+
+static void ds90ub954_test_exit(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	int i;
+
+	for(i = 0; i < TI954_NUM_RX_PORTS; i++)
+		regmap_exit(t->ser[i].regmap);
+	regmap_exit(t->priv.regmap);
+}
+
+/* checks the budget of the path run since the last call */
+static void ds90ub954_test_budget(struct kunit *test, unsigned int xfers,
+				  unsigned int sleep_ms)
+{
+	struct ds90ub954_test *t = test->priv;
+	unsigned int slept = t->mock.sleep_ms;
+
+	KUNIT_EXPECT_LE(test, ds90ub954_mock_xfers(&t->mock), xfers);
+	KUNIT_EXPECT_LE(test, slept, sleep_ms);
+}
+
+/*------------------------------------------------------------------------------
+ * TEST CASES
+ *----------------------------------------------------------------------------*/
+
+static void ds90ub954_test_des_init(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct ds90ub954_mock *mock = &t->mock;
+	u8 *page = mock->page[0];
+
+	KUNIT_ASSERT_EQ(test, ds90ub954_init(priv, 0), 0);
+	ds90ub954_test_budget(test, TEST_INIT_XFERS, TEST_INIT_SLEEP_MS);
+
+	KUNIT_EXPECT_EQ(test, priv->dev_id, MOCK_DES_ADDR<<1);
+	KUNIT_EXPECT_STREQ(test, priv->id_code, "_UB954");
+	KUNIT_EXPECT_EQ(test, priv->refclk_freq, 25000000);
+	KUNIT_EXPECT_EQ(test, mock->des.reg[TI954_REG_BIST_CONTROL], 0);
+	KUNIT_EXPECT_EQ(test, mock->des.reg[TI954_REG_CSI_PLL_CTL], 0);
+	KUNIT_EXPECT_EQ(test, mock->des.reg[TI954_REG_CSI_CTL],
+			(1<<TI954_CSI_ENABLE) | (TI954_CSI_4_LANE<<TI954_CSI_LANE_COUNT) |
+			(1<<TI954_CSI_CAL_EN));
+	KUNIT_EXPECT_EQ(test, mock->des.reg[TI954_REG_RX_PORT_CTL],
+			ds90ub954_chip.rx_port_ctl | (1<<TI954_PORT0_EN));
+	KUNIT_EXPECT_EQ(test, mock->des.reg[TI954_REG_FWD_CTL1] &
+			(1<<TI954_FWD_PORT0_DIS), 0);
+	KUNIT_EXPECT_EQ(test, mock->des.reg[TI954_REG_INTERRUPT_CTL],
+			(1<<TI954_INT_EN) | (1<<TI954_IE_RX0));
+
+	/* rx port 0 */
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_BCC_CONFIG],
+			ds90ub954_bcc_config(priv, &t->ser[0]));
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_SER_ALIAS_ID],
+			MOCK_SER_ADDR<<TI954_SER_ALIAS_ID);
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_BC_GPIO_CTL0],
+			(0b1000<<TI954_BC_GPIO0_SEL) | (0b1000<<TI954_BC_GPIO1_SEL));
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_CSI_VC_MAP], 0xe4);
+	KUNIT_EXPECT_EQ(test, ds90ub954_port_get_state(priv, 0), PORT_ALIASED);
+}
+
+/* rx port 1 without camera is disabled again if there is no hot-plug */
+static void ds90ub954_test_des_init_absent(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct ds90ub954_mock *mock = &t->mock;
+
+	t->ser[1].initialized = 1;
+	KUNIT_ASSERT_EQ(test, ds90ub954_init(priv, 0), 0);
+	ds90ub954_test_budget(test, TEST_INIT_XFERS + TEST_ABSENT_XFERS,
+			      TEST_INIT_SLEEP_MS + TEST_ABSENT_SLEEP_MS);
+
+	KUNIT_EXPECT_EQ(test, t->ser[1].initialized, 0);
+	KUNIT_EXPECT_EQ(test, ds90ub954_port_get_state(priv, 1), PORT_FAULT);
+	KUNIT_EXPECT_EQ(test, mock->des.reg[TI954_REG_RX_PORT_CTL] &
+			(1<<(TI954_PORT0_EN+1)), 0);
+	KUNIT_EXPECT_NE(test, mock->des.reg[TI954_REG_FWD_CTL1] &
+			(1<<(TI954_FWD_PORT0_DIS+1)), 0);
+	KUNIT_EXPECT_EQ(test, ds90ub954_port_get_state(priv, 0), PORT_ALIASED);
+}
+
+/* device tree pairs are pinned, an empty pair keeps its slot free */
+static void ds90ub954_test_aliases(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct ds90ub953_priv *ser = &t->ser[0];
+	u8 *page = t->mock.page[0];
+
+	ser->i2c_alias_num = 3;
+	ser->i2c_slave[0] = 0x50;
+	ser->i2c_alias[0] = 0x60;
+	ser->i2c_slave[2] = 0x51;
+	ser->i2c_alias[2] = 0x61;
+	priv->alias_pool[0] = 0x70;
+	priv->alias_pool[1] = 0x71;
+	priv->alias_pool_num = 2;
+
+	KUNIT_ASSERT_EQ(test, ds90ub954_init(priv, 0), 0);
+	ds90ub954_test_budget(test, TEST_INIT_XFERS, TEST_INIT_SLEEP_MS);
+
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_SLAVE_ID0], 0x50<<TI954_SLAVE_ID0);
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_ALIAS_ID0], 0x60<<TI954_ALIAS_ID0);
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_SLAVE_ID0+1], 0);
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_ALIAS_ID0+1], 0);
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_SLAVE_ID0+2], 0x51<<TI954_SLAVE_ID0);
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_ALIAS_ID0+2], 0x61<<TI954_ALIAS_ID0);
+	KUNIT_EXPECT_EQ(test, ser->alias[0].pinned, ALIAS_PIN_DT);
+	KUNIT_EXPECT_EQ(test, ser->alias[1].slave, 0);
+	KUNIT_EXPECT_EQ(test, ser->alias[2].pinned, ALIAS_PIN_DT);
+
+	/* pinned pairs are found without bus traffic */
+	KUNIT_EXPECT_EQ(test, ds90ub954_alias_get(priv, ser, 0x51), 0x61);
+	ds90ub954_test_budget(test, 0, 0);
+
+	/* a new slave takes the free slot and the first pool address */
+	KUNIT_EXPECT_EQ(test, ds90ub954_alias_get(priv, ser, 0x52), 0x70);
+	ds90ub954_test_budget(test, 3, 0);
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_SLAVE_ID0+1], 0x52<<TI954_SLAVE_ID0);
+	KUNIT_EXPECT_EQ(test, page[TI954_REG_ALIAS_ID0+1], 0x70<<TI954_ALIAS_ID0);
+	KUNIT_EXPECT_EQ(test, ser->alias[1].pinned, ALIAS_PIN_NONE);
+	KUNIT_EXPECT_EQ(test, ds90ub954_alias_get(priv, ser, 0x52), 0x70);
+	ds90ub954_test_budget(test, 0, 0);
+}
+
+/* the slot of a remote-devices client is not reclaimed until it is unpinned */
+static void ds90ub954_test_alias_pin(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct ds90ub953_priv *ser = &t->ser[0];
+	int i;
+
+	for(i = 0; i < NUM_ALIAS; i++)
+		priv->alias_pool[i] = 0x70 + i;
+	priv->alias_pool_num = NUM_ALIAS;
+	KUNIT_ASSERT_EQ(test, ds90ub954_init(priv, 0), 0);
+
+	KUNIT_EXPECT_EQ(test, ds90ub954_alias_pin(priv, ser, 0x40,
+						  ALIAS_PIN_REMOTE), 0x70);
+	for(i = 1; i < NUM_ALIAS; i++)
+		KUNIT_EXPECT_EQ(test, ds90ub954_alias_get(priv, ser, 0x40 + i),
+				0x70 + i);
+
+	/* all slots used, the least recently used dynamic one is reclaimed */
+	KUNIT_EXPECT_EQ(test, ds90ub954_alias_get(priv, ser, 0x48), 0x71);
+	KUNIT_EXPECT_EQ(test, ser->alias[0].slave, 0x40);
+	KUNIT_EXPECT_EQ(test, t->mock.page[0][TI954_REG_SLAVE_ID0+1],
+			0x48<<TI954_SLAVE_ID0);
+
+	ds90ub954_alias_unpin(priv, ser, 0x70, ALIAS_PIN_REMOTE);
+	KUNIT_EXPECT_EQ(test, ser->alias[0].pinned, ALIAS_PIN_NONE);
+	KUNIT_EXPECT_EQ(test, ds90ub954_alias_get(priv, ser, 0x49), 0x70);
+	KUNIT_EXPECT_EQ(test, t->mock.page[0][TI954_REG_SLAVE_ID0],
+			0x49<<TI954_SLAVE_ID0);
+
+	/* slots of in-flight remote writes are not reclaimed either */
+	for(i = 0; i < NUM_ALIAS; i++)
+		KUNIT_EXPECT_GT(test, ds90ub954_alias_pin(priv, ser,
+				ser->alias[i].slave, ALIAS_PIN_BATCH), 0);
+	KUNIT_EXPECT_EQ(test, ds90ub954_alias_pin(priv, ser, 0x4a,
+						  ALIAS_PIN_BATCH), -EBUSY);
+	ds90ub954_alias_unpin(priv, ser, 0, ALIAS_PIN_BATCH);
+	KUNIT_EXPECT_EQ(test, ser->alias[1].pinned, ALIAS_PIN_NONE);
+	KUNIT_EXPECT_GT(test, ds90ub954_alias_get(priv, ser, 0x4a), 0);
+}
+
+static void ds90ub954_test_ser_init(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct ds90ub953_priv *ser = &t->ser[0];
+	u8 *reg = t->mock.ser[0].reg;
+	int err;
+
+	KUNIT_ASSERT_EQ(test, ds90ub954_init(priv, 0), 0);
+	ds90ub954_mock_xfers(&t->mock);
+
+	mutex_lock(&ser->lock);
+	err = ds90ub953_init(ser);
+	mutex_unlock(&ser->lock);
+	KUNIT_ASSERT_EQ(test, err, 0);
+	ds90ub954_test_budget(test, TEST_SER_INIT_XFERS, 0);
+
+	KUNIT_EXPECT_EQ(test, reg[TI953_REG_GENERAL_CFG],
+			(1<<TI953_I2C_STRAP_MODE) | (1<<TI953_CRC_TX_GEN_ENABLE) |
+			(TI953_CSI_LANE_SEL4<<TI953_CSI_LANE_SEL));
+	KUNIT_EXPECT_EQ(test, reg[TI953_REG_CLKOUT_CTRL0],
+			(0x2<<TI953_HS_CLK_DIV) | (1<<TI953_DIV_M_VAL));
+	KUNIT_EXPECT_EQ(test, reg[TI953_REG_CLKOUT_CTRL1],
+			0x28<<TI953_DIV_N_VAL);
+	KUNIT_EXPECT_EQ(test, reg[TI953_REG_LOCAL_GPIO_DATA],
+			0xf<<TI953_GPIO_RMTEN);
+	KUNIT_EXPECT_EQ(test, reg[TI953_REG_BCC_CONFIG],
+			(1<<TI953_I2C_PASS_THROUGH_ALL) |
+			(1<<TI953_RX_PARITY_CHECKER_ENABLE));
+	KUNIT_EXPECT_EQ(test, ds90ub954_port_get_state(priv, 0),
+			PORT_STREAMING);
+}
+
+/* device tree property of a test node, u32 values are big endian */
+#define TEST_DT_U32(_name, _val) { .name = (_name), .length = sizeof(__be32), \
+				   .value = &(__be32){ cpu_to_be32(_val) } }
+#define TEST_DT_BOOL(_name) { .name = (_name) }
+
+static void ds90ub954_test_dt_node(struct device_node *np,
+				   struct property *props, int num_props)
+{
+	int i;
+
+	of_node_init(np);
+	np->name = "serializer";
+	np->full_name = "serializer";
+	for(i = 0; i < num_props - 1; i++)
+		props[i].next = &props[i + 1];
+	np->properties = props;
+}
+
+/* serializer properties and slave/alias pairs of the device tree */
+static void ds90ub954_test_parse_dt(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct property props[] = {
+		TEST_DT_U32("rx-channel", 1),
+		TEST_DT_BOOL("test-pattern"),
+		TEST_DT_U32("csi-lane-count", 2),
+		TEST_DT_U32("gpio1-output-enable", 1),
+		TEST_DT_U32("gpio1-control", 0b0011),
+		TEST_DT_U32("hs-clk-div", 8),
+		TEST_DT_U32("parity-error-threshold", 0x12345),
+		TEST_DT_U32("i2c-address", 0x19),
+		TEST_DT_BOOL("continuous-clock"),
+		TEST_DT_U32("virtual-channel-map", 0x1b),
+	};
+	struct of_phandle_args slaves = {
+		.args_count = 2, .args = { 0x50, 0x51 },
+	};
+	struct of_phandle_args aliases = {
+		.args_count = 2, .args = { 0x60, 0x61 },
+	};
+	struct ds90ub953_priv *ser;
+	struct device_node np;
+
+	ser = kunit_kzalloc(test, sizeof(*ser), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, ser);
+	priv->i2c_scl_freq = 400000;
+
+	/* properties not in the node get their default value */
+	ds90ub954_test_dt_node(&np, props, ARRAY_SIZE(props));
+	KUNIT_ASSERT_EQ(test, ds90ub953_parse_dt_ser(priv, ser, &np), 0);
+	KUNIT_EXPECT_EQ(test, ser->rx_channel, 1);
+	KUNIT_EXPECT_EQ(test, ser->test_pattern, 1);
+	KUNIT_EXPECT_EQ(test, ser->csi_lane_count, 2);
+	KUNIT_EXPECT_EQ(test, ser->gpio_oe[0], 0);
+	KUNIT_EXPECT_EQ(test, ser->gpio_oe[1], 1);
+	KUNIT_EXPECT_EQ(test, ser->gpio_oc[0], 0b1000);
+	KUNIT_EXPECT_EQ(test, ser->gpio_oc[1], 0b0011);
+	KUNIT_EXPECT_EQ(test, ser->hs_clk_div, 0b011);
+	KUNIT_EXPECT_EQ(test, ser->div_m_val, 1);
+	KUNIT_EXPECT_EQ(test, ser->div_n_val, 0x28);
+	KUNIT_EXPECT_EQ(test, ser->clkout_rate, 0);
+	KUNIT_EXPECT_EQ(test, ser->par_err_thold, 0xffff);
+	KUNIT_EXPECT_EQ(test, ser->i2c_address, 0x19);
+	KUNIT_EXPECT_EQ(test, ser->conts_clk, 1);
+	KUNIT_EXPECT_EQ(test, ser->i2c_pt, 0);
+	KUNIT_EXPECT_EQ(test, ser->i2c_scl_freq, 400000);
+	KUNIT_EXPECT_EQ(test, ser->vc_map, 0x1b);
+	KUNIT_EXPECT_EQ(test, ser->batch.deadline_ms, 33);
+
+	/* an rx port the chip doesn't have is rejected */
+	*(__be32 *)props[0].value = cpu_to_be32(TI954_NUM_RX_PORTS);
+	KUNIT_EXPECT_EQ(test, ds90ub953_parse_dt_ser(priv, ser, &np), -EINVAL);
+
+	ds90ub953_parse_alias_pairs(priv, ser, &slaves, &aliases);
+	KUNIT_EXPECT_EQ(test, ser->i2c_alias_num, 2);
+	KUNIT_EXPECT_EQ(test, ser->i2c_slave[0], 0x50);
+	KUNIT_EXPECT_EQ(test, ser->i2c_alias[0], 0x60);
+	KUNIT_EXPECT_EQ(test, ser->i2c_slave[1], 0x51);
+	KUNIT_EXPECT_EQ(test, ser->i2c_alias[1], 0x61);
+
+	/* without the slave-alias list there are no pairs */
+	ds90ub953_parse_alias_pairs(priv, ser, &slaves, NULL);
+	KUNIT_EXPECT_EQ(test, ser->i2c_alias_num, 0);
+}
+
+/* pattern generator registers of the deserializer and a serializer */
+static void ds90ub954_test_pattern(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct ds90ub953_priv *ser = &t->ser[0];
+	struct ds90ub954_mock *mock = &t->mock;
+	struct ds90ub954_pgen_timing timing;
+	int err;
+
+	KUNIT_ASSERT_EQ(test, ds90ub954_pgen_calc(&priv->pgen,
+						  ds90ub954_csi_kbps(priv),
+						  &timing), 0);
+	/* the default is the former fixed pattern */
+	KUNIT_EXPECT_EQ(test, timing.regs[TI954_REG_IA_PGEN_TOT_LPF1], 0x08);
+	KUNIT_EXPECT_EQ(test, timing.regs[TI954_REG_IA_PGEN_TOT_LPF0], 0x70);
+	KUNIT_EXPECT_EQ(test, timing.regs[TI954_REG_IA_PGEN_LINE_PD1], 0x0b);
+	KUNIT_EXPECT_EQ(test, timing.regs[TI954_REG_IA_PGEN_LINE_PD0], 0x93);
+	KUNIT_EXPECT_EQ(test, timing.regs[TI954_REG_IA_PGEN_VBP], 33);
+	KUNIT_EXPECT_EQ(test, timing.regs[TI954_REG_IA_PGEN_VFP], 10);
+
+	priv->test_pattern = 1;
+	KUNIT_ASSERT_EQ(test, ds90ub954_init(priv, 0), 0);
+	ds90ub954_test_budget(test, TEST_INIT_XFERS + TEST_PGEN_XFERS,
+			      TEST_INIT_SLEEP_MS);
+	KUNIT_EXPECT_TRUE(test, mock->des.ia[0][TI954_REG_IA_PGEN_CTL] &
+			  (1<<TI954_PGEB_ENABLE));
+	KUNIT_EXPECT_MEMEQ(test, &mock->des.ia[0][TI954_REG_IA_PGEB_CFG],
+			   &timing.regs[TI954_REG_IA_PGEB_CFG],
+			   TI954_PGEN_NUM_REGS - TI954_REG_IA_PGEB_CFG);
+
+	ser->test_pattern = 1;
+	mutex_lock(&ser->lock);
+	err = ds90ub953_init(ser);
+	mutex_unlock(&ser->lock);
+	KUNIT_ASSERT_EQ(test, err, 0);
+	ds90ub954_test_budget(test, TEST_SER_INIT_XFERS + TEST_PGEN_XFERS, 0);
+	KUNIT_EXPECT_TRUE(test,
+			  mock->ser[0].ia[TI953_IA_PGEN_BANK][TI953_REG_IA_PGEN_CTL] &
+			  (1<<TI953_PGEN_ENABLE));
+	KUNIT_EXPECT_MEMEQ(test,
+			   &mock->ser[0].ia[TI953_IA_PGEN_BANK][TI953_REG_IA_PGEN_CFG],
+			   &timing.regs[TI953_REG_IA_PGEN_CFG],
+			   TI954_PGEN_NUM_REGS - TI953_REG_IA_PGEN_CFG);
+	/* auto increment is left off for single indirect accesses */
+	KUNIT_EXPECT_EQ(test, mock->ser[0].reg[TI953_REG_IND_ACC_CTL],
+			TI953_IA_PGEN_BANK<<TI953_IA_SEL);
+
+	/* the cable test sleeps through the mock, two frames and the duration */
+	ds90ub954_mock_xfers(mock);
+	mutex_lock(&ser->lock);
+	ser->initialized = 1;
+	err = ds90ub953_pgen_test(ser, 100);
+	mutex_unlock(&ser->lock);
+	KUNIT_EXPECT_EQ(test, err, 0);
+	KUNIT_EXPECT_EQ(test, mock->sleep_ms,
+			100 + DIV_ROUND_UP(2 * 1000 * 1000, timing.fps_milli));
+	KUNIT_EXPECT_TRUE(test, ser->pgen_result.valid);
+}
+
+static void ds90ub954_test_port_replay(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct ds90ub953_priv *ser = &t->ser[0];
+	u8 *reg = t->mock.ser[0].reg;
+	u8 general_cfg;
+	int err;
+
+	KUNIT_ASSERT_EQ(test, ds90ub954_init(priv, 0), 0);
+	mutex_lock(&ser->lock);
+	err = ds90ub953_init(ser);
+	mutex_unlock(&ser->lock);
+	KUNIT_ASSERT_EQ(test, err, 0);
+	general_cfg = reg[TI953_REG_GENERAL_CFG];
+
+	/* a port gate keeps the serializer configuration */
+	KUNIT_ASSERT_EQ(test, ds90ub954_port_power_off(priv, ser), 0);
+	KUNIT_ASSERT_EQ(test, ds90ub954_port_power_on(priv, ser), 0);
+	KUNIT_EXPECT_EQ(test, reg[TI953_REG_GENERAL_CFG], general_cfg);
+
+	/* gated over a suspend, the serializer lost power */
+	KUNIT_ASSERT_EQ(test, ds90ub954_port_power_off(priv, ser), 0);
+	set_bit(0, &priv->pm.ser_lost);
+	reg[TI953_REG_GENERAL_CFG] = 0;
+	KUNIT_ASSERT_EQ(test, ds90ub954_port_power_on(priv, ser), 0);
+	KUNIT_EXPECT_EQ(test, reg[TI953_REG_GENERAL_CFG], general_cfg);
+	KUNIT_EXPECT_FALSE(test, test_bit(0, &priv->pm.ser_lost));
+	KUNIT_EXPECT_EQ(test, ds90ub954_port_get_state(priv, 0),
+			PORT_STREAMING);
+}
+
+/*
+ * Every thread owns a paged register of one rx port, so a read back only
+ * differs if a port selection raced. It also maps its own remote slave and
+ * reads the serializer over the back channel.
+ */
+static int ds90ub954_test_stress_fn(void *data)
+{
+	struct ds90ub954_test_stress *st = data;
+	struct ds90ub954_priv *priv = &st->t->priv;
+	struct ds90ub953_priv *ser = &st->t->ser[0];
+	int port = st->id % 2;
+	int reg = st->id < 2 ? TI954_REG_PAR_ERR_THOLD_HI :
+			       TI954_REG_PAR_ERR_THOLD_LO;
+	int i, val, err;
+
+	for(i = 0; i < TEST_STRESS_LOOPS; i++) {
+		err = ds90ub954_write_rx_port(priv, port, reg, i & 0xff);
+		if(!err)
+			err = ds90ub954_read_rx_port(priv, port, reg, &val);
+		if(err || val != (i & 0xff))
+			st->errors++;
+
+		if(ds90ub954_alias_get(priv, ser, 0x52 + st->id) < 0)
+			st->errors++;
+
+		mutex_lock(&ser->lock);
+		err = ds90ub953_read(ser, TI953_REG_I2C_DEV_ID, &val);
+		mutex_unlock(&ser->lock);
+		if(err || val != MOCK_SER_ADDR<<1)
+			st->errors++;
+	}
+	complete(&st->done);
+	return 0;
+}
+
+static void ds90ub954_test_stress(struct kunit *test)
+{
+	struct ds90ub954_test *t = test->priv;
+	struct ds90ub954_priv *priv = &t->priv;
+	struct ds90ub953_priv *ser = &t->ser[0];
+	struct ds90ub954_test_stress *st;
+	struct ds90ub953_alias *slot;
+	struct task_struct *task;
+	u8 *page = t->mock.page[0];
+	int i;
+
+	for(i = 0; i < TEST_STRESS_THREADS; i++)
+		priv->alias_pool[i] = 0x70 + i;
+	priv->alias_pool_num = TEST_STRESS_THREADS;
+	KUNIT_ASSERT_EQ(test, ds90ub954_init(priv, 0), 0);
+
+	st = kunit_kcalloc(test, TEST_STRESS_THREADS, sizeof(*st), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, st);
+	for(i = 0; i < TEST_STRESS_THREADS; i++) {
+		st[i].t = t;
+		st[i].id = i;
+		init_completion(&st[i].done);
+		task = kthread_run(ds90ub954_test_stress_fn, &st[i],
+				   "ds90ub954_stress%d", i);
+		if(IS_ERR(task)) {
+			st[i].errors = PTR_ERR(task);
+			complete(&st[i].done);
+		}
+	}
+	for(i = 0; i < TEST_STRESS_THREADS; i++) {
+		wait_for_completion(&st[i].done);
+		KUNIT_EXPECT_EQ(test, st[i].errors, 0);
+	}
+
+	/* the slots match the programmed SLAVE_ID/ALIAS_ID pairs */
+	for(i = 0; i < NUM_ALIAS; i++) {
+		slot = &ser->alias[i];
+		KUNIT_EXPECT_EQ(test, page[TI954_REG_SLAVE_ID0+i],
+				slot->slave<<TI954_SLAVE_ID0);
+		KUNIT_EXPECT_EQ(test, page[TI954_REG_ALIAS_ID0+i],
+				slot->alias<<TI954_ALIAS_ID0);
+	}
+}
+
+static struct kunit_case ds90ub954_test_cases[] = {
+	KUNIT_CASE(ds90ub954_test_des_init),
+	KUNIT_CASE(ds90ub954_test_des_init_absent),
+	KUNIT_CASE(ds90ub954_test_aliases),
+	KUNIT_CASE(ds90ub954_test_alias_pin),
+	KUNIT_CASE(ds90ub954_test_ser_init),
+	KUNIT_CASE(ds90ub954_test_parse_dt),
+	KUNIT_CASE(ds90ub954_test_pattern),
+	KUNIT_CASE(ds90ub954_test_port_replay),
+	KUNIT_CASE(ds90ub954_test_stress),
+	{}
+};
+
+static struct kunit_suite ds90ub954_test_suite = {
+	.name = "ds90ub954",
+	.init = ds90ub954_test_init,
+	.exit = ds90ub954_test_exit,
+	.test_cases = ds90ub954_test_cases,
+};
+
+kunit_test_suite(ds90ub954_test_suite);
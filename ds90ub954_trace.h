@@ -0,0 +1,138 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * ds90ub954_trace.h - trace events of the DS90UB954 driver
+ *
+ * Copyright (c) 2020, Institut of Embedded Systems ZHAW
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM ds90ub954
+
+#if !defined(_DS90UB954_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _DS90UB954_TRACE_H
+
+#include <linux/device.h>
+#include <linux/tracepoint.h>
+
+#include "ds90ub954.h"
+
+/*
+ * One event per register access of the deserializer or a serializer. port is
+ * the selected rx port page of the deserializer (-1: unknown) or the rx port
+ * of the serializer, duration is the time of the regmap access.
+ */
+DECLARE_EVENT_CLASS(ds90ub954_reg,
+
+	TP_PROTO(struct device *dev, int port, unsigned int reg,
+		 unsigned int val, int err, u64 duration_ns),
+
+	TP_ARGS(dev, port, reg, val, err, duration_ns),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(int, port)
+		__field(unsigned int, reg)
+		__field(unsigned int, val)
+		__field(int, err)
+		__field(u64, duration_ns)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->port = port;
+		__entry->reg = reg;
+		__entry->val = val;
+		__entry->err = err;
+		__entry->duration_ns = duration_ns;
+	),
+
+	TP_printk("%s port=%d reg=0x%02x val=0x%02x err=%d duration=%lluns",
+		  __get_str(dev), __entry->port, __entry->reg, __entry->val,
+		  __entry->err, __entry->duration_ns)
+);
+
+DEFINE_EVENT(ds90ub954_reg, ds90ub954_read,
+	TP_PROTO(struct device *dev, int port, unsigned int reg,
+		 unsigned int val, int err, u64 duration_ns),
+	TP_ARGS(dev, port, reg, val, err, duration_ns)
+);
+
+DEFINE_EVENT(ds90ub954_reg, ds90ub954_write,
+	TP_PROTO(struct device *dev, int port, unsigned int reg,
+		 unsigned int val, int err, u64 duration_ns),
+	TP_ARGS(dev, port, reg, val, err, duration_ns)
+);
+
+DEFINE_EVENT(ds90ub954_reg, ds90ub953_read,
+	TP_PROTO(struct device *dev, int port, unsigned int reg,
+		 unsigned int val, int err, u64 duration_ns),
+	TP_ARGS(dev, port, reg, val, err, duration_ns)
+);
+
+DEFINE_EVENT(ds90ub954_reg, ds90ub953_write,
+	TP_PROTO(struct device *dev, int port, unsigned int reg,
+		 unsigned int val, int err, u64 duration_ns),
+	TP_ARGS(dev, port, reg, val, err, duration_ns)
+);
+
+TRACE_DEFINE_ENUM(PORT_DISABLED);
+TRACE_DEFINE_ENUM(PORT_TRAINING);
+TRACE_DEFINE_ENUM(PORT_LOCKED);
+TRACE_DEFINE_ENUM(PORT_BC_READY);
+TRACE_DEFINE_ENUM(PORT_ALIASED);
+TRACE_DEFINE_ENUM(PORT_STREAMING);
+TRACE_DEFINE_ENUM(PORT_FAULT);
+
+#define show_port_state(state)					\
+	__print_symbolic(state,					\
+			 { PORT_DISABLED, "disabled" },		\
+			 { PORT_TRAINING, "training" },		\
+			 { PORT_LOCKED, "locked" },			\
+			 { PORT_BC_READY, "bc_ready" },		\
+			 { PORT_ALIASED, "aliased" },		\
+			 { PORT_STREAMING, "streaming" },		\
+			 { PORT_FAULT, "fault" })
+
+/*
+ * Transition of the state machine of an rx port. state_us is the time spent
+ * in the old state, total_us the time since the port was enabled.
+ */
+TRACE_EVENT(ds90ub954_port_state,
+
+	TP_PROTO(struct device *dev, int port, int old, int state,
+		 s64 state_us, s64 total_us),
+
+	TP_ARGS(dev, port, old, state, state_us, total_us),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(int, port)
+		__field(int, old)
+		__field(int, state)
+		__field(s64, state_us)
+		__field(s64, total_us)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->port = port;
+		__entry->old = old;
+		__entry->state = state;
+		__entry->state_us = state_us;
+		__entry->total_us = total_us;
+	),
+
+	TP_printk("%s port=%d %s -> %s state=%lldus total=%lldus",
+		  __get_str(dev), __entry->port, show_port_state(__entry->old),
+		  show_port_state(__entry->state), __entry->state_us,
+		  __entry->total_us)
+);
+
+#endif /* _DS90UB954_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE ds90ub954_trace
+
+#include <trace/define_trace.h>
@@ -0,0 +1,703 @@
+/*
+ * ds90ub95x_emu.c - Register level emulator of the FPD-Link III deserializer
+ * DS90UB954/DS90UB960 with DS90UB953 serializers and remote devices
+ *
+ * The emulator registers a virtual i2c adapter. The ds90ub954 driver is
+ * instantiated as child node of the emulator in the device tree and runs
+ * unchanged against the emulated devices. Every bus transaction is counted
+ * per target and the bus time is estimated from the bus frequency.
+ *
+ * Modeled:
+ * - FPD3_PORT_SEL paging of the rx port registers
+ * - IND_ACC indirect access banks of deserializer and serializers
+ * - lock progression in DEVICE_STS/RX_PORT_STS1 with a lock time after the
+ *   rx port is enabled and the port is connected
+ * - SER_ALIAS_ID and SLAVE_ID/ALIAS_ID forwarding to the serializer and to
+ *   emulated remote devices (register files with auto increment)
+ *
+ * Copyright (c) 2019 Institute of Embedded Systems ZHAW
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/debugfs.h>
+#include <linux/i2c.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+
+#include "ds90ub954.h"
+
+#define EMU_NUM_PORTS TI960_NUM_RX_PORTS
+#define EMU_NUM_IA_BANKS 8
+#define EMU_MAX_REMOTE 8
+#define EMU_DEFAULT_DES_ADDR 0x3d
+#define EMU_DEFAULT_SER_ADDR 0x18
+#define EMU_DEFAULT_LOCK_MS 50
+#define EMU_DEFAULT_BUS_FREQ 400000
+
+enum ds90ub95x_emu_target_type {
+	EMU_TARGET_DES = 0,
+	EMU_TARGET_SER,
+	EMU_TARGET_REMOTE,
+	EMU_TARGET_NUM,
+};
+
+static const char * const ds90ub95x_emu_target_names[] = {
+	[EMU_TARGET_DES] = "deserializer",
+	[EMU_TARGET_SER] = "serializer",
+	[EMU_TARGET_REMOTE] = "remote",
+};
+
+struct ds90ub95x_emu_stats {
+	u64 xfers; // i2c_transfer calls addressed to the target
+	u64 msgs;
+	u64 read_bytes;
+	u64 write_bytes;
+	u64 nacks;
+	u64 bus_ns; // estimated bus time incl. address bytes
+};
+
+/* register file with indirect access banks */
+struct ds90ub95x_emu_regs {
+	u8 reg[256];
+	u8 ia[EMU_NUM_IA_BANKS][256];
+	u8 ptr; // register pointer
+};
+
+struct ds90ub95x_emu_remote {
+	int slave; // remote i2c address
+	int reg16; // 16 bit register addresses, high byte ignored
+	u8 reg[256];
+	u8 ptr;
+};
+
+struct ds90ub95x_emu_port {
+	u8 reg[256]; // rx port page, only the paged ranges are used
+	int enabled; // RX_PORT_CTL PORTx_EN
+	ktime_t enabled_at;
+	ktime_t connected_at;
+	int reported_lock; // lock state of the last RX_PORT_STS1 read
+	struct ds90ub95x_emu_regs ser;
+	struct ds90ub95x_emu_remote remote[EMU_MAX_REMOTE];
+	int num_remote;
+};
+
+struct ds90ub95x_emu_target {
+	enum ds90ub95x_emu_target_type type;
+	int port;
+	struct ds90ub95x_emu_remote *remote;
+};
+
+struct ds90ub95x_emu {
+	struct device *dev;
+	struct i2c_adapter adap;
+	struct mutex lock;
+	int des_addr;
+	int num_rx_ports;
+	u32 lock_time_ms;
+	u32 bus_freq;
+	u32 connected; // bitmask of rx ports with a serializer connected
+	struct ds90ub95x_emu_regs des;
+	struct ds90ub95x_emu_port port[EMU_NUM_PORTS];
+	struct ds90ub95x_emu_stats stats[EMU_TARGET_NUM];
+	u64 port_selects; // FPD3_PORT_SEL writes
+	u64 ia_accesses; // IND_ACC_DATA reads and writes
+	struct dentry *debugfs;
+};
+
+/*------------------------------------------------------------------------------
+ * REGISTER MODEL
+ *----------------------------------------------------------------------------*/
+
+static void ds90ub95x_emu_set_id(u8 *reg, const char *id)
+{
+	memcpy(&reg[TI954_REG_FPD3_RX_ID0], id, TI954_RX_ID_LENGTH);
+}
+
+static int ds90ub95x_emu_locked(struct ds90ub95x_emu *emu, int port)
+{
+	struct ds90ub95x_emu_port *p = &emu->port[port];
+	ktime_t now = ktime_get();
+
+	if(!(emu->connected & (1<<port)) || !p->enabled)
+		return 0;
+	return ktime_ms_delta(now, p->enabled_at) >= emu->lock_time_ms &&
+	       ktime_ms_delta(now, p->connected_at) >= emu->lock_time_ms;
+}
+
+/* IND_ACC_CTL/ADDR/DATA are at the same addresses on 954 and 953 */
+static u8 ds90ub95x_emu_ia_read(struct ds90ub95x_emu *emu,
+				struct ds90ub95x_emu_regs *r)
+{
+	int bank = (r->reg[TI954_REG_IND_ACC_CTL]>>TI954_IA_SEL) & 0x7;
+	u8 val = r->ia[bank][r->reg[TI954_REG_IND_ACC_ADDR]];
+
+	if(r->reg[TI954_REG_IND_ACC_CTL] & (1<<TI954_IA_AUTO_INC))
+		r->reg[TI954_REG_IND_ACC_ADDR]++;
+	emu->ia_accesses++;
+	return val;
+}
+
+static void ds90ub95x_emu_ia_write(struct ds90ub95x_emu *emu,
+				   struct ds90ub95x_emu_regs *r, u8 val)
+{
+	int bank = (r->reg[TI954_REG_IND_ACC_CTL]>>TI954_IA_SEL) & 0x7;
+
+	r->ia[bank][r->reg[TI954_REG_IND_ACC_ADDR]] = val;
+	if(r->reg[TI954_REG_IND_ACC_CTL] & (1<<TI954_IA_AUTO_INC))
+		r->reg[TI954_REG_IND_ACC_ADDR]++;
+	emu->ia_accesses++;
+}
+
+/* frame geometry of a serializer pattern generator, received when locked */
+static u8 ds90ub95x_emu_line_reg(struct ds90ub95x_emu_port *p, u8 reg,
+				 int lock)
+{
+	u8 *pgen = p->ser.ia[TI953_IA_PGEN_BANK];
+
+	if(!lock || !(pgen[TI953_REG_IA_PGEN_CTL] & (1<<TI953_PGEN_ENABLE)))
+		return 0;
+
+	switch(reg) {
+	case TI954_REG_LINE_COUNT_HI:
+		return pgen[TI954_REG_IA_PGEN_ACT_LPF1];
+	case TI954_REG_LINE_COUNT_LO:
+		return pgen[TI954_REG_IA_PGEN_ACT_LPF0];
+	case TI954_REG_LINE_LEN_1:
+		return pgen[TI954_REG_IA_PGEN_LINE_SIZE1];
+	default:
+		return pgen[TI954_REG_IA_PGEN_LINE_SIZE0];
+	}
+}
+
+/* rx port specific registers, selected by FPD3_PORT_SEL */
+static int ds90ub95x_emu_paged(u8 reg)
+{
+	return reg == TI954_REG_PAR_ERR_THOLD_HI ||
+	       reg == TI954_REG_PAR_ERR_THOLD_LO ||
+	       (reg > TI954_REG_FPD3_PORT_SEL && reg <= TI954_REG_SEN_INT_FALL_CTL) ||
+	       (reg >= TI954_REG_PORT_DEBUG && reg <= TI954_REG_SEN_INT_FALL_STS);
+}
+
+static u8 ds90ub95x_emu_des_read(struct ds90ub95x_emu *emu, u8 reg)
+{
+	struct ds90ub95x_emu_port *p;
+	int port, i, lock;
+	u8 val;
+
+	if(reg == TI954_REG_IND_ACC_DATA)
+		return ds90ub95x_emu_ia_read(emu, &emu->des);
+
+	if(reg == TI954_REG_DEVICE_STS) {
+		/* bits 0/1 read as 1, 0xdf with lock and pass */
+		val = (1<<TI954_CFG_CKSUM_STS) | (1<<TI954_CFG_INIT_DONE) |
+		      (1<<TI954_REFCLK_VALID) | 0x3;
+		for(i = 0; i < emu->num_rx_ports; i++) {
+			if(ds90ub95x_emu_locked(emu, i))
+				val |= (1<<TI954_LOCK) | (1<<TI954_PASS);
+		}
+		return val;
+	}
+
+	if(!ds90ub95x_emu_paged(reg))
+		return emu->des.reg[reg];
+
+	port = (emu->des.reg[TI954_REG_FPD3_PORT_SEL]>>TI954_RX_READ_PORT) & 0x3;
+	if(port >= emu->num_rx_ports)
+		return 0;
+	p = &emu->port[port];
+	lock = ds90ub95x_emu_locked(emu, port);
+
+	switch(reg) {
+	case TI954_REG_RX_PORT_STS1:
+		val = (port<<TI954_RX_PORT_NUM);
+		if(lock)
+			val |= (1<<TI954_LOCK_STS) | (1<<TI954_PORT_PASS);
+		if(lock != p->reported_lock)
+			val |= (1<<TI954_LOCK_STS_CHG);
+		p->reported_lock = lock;
+		return val;
+	case TI954_REG_RX_PORT_STS2:
+		return lock ? (1<<TI954_FREQ_STABLE) : 0;
+	case TI954_REG_SER_ID:
+		return lock ? (EMU_DEFAULT_SER_ADDR<<1) : 0;
+	case TI954_REG_LINE_COUNT_HI:
+	case TI954_REG_LINE_COUNT_LO:
+	case TI954_REG_LINE_LEN_1:
+	case TI954_REG_LINE_LEN_0:
+		return ds90ub95x_emu_line_reg(p, reg, lock);
+	default:
+		return p->reg[reg];
+	}
+}
+
+static void ds90ub95x_emu_des_write(struct ds90ub95x_emu *emu, u8 reg, u8 val)
+{
+	struct ds90ub95x_emu_port *p;
+	int i;
+
+	if(reg == TI954_REG_IND_ACC_DATA) {
+		ds90ub95x_emu_ia_write(emu, &emu->des, val);
+		return;
+	}
+
+	if(ds90ub95x_emu_paged(reg)) {
+		/* written to all rx ports selected by RX_WRITE_PORT_x */
+		for(i = 0; i < emu->num_rx_ports; i++) {
+			if(emu->des.reg[TI954_REG_FPD3_PORT_SEL] &
+			   (1<<(TI954_RX_WRITE_PORT_0+i)))
+				emu->port[i].reg[reg] = val;
+		}
+		return;
+	}
+
+	switch(reg) {
+	case TI954_REG_DEVICE_STS:
+		return;
+	case TI954_REG_FPD3_PORT_SEL:
+		emu->port_selects++;
+		break;
+	case TI954_REG_RX_PORT_CTL:
+		for(i = 0; i < emu->num_rx_ports; i++) {
+			p = &emu->port[i];
+			if((val & (1<<(TI954_PORT0_EN+i))) && !p->enabled)
+				p->enabled_at = ktime_get();
+			p->enabled = !!(val & (1<<(TI954_PORT0_EN+i)));
+		}
+		break;
+	}
+	emu->des.reg[reg] = val;
+}
+
+static u8 ds90ub95x_emu_ser_read(struct ds90ub95x_emu *emu, int port, u8 reg)
+{
+	struct ds90ub95x_emu_regs *r = &emu->port[port].ser;
+
+	if(reg == TI953_REG_IND_ACC_DATA)
+		return ds90ub95x_emu_ia_read(emu, r);
+	return r->reg[reg];
+}
+
+static void ds90ub95x_emu_ser_write(struct ds90ub95x_emu *emu, int port, u8 reg,
+				    u8 val)
+{
+	struct ds90ub95x_emu_regs *r = &emu->port[port].ser;
+
+	if(reg == TI953_REG_IND_ACC_DATA) {
+		ds90ub95x_emu_ia_write(emu, r, val);
+		return;
+	}
+	if(reg == TI953_REG_DEVICE_STS)
+		return;
+	r->reg[reg] = val;
+}
+
+/* Resolve an i2c address the way the deserializer forwards it */
+static int ds90ub95x_emu_resolve(struct ds90ub95x_emu *emu, u16 addr,
+				 struct ds90ub95x_emu_target *t)
+{
+	struct ds90ub95x_emu_port *p;
+	int port, i, j, slave;
+
+	if(addr == emu->des_addr) {
+		t->type = EMU_TARGET_DES;
+		t->port = 0;
+		return 0;
+	}
+
+	for(port = 0; port < emu->num_rx_ports; port++) {
+		if(!ds90ub95x_emu_locked(emu, port))
+			continue;
+		p = &emu->port[port];
+		t->port = port;
+		if(p->reg[TI954_REG_SER_ALIAS_ID] &&
+		   (p->reg[TI954_REG_SER_ALIAS_ID]>>TI954_SER_ALIAS_ID) == addr) {
+			t->type = EMU_TARGET_SER;
+			return 0;
+		}
+		for(i = 0; i < NUM_ALIAS; i++) {
+			if(!p->reg[TI954_REG_ALIAS_ID0+i] ||
+			   (p->reg[TI954_REG_ALIAS_ID0+i]>>TI954_ALIAS_ID0) != addr)
+				continue;
+			slave = p->reg[TI954_REG_SLAVE_ID0+i]>>TI954_SLAVE_ID0;
+			for(j = 0; j < p->num_remote; j++) {
+				if(p->remote[j].slave == slave) {
+					t->type = EMU_TARGET_REMOTE;
+					t->remote = &p->remote[j];
+					return 0;
+				}
+			}
+		}
+	}
+	return -ENXIO;
+}
+
+static u8 *ds90ub95x_emu_ptr(struct ds90ub95x_emu *emu,
+			     struct ds90ub95x_emu_target *t)
+{
+	switch(t->type) {
+	case EMU_TARGET_SER:
+		return &emu->port[t->port].ser.ptr;
+	case EMU_TARGET_REMOTE:
+		return &t->remote->ptr;
+	default:
+		return &emu->des.ptr;
+	}
+}
+
+static u8 ds90ub95x_emu_read(struct ds90ub95x_emu *emu,
+			     struct ds90ub95x_emu_target *t, u8 reg)
+{
+	switch(t->type) {
+	case EMU_TARGET_SER:
+		return ds90ub95x_emu_ser_read(emu, t->port, reg);
+	case EMU_TARGET_REMOTE:
+		return t->remote->reg[reg];
+	default:
+		return ds90ub95x_emu_des_read(emu, reg);
+	}
+}
+
+static void ds90ub95x_emu_write(struct ds90ub95x_emu *emu,
+				struct ds90ub95x_emu_target *t, u8 reg, u8 val)
+{
+	switch(t->type) {
+	case EMU_TARGET_SER:
+		ds90ub95x_emu_ser_write(emu, t->port, reg, val);
+		break;
+	case EMU_TARGET_REMOTE:
+		t->remote->reg[reg] = val;
+		break;
+	default:
+		ds90ub95x_emu_des_write(emu, reg, val);
+		break;
+	}
+}
+
+/*------------------------------------------------------------------------------
+ * VIRTUAL I2C ADAPTER
+ *----------------------------------------------------------------------------*/
+
+static int ds90ub95x_emu_msg(struct ds90ub95x_emu *emu,
+			     struct ds90ub95x_emu_target *t, struct i2c_msg *msg)
+{
+	struct ds90ub95x_emu_stats *st = &emu->stats[t->type];
+	u8 *ptr = ds90ub95x_emu_ptr(emu, t);
+	int addr_bytes = 1;
+	int i;
+
+	if(msg->flags & I2C_M_RD) {
+		for(i = 0; i < msg->len; i++)
+			msg->buf[i] = ds90ub95x_emu_read(emu, t, (*ptr)++);
+		st->read_bytes += msg->len;
+	} else {
+		/* the register address is the first byte (two for reg16) */
+		if(t->type == EMU_TARGET_REMOTE && t->remote->reg16)
+			addr_bytes = 2;
+		if(msg->len >= addr_bytes)
+			*ptr = msg->buf[addr_bytes-1];
+		for(i = addr_bytes; i < msg->len; i++)
+			ds90ub95x_emu_write(emu, t, (*ptr)++, msg->buf[i]);
+		st->write_bytes += msg->len;
+	}
+	st->msgs++;
+	/* 9 clocks per byte incl. the address byte */
+	st->bus_ns += div_u64((u64)(msg->len + 1) * 9 * NSEC_PER_SEC,
+			      emu->bus_freq);
+	return 0;
+}
+
+static int ds90ub95x_emu_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs,
+			      int num)
+{
+	struct ds90ub95x_emu *emu = i2c_get_adapdata(adap);
+	struct ds90ub95x_emu_target t = {};
+	int i, err = 0;
+
+	mutex_lock(&emu->lock);
+	for(i = 0; i < num; i++) {
+		err = ds90ub95x_emu_resolve(emu, msgs[i].addr, &t);
+		if(err) {
+			emu->stats[EMU_TARGET_DES].nacks++;
+			break;
+		}
+		if(i == 0)
+			emu->stats[t.type].xfers++;
+		ds90ub95x_emu_msg(emu, &t, &msgs[i]);
+	}
+	mutex_unlock(&emu->lock);
+	return err ? err : num;
+}
+
+static u32 ds90ub95x_emu_func(struct i2c_adapter *adap)
+{
+	return I2C_FUNC_I2C | I2C_FUNC_SMBUS_EMUL;
+}
+
+static const struct i2c_algorithm ds90ub95x_emu_algo = {
+	.master_xfer = ds90ub95x_emu_xfer,
+	.functionality = ds90ub95x_emu_func,
+};
+
+/*------------------------------------------------------------------------------
+ * DEBUGFS
+ *----------------------------------------------------------------------------*/
+
+static int ds90ub95x_emu_stats_show(struct seq_file *s, void *data)
+{
+	struct ds90ub95x_emu *emu = s->private;
+	struct ds90ub95x_emu_stats *st;
+	int i;
+
+	mutex_lock(&emu->lock);
+	seq_printf(s, "%-14s %10s %10s %12s %12s %8s %12s\n", "target",
+		   "xfers", "msgs", "read bytes", "write bytes", "nacks",
+		   "bus us");
+	for(i = 0; i < EMU_TARGET_NUM; i++) {
+		st = &emu->stats[i];
+		seq_printf(s, "%-14s %10llu %10llu %12llu %12llu %8llu %12llu\n",
+			   ds90ub95x_emu_target_names[i], st->xfers, st->msgs,
+			   st->read_bytes, st->write_bytes, st->nacks,
+			   div_u64(st->bus_ns, NSEC_PER_USEC));
+	}
+	seq_printf(s, "port selects: %llu\nindirect accesses: %llu\n",
+		   emu->port_selects, emu->ia_accesses);
+	for(i = 0; i < emu->num_rx_ports; i++)
+		seq_printf(s, "rx port %i: %s\n", i,
+			   ds90ub95x_emu_locked(emu, i) ? "locked" :
+			   (emu->connected & (1<<i)) ? "no lock" :
+			   "disconnected");
+	mutex_unlock(&emu->lock);
+	return 0;
+}
+
+static int ds90ub95x_emu_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ds90ub95x_emu_stats_show, inode->i_private);
+}
+
+/* any write resets the counters */
+static ssize_t ds90ub95x_emu_stats_write(struct file *file,
+					 const char __user *ubuf, size_t len,
+					 loff_t *ppos)
+{
+	struct ds90ub95x_emu *emu = file_inode(file)->i_private;
+
+	mutex_lock(&emu->lock);
+	memset(emu->stats, 0, sizeof(emu->stats));
+	emu->port_selects = 0;
+	emu->ia_accesses = 0;
+	mutex_unlock(&emu->lock);
+	return len;
+}
+
+static const struct file_operations ds90ub95x_emu_stats_fops = {
+	.owner = THIS_MODULE,
+	.open = ds90ub95x_emu_stats_open,
+	.read = seq_read,
+	.write = ds90ub95x_emu_stats_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int ds90ub95x_emu_connected_get(void *data, u64 *val)
+{
+	struct ds90ub95x_emu *emu = data;
+
+	*val = emu->connected;
+	return 0;
+}
+
+/* plug/unplug serializers, a newly connected port locks after the lock time */
+static int ds90ub95x_emu_connected_set(void *data, u64 val)
+{
+	struct ds90ub95x_emu *emu = data;
+	int i;
+
+	mutex_lock(&emu->lock);
+	for(i = 0; i < emu->num_rx_ports; i++) {
+		if((val & (1<<i)) && !(emu->connected & (1<<i)))
+			emu->port[i].connected_at = ktime_get();
+	}
+	emu->connected = val & ((1<<emu->num_rx_ports)-1);
+	mutex_unlock(&emu->lock);
+	return 0;
+}
+
+DEFINE_DEBUGFS_ATTRIBUTE(ds90ub95x_emu_connected_fops,
+			 ds90ub95x_emu_connected_get,
+			 ds90ub95x_emu_connected_set, "0x%llx\n");
+
+static void ds90ub95x_emu_debugfs_init(struct ds90ub95x_emu *emu)
+{
+	char name[32];
+
+	snprintf(name, sizeof(name), "ds90ub95x-emu-%s", dev_name(emu->dev));
+	emu->debugfs = debugfs_create_dir(name, NULL);
+	debugfs_create_file("stats", 0644, emu->debugfs, emu,
+			    &ds90ub95x_emu_stats_fops);
+	debugfs_create_file("connected", 0644, emu->debugfs, emu,
+			    &ds90ub95x_emu_connected_fops);
+	debugfs_create_u32("lock_time_ms", 0644, emu->debugfs,
+			   &emu->lock_time_ms);
+}
+
+/*------------------------------------------------------------------------------
+ * PROBE FUNCTION
+ *----------------------------------------------------------------------------*/
+
+static void ds90ub95x_emu_reset(struct ds90ub95x_emu *emu)
+{
+	struct ds90ub95x_emu_regs *r;
+	int i;
+
+	emu->des.reg[TI954_REG_I2C_DEV_ID] = emu->des_addr<<1;
+	emu->des.reg[TI954_REG_REVISION] = 0x20;
+	emu->des.reg[TI954_REG_REFCLK_FREQ] = TI954_REFCLK_DEFAULT_MHZ;
+	emu->des.reg[TI954_REG_FPD3_PORT_SEL] = (1<<TI954_RX_WRITE_PORT_0);
+	ds90ub95x_emu_set_id(emu->des.reg,
+			     emu->num_rx_ports > TI954_NUM_RX_PORTS ?
+			     "_UB960" : "_UB954");
+
+	for(i = 0; i < emu->num_rx_ports; i++) {
+		r = &emu->port[i].ser;
+		r->reg[TI953_REG_I2C_DEV_ID] = EMU_DEFAULT_SER_ADDR<<1;
+		r->reg[TI953_REG_DEVICE_STS] = (1<<TI953_CFG_CKSUM_STS) |
+					       (1<<TI953_CFG_INIT_DONE);
+		ds90ub95x_emu_set_id(r->reg, "_UB953");
+	}
+}
+
+static int ds90ub95x_emu_parse_dt(struct ds90ub95x_emu *emu)
+{
+	struct device *dev = emu->dev;
+	struct device_node *np = dev->of_node;
+	u32 remote[EMU_MAX_REMOTE];
+	u32 val;
+	int num, reg16, i, j;
+
+	if(of_property_read_u32(np, "ti,deserializer-address", &val))
+		val = EMU_DEFAULT_DES_ADDR;
+	emu->des_addr = val;
+
+	if(of_property_read_u32(np, "ti,num-rx-ports", &val))
+		val = TI954_NUM_RX_PORTS;
+	if(val < 1 || val > EMU_NUM_PORTS) {
+		dev_err(dev, "%s: invalid ti,num-rx-ports %u\n", __func__, val);
+		return -EINVAL;
+	}
+	emu->num_rx_ports = val;
+
+	if(of_property_read_u32(np, "ti,lock-time-ms", &emu->lock_time_ms))
+		emu->lock_time_ms = EMU_DEFAULT_LOCK_MS;
+
+	if(of_property_read_u32(np, "ti,connected-ports", &val))
+		val = (1<<emu->num_rx_ports)-1;
+	emu->connected = val & ((1<<emu->num_rx_ports)-1);
+
+	if(of_property_read_u32(np, "clock-frequency", &emu->bus_freq) ||
+	   !emu->bus_freq)
+		emu->bus_freq = EMU_DEFAULT_BUS_FREQ;
+
+	/* remote devices behind every serializer */
+	num = of_property_count_u32_elems(np, "ti,remote-devices");
+	if(num > EMU_MAX_REMOTE)
+		num = EMU_MAX_REMOTE;
+	if(num > 0 && of_property_read_u32_array(np, "ti,remote-devices",
+						 remote, num))
+		num = 0;
+	reg16 = of_property_read_bool(np, "ti,remote-reg16");
+	for(i = 0; i < emu->num_rx_ports; i++) {
+		for(j = 0; j < num; j++) {
+			emu->port[i].remote[j].slave = remote[j];
+			emu->port[i].remote[j].reg16 = reg16;
+		}
+		emu->port[i].num_remote = max(num, 0);
+	}
+
+	dev_info(dev, "%s: deserializer 0x%02x, %i rx ports, lock time %u ms, %i remote devices\n",
+		 __func__, emu->des_addr, emu->num_rx_ports, emu->lock_time_ms,
+		 max(num, 0));
+	return 0;
+}
+
+static int ds90ub95x_emu_probe(struct platform_device *pdev)
+{
+	struct device *dev = &pdev->dev;
+	struct ds90ub95x_emu *emu;
+	int err;
+
+	emu = devm_kzalloc(dev, sizeof(*emu), GFP_KERNEL);
+	if(!emu)
+		return -ENOMEM;
+
+	emu->dev = dev;
+	mutex_init(&emu->lock);
+	platform_set_drvdata(pdev, emu);
+
+	err = ds90ub95x_emu_parse_dt(emu);
+	if(err)
+		return err;
+	ds90ub95x_emu_reset(emu);
+
+	emu->adap.owner = THIS_MODULE;
+	emu->adap.algo = &ds90ub95x_emu_algo;
+	emu->adap.dev.parent = dev;
+	emu->adap.dev.of_node = dev->of_node;
+	strscpy(emu->adap.name, "ds90ub95x-emu", sizeof(emu->adap.name));
+	i2c_set_adapdata(&emu->adap, emu);
+
+	ds90ub95x_emu_debugfs_init(emu);
+
+	/* instantiates the deserializer from the child nodes */
+	err = i2c_add_adapter(&emu->adap);
+	if(err) {
+		dev_err(dev, "%s: unable to add i2c adapter (%d)\n", __func__,
+			err);
+		debugfs_remove_recursive(emu->debugfs);
+		return err;
+	}
+	return 0;
+}
+
+static int ds90ub95x_emu_remove(struct platform_device *pdev)
+{
+	struct ds90ub95x_emu *emu = platform_get_drvdata(pdev);
+
+	i2c_del_adapter(&emu->adap);
+	debugfs_remove_recursive(emu->debugfs);
+	return 0;
+}
+
+static const struct of_device_id ds90ub95x_emu_of_match[] = {
+	{
+		.compatible = "ti,ds90ub95x-emu",
+	},
+	{/* sentinel */},
+};
+
+static struct platform_driver ds90ub95x_emu_driver = {
+	.driver =
+	{
+		.name = "ds90ub95x-emu",
+		.of_match_table = ds90ub95x_emu_of_match,
+	},
+	.probe = ds90ub95x_emu_probe,
+	.remove = ds90ub95x_emu_remove,
+};
+
+MODULE_DEVICE_TABLE(of, ds90ub95x_emu_of_match);
+
+module_platform_driver(ds90ub95x_emu_driver);
+
+MODULE_DESCRIPTION("ds90ub954/ds90ub953 register level emulator");
+MODULE_LICENSE("GPL v2");